@@ -4,22 +4,46 @@
 #
 #-------------------------------------------------
 
-QT       += core gui
+QT       += core gui concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 TARGET = automata
 TEMPLATE = app
 
+include(engine.pri)
+
 
 SOURCES += main.cpp\
         mainwindow.cpp \
     gamewidget.cpp \
-    infodialog.cpp
+    infodialog.cpp \
+    patternindex.cpp \
+    generationhistory.cpp \
+    checkpointer.cpp \
+    runrecorder.cpp \
+    gifwriter.cpp \
+    recordingexporter.cpp \
+    boardpainter.cpp \
+    perfmonitor.cpp \
+    ruleexplorer.cpp \
+    censusdock.cpp \
+    lookahead.cpp
 
 HEADERS  += mainwindow.h \
     gamewidget.h \
-    infodialog.h
+    infodialog.h \
+    patternindex.h \
+    generationhistory.h \
+    checkpointer.h \
+    runrecorder.h \
+    gifwriter.h \
+    recordingexporter.h \
+    boardpainter.h \
+    perfmonitor.h \
+    ruleexplorer.h \
+    censusdock.h \
+    lookahead.h
 
 FORMS    += mainwindow.ui \
     infodialog.ui
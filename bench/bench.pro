@@ -0,0 +1,19 @@
+#-------------------------------------------------
+#
+# Benchmarks: engine step and board painting speed.
+#
+#-------------------------------------------------
+
+QT       += core gui
+
+TARGET = bench
+CONFIG   += console
+CONFIG   -= app_bundle
+TEMPLATE = app
+
+include(../engine.pri)
+
+SOURCES += main.cpp \
+    ../boardpainter.cpp
+
+HEADERS  += ../boardpainter.h
@@ -0,0 +1,475 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QImage>
+#include <QPainter>
+#include <QFile>
+#include <QDir>
+#include <QDateTime>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include "lifeengine.h"
+#include "ensembleengine.h"
+#include "tileduniverse.h"
+#include "soup.h"
+#include "boardpainter.h"
+#include "perfcounters.h"
+
+/**
+  *
+  * bench: repeatable step and paint timings.
+  * Every case is seeded with the same pseudo-random board, timed over a generation count
+  * calibrated to --min-time, then repeated; the median repetition is reported.
+  * Suites:
+  *   rules   every rule x neighbourhood x edge mode, 200x200
+  *   sizes   board sizes up to the GUI maximum x densities, B3/S23
+  *   radius  Larger than Life neighbourhoods of radius 2 to 10 (box and diamond), 200x200
+  *   symmetric  D8 soups, every cell (engine-tN) against the fundamental domain (engine-tN-D8)
+  *   render  the game widget's painting into an off-screen QImage: a 1280x800 viewport over
+  *           10 px cells, the board packed and only its visible region painted
+  * New engine backends only need a Backend subclass added to the list in main().
+  * The tiled backend steps a TiledUniverse file in the temporary directory, so its figures
+  * include the page cache but not the disk once the board has been read.
+  * Backends stepping several boards at once (ensemble: 64 lanes) report per-cell figures over
+  * all of their boards.
+  * --counters adds hardware counters per cell (Linux perf_event), read around each timed batch
+  * so the timings are unchanged; multi-threaded backends are left blank as only the calling
+  * thread is counted.
+ */
+
+struct Case
+{
+    QString suite;
+    QString rule;
+    char neighMode;
+    char edgeMode;
+    int height;
+    int width;
+    double density;
+    QString id(const QString &backend) const
+    {
+        return QString("%1/%2/%3/%4%5/%6x%7/%8").arg(suite).arg(backend).arg(rule)
+                .arg(neighMode).arg(edgeMode).arg(height).arg(width).arg(density);
+    }
+};
+
+static QString csv(const QString &field)
+{
+    //Larger than Life rules hold commas.
+    return field.contains(',') ? "\"" + field + "\"" : field;
+}
+
+static BitGrid seeded(const Case &c, quint64 seed)
+{
+    //xorshift64*, so boards are the same on every platform.
+    quint64 x = seed ^ ((quint64)c.height << 32) ^ (quint64)c.width ^ (quint64)(c.density * 1000);
+    if(x == 0){ x = 1; }
+    BitGrid board(c.height, c.width);
+    quint64 threshold = (quint64)(c.density * 4294967296.0);
+    for(int k = 0; k < c.height; k++){
+        for(int j = 0; j < c.width; j++){
+            x ^= x >> 12;
+            x ^= x << 25;
+            x ^= x >> 27;
+            board.setCell(k, j, ((x * Q_UINT64_C(2685821657736338717)) >> 32) < threshold);
+        }
+    }
+    return board;
+}
+
+
+//Backends:
+class Backend
+{
+public:
+    virtual ~Backend() {}
+    virtual QString name() const = 0;
+    virtual bool supports(const Case &c) const = 0;
+    virtual void setup(const Case &c, const BitGrid &board) = 0;
+    virtual void step() = 0; // one timed unit: a generation or a frame
+    virtual int threads() const { return 1; }
+    virtual int boards() const { return 1; } // universes advanced by one step()
+};
+
+class EngineBackend : public Backend
+{
+public:
+    explicit EngineBackend(int threads, Soup::Symmetry symmetry = Soup::C1) : threadCount(threads), group(symmetry), engine(1, 1) {}
+    QString name() const { return QString("engine-t%1").arg(threadCount) + (group != Soup::C1 ? "-" + Soup::symmetryName(group) : QString()); }
+    bool supports(const Case &c) const { return c.suite != "render" && (group == Soup::C1 || c.suite == "symmetric"); }
+    void setup(const Case &c, const BitGrid &board)
+    {
+        engine.setSymmetry(group);
+        engine.resize(c.height, c.width);
+        engine.setRule(c.rule);
+        engine.setNeighMode(c.neighMode);
+        engine.setEdgeMode(c.edgeMode);
+        engine.setThreadCount(threadCount);
+        engine.setBoard(board);
+    }
+    void step() { engine.step(); }
+    int threads() const { return threadCount; }
+private:
+    int threadCount;
+    Soup::Symmetry group; // symmetric stepping, used when the board has it
+    LifeEngine engine;
+};
+
+class EnsembleBackend : public Backend
+{
+public:
+    QString name() const { return "ensemble"; }
+    bool supports(const Case &c) const { return c.suite == "rules"; }
+    void setup(const Case &c, const BitGrid &board)
+    {
+        QList<int> b, s;
+        LifeEngine::parseRule(c.rule, b, s);
+        engine.resize(c.height, c.width);
+        engine.setRule(b, s);
+        engine.setNeighMode(c.neighMode);
+        engine.setEdgeMode(c.edgeMode);
+        for(int lane = 0; lane < EnsembleEngine::Lanes; lane++){
+            engine.setLane(lane, board);
+        }
+    }
+    void step()
+    {
+        //Lanes stop together on the same board, keep timing full steps.
+        if(!engine.step()){
+            engine.clear();
+            engine.step();
+        }
+    }
+    int boards() const { return EnsembleEngine::Lanes; }
+private:
+    EnsembleEngine engine;
+};
+
+class TiledBackend : public Backend
+{
+public:
+    TiledBackend() : filename(QDir::temp().filePath(QString("bench-%1.ltil").arg(QCoreApplication::applicationPid()))) {}
+    ~TiledBackend() { universe.close(); QFile::remove(filename); }
+    QString name() const { return "tiled"; }
+    bool supports(const Case &c) const
+    {
+        //Radius 1 outer-totalistic rules only.
+        QList<int> b, s;
+        return (c.suite == "rules" || c.suite == "sizes") && LifeEngine::parseRule(c.rule, b, s);
+    }
+    void setup(const Case &c, const BitGrid &board)
+    {
+        QList<int> b, s;
+        LifeEngine::parseRule(c.rule, b, s);
+        universe.create(filename, c.height, c.width);
+        universe.setRule(b, s, c.neighMode, c.edgeMode);
+        universe.setRegion(0, 0, board);
+    }
+    void step() { universe.step(); }
+private:
+    QString filename;
+    TiledUniverse universe;
+};
+
+class RenderBackend : public Backend
+{
+public:
+    RenderBackend() : engine(1, 1), population(0) {}
+    QString name() const { return "painter"; }
+    bool supports(const Case &c) const { return c.suite == "render"; }
+    void setup(const Case &c, const BitGrid &board)
+    {
+        engine.resize(c.height, c.width);
+        engine.setBoard(board);
+        //Same 10 px cells as the GUI at its default zoom, seen through a window-sized viewport.
+        size = QSize(c.width * 10, c.height * 10);
+        viewport = QRect(0, 0, 1280, 800) & QRect(QPoint(0, 0), size);
+        image = QImage(viewport.size(), QImage::Format_ARGB32_Premultiplied);
+    }
+    void step()
+    {
+        //As GameWidget::paintEvent(): grid and cells under the viewport only.
+        image.fill(Qt::white);
+        QPainter p(&image);
+        BoardPainter::paintGrid(p, size, engine.height(), engine.width(), viewport);
+        QRect cells = BoardPainter::visibleCells(size, engine.height(), engine.width(), viewport);
+        BitGrid board = engine.board();
+        BoardPainter::paintRegion(p, size, engine.height(), engine.width(), cells.topLeft(),
+                                  board.region(cells.top(), cells.left(), cells.height(), cells.width()), QColor("#000"));
+        population = board.population();
+    }
+private:
+    LifeEngine engine;
+    QSize size; // whole board in pixels
+    QRect viewport; // part of it painted
+    QImage image;
+    int population; // counted for the status bar, as the widget does
+};
+
+
+//Timing:
+static double timeSteps(Backend *b, const Case &c, const BitGrid &board, int steps, PerfCounters *counters = 0)
+{
+    b->setup(c, board);
+    b->step(); //Warm up caches and thread pool.
+    b->setup(c, board);
+    if(counters){ counters->start(); }
+    QElapsedTimer clock;
+    clock.start();
+    for(int i = 0; i < steps; i++){
+        b->step();
+    }
+    qint64 ns = clock.nsecsElapsed();
+    if(counters){ counters->stop(); }
+    return ns / 1e9;
+}
+
+static int calibrate(Backend *b, const Case &c, const BitGrid &board, double minSeconds)
+{
+    int steps = 1;
+    while(steps < (1 << 24)){
+        double s = timeSteps(b, c, board, steps);
+        if(s >= minSeconds){
+            break;
+        }
+        steps = s < minSeconds / 16 ? steps * 8 : qMax(steps + 1, (int)(steps * minSeconds * 1.1 / qMax(s, 1e-9)));
+    }
+    return steps;
+}
+
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Step and paint benchmarks of the automata engine.");
+    parser.addHelpOption();
+    QCommandLineOption formatOpt("format", "csv or json (default csv).", "format", "csv");
+    QCommandLineOption outOpt(QStringList() << "o" << "output", "Write results to a file instead of stdout.", "file");
+    QCommandLineOption filterOpt(QStringList() << "f" << "filter", "Only run cases whose id contains text.", "text");
+    QCommandLineOption timeOpt("min-time", "Minimum ms per repetition (default 300).", "ms", "300");
+    QCommandLineOption repeatOpt("repeat", "Repetitions per case, the median is kept (default 3).", "n", "3");
+    QCommandLineOption threadOpt(QStringList() << "j" << "threads", "Threads of the multi-threaded backend (default: one per core).", "n");
+    QCommandLineOption seedOpt("seed", "Board seed (default 1).", "n", "1");
+    QCommandLineOption quickOpt("quick", "Sizes up to 200 and one density only.");
+    QCommandLineOption listOpt("list", "List the case ids and exit.");
+    QCommandLineOption countersOpt("counters", "Add hardware performance counters per cell (Linux perf_event).");
+    parser.addOption(formatOpt);
+    parser.addOption(outOpt);
+    parser.addOption(filterOpt);
+    parser.addOption(timeOpt);
+    parser.addOption(repeatOpt);
+    parser.addOption(threadOpt);
+    parser.addOption(seedOpt);
+    parser.addOption(quickOpt);
+    parser.addOption(listOpt);
+    parser.addOption(countersOpt);
+    parser.process(app);
+
+    int threads = parser.isSet(threadOpt) ? qMax(1, parser.value(threadOpt).toInt()) : QThread::idealThreadCount();
+    QThreadPool::globalInstance()->setMaxThreadCount(threads);
+    double minSeconds = qMax(1, parser.value(timeOpt).toInt()) / 1000.0;
+    int repeat = qMax(1, parser.value(repeatOpt).toInt());
+    quint64 seed = parser.value(seedOpt).toULongLong();
+    bool quick = parser.isSet(quickOpt);
+
+    QList<Backend*> backends;
+    backends << new EngineBackend(1);
+    if(threads > 1){
+        backends << new EngineBackend(threads);
+    }
+    backends << new EngineBackend(1, Soup::D8);
+    if(threads > 1){
+        backends << new EngineBackend(threads, Soup::D8);
+    }
+    backends << new EnsembleBackend();
+    backends << new TiledBackend();
+    backends << new RenderBackend();
+
+    //Cases:
+    QList<Case> cases;
+    QStringList rules = QStringList() << "B3/S23" << "B36/S23" << "B2/S" << "B1357/S1357";
+    QString neighModes = "mv";
+    QString edgeModes = "tp";
+    foreach(QString rule, rules){
+        for(int n = 0; n < neighModes.size(); n++){
+            for(int e = 0; e < edgeModes.size(); e++){
+                Case c = { "rules", rule, neighModes[n].toLatin1(), edgeModes[e].toLatin1(), 200, 200, 0.35 };
+                cases << c;
+            }
+        }
+    }
+    //Isotropic rules go through the same table as the ones above, times should match.
+    QStringList hensel = QStringList() << "B2-a/S12" << "B3/S2-i34q";
+    foreach(QString rule, hensel){
+        for(int e = 0; e < edgeModes.size(); e++){
+            Case c = { "hensel", rule, 'm', edgeModes[e].toLatin1(), 200, 200, 0.35 };
+            cases << c;
+        }
+    }
+    //Generations rules on packed cells: 2 bits per cell up to 4 states, 4 bits above.
+    QStringList generations = QStringList() << "B2/S/C3" << "B2/S345/C4" << "B2/S/C8";
+    foreach(QString rule, generations){
+        for(int e = 0; e < edgeModes.size(); e++){
+            Case c = { "generations", rule, 'm', edgeModes[e].toLatin1(), 200, 200, 0.35 };
+            cases << c;
+        }
+    }
+    //Bosco's rule scaled to each radius, so boards stay alive and comparable.
+    QList<int> radii = QList<int>() << 2 << 5 << 10;
+    foreach(int r, radii){
+        int area = (2 * r + 1) * (2 * r + 1);
+        QString rule = QString("R%1,C0,M1,S%2..%3,B%4..%5,N").arg(r)
+                .arg(area * 34 / 121).arg(area * 58 / 121).arg(area * 34 / 121).arg(area * 45 / 121);
+        for(int n = 0; n < neighModes.size(); n++){
+            Case c = { "radius", rule + (neighModes[n] == 'm' ? "M" : "N"), neighModes[n].toLatin1(), 't', 200, 200, 0.35 };
+            cases << c;
+        }
+    }
+    QList<int> sizes = QList<int>() << 50 << 100 << 200;
+    QList<double> densities = QList<double>() << 0.35;
+    if(!quick){
+        sizes << 500 << 1000; //1000: largest board of the GUI.
+        densities.prepend(0.05);
+        densities << 0.7;
+    }
+    foreach(int s, sizes){
+        foreach(double d, densities){
+            Case c = { "sizes", "B3/S23", 'm', 't', s, s, d };
+            cases << c;
+        }
+        Case r = { "render", "B3/S23", 'm', 't', s, s, 0.35 };
+        cases << r;
+    }
+    //Square boards: D8 needs them. Both edge modes keep the symmetry about the centre.
+    QList<int> symmetricSizes = QList<int>() << 200;
+    if(!quick){
+        symmetricSizes << 500 << 1000;
+    }
+    foreach(int s, symmetricSizes){
+        for(int e = 0; e < edgeModes.size(); e++){
+            Case c = { "symmetric", "B3/S23", 'm', edgeModes[e].toLatin1(), s, s, 0.35 };
+            cases << c;
+        }
+    }
+
+    PerfCounters counters;
+    QList<PerfCounters::Counter> measured;
+    if(parser.isSet(countersOpt)){
+        if(!counters.open()){
+            QTextStream(stderr) << "bench: hardware counters unavailable (" << counters.error() << "), continuing without them\n";
+        }
+        for(int i = 0; i < PerfCounters::CounterCount; i++){
+            if(counters.isAvailable((PerfCounters::Counter)i)){ measured << (PerfCounters::Counter)i; }
+        }
+    }
+
+    //Run:
+    QFile file;
+    if(parser.isSet(outOpt)){
+        file.setFileName(parser.value(outOpt));
+        if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)){
+            QTextStream(stderr) << "bench: cannot write " << parser.value(outOpt) << "\n";
+            return 1;
+        }
+    } else {
+        file.open(stdout, QIODevice::WriteOnly);
+    }
+    QTextStream out(&file);
+    QTextStream log(stderr);
+    bool json = parser.value(formatOpt) == "json";
+    if(!json){
+        out << "id,suite,backend,rule,neighbourhood,edge,height,width,density,steps,seconds,steps_per_second,ns_per_cell";
+        foreach(PerfCounters::Counter i, measured){ out << "," << PerfCounters::name(i) << "_per_cell"; }
+        if(!measured.isEmpty()){ out << ",ipc"; }
+        out << "\n";
+    }
+    QJsonArray results;
+    foreach(Case c, cases){
+        foreach(Backend *b, backends){
+            QString id = c.id(b->name());
+            if(!b->supports(c) || (parser.isSet(filterOpt) && !id.contains(parser.value(filterOpt)))){
+                continue;
+            }
+            if(parser.isSet(listOpt)){
+                out << id << "\n";
+                continue;
+            }
+            BitGrid board = c.suite == "symmetric" ? Soup::generate(c.height, c.width, c.density, seed, Soup::D8) : seeded(c, seed);
+            int steps = calibrate(b, c, board, minSeconds);
+            QList<double> times;
+            bool counted = !measured.isEmpty() && b->threads() == 1;
+            counters.reset();
+            for(int r = 0; r < repeat; r++){
+                times << timeSteps(b, c, board, steps, counted ? &counters : 0);
+            }
+            double cellSteps = (double)repeat * steps * c.height * c.width * b->boards();
+            QStringList counterValues;
+            foreach(PerfCounters::Counter i, measured){
+                counterValues << (counted ? QString::number(counters.total(i) / cellSteps) : QString());
+            }
+            if(!measured.isEmpty()){
+                bool ipc = counted && counters.isAvailable(PerfCounters::Cycles) && counters.isAvailable(PerfCounters::Instructions);
+                counterValues << (ipc ? QString::number((double)counters.total(PerfCounters::Instructions)
+                                                        / qMax<quint64>(1, counters.total(PerfCounters::Cycles))) : QString());
+            }
+            qSort(times);
+            double median = times[times.size() / 2];
+            double perSecond = steps / median;
+            double nsPerCell = median * 1e9 / ((double)steps * c.height * c.width * b->boards());
+            log << id << ": " << perSecond << " steps/s, " << nsPerCell << " ns/cell\n";
+            log.flush();
+            if(json){
+                QJsonObject row;
+                row["id"] = id;
+                row["suite"] = c.suite;
+                row["backend"] = b->name();
+                row["rule"] = c.rule;
+                row["neighbourhood"] = QString(c.neighMode);
+                row["edge"] = QString(c.edgeMode);
+                row["height"] = c.height;
+                row["width"] = c.width;
+                row["density"] = c.density;
+                row["steps"] = steps;
+                row["seconds"] = median;
+                row["steps_per_second"] = perSecond;
+                row["ns_per_cell"] = nsPerCell;
+                for(int i = 0; i < measured.size() && counted; i++){
+                    row[PerfCounters::name(measured[i]) + "_per_cell"] = counterValues[i].toDouble();
+                }
+                if(counted && !counterValues.last().isEmpty()){
+                    row["ipc"] = counterValues.last().toDouble();
+                }
+                results.append(row);
+            } else {
+                out << csv(id) << "," << c.suite << "," << b->name() << "," << csv(c.rule) << "," << c.neighMode << "," << c.edgeMode
+                    << "," << c.height << "," << c.width << "," << c.density << "," << steps << "," << median
+                    << "," << perSecond << "," << nsPerCell;
+                foreach(QString v, counterValues){ out << "," << v; }
+                out << "\n";
+                out.flush();
+            }
+        }
+    }
+    if(json && !parser.isSet(listOpt)){
+        QJsonObject doc;
+        doc["date"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+        doc["qt"] = QString(qVersion());
+        doc["cores"] = QThread::idealThreadCount();
+        doc["threads"] = threads;
+        doc["seed"] = QString::number(seed);
+        doc["min_time_ms"] = minSeconds * 1000;
+        doc["repeat"] = repeat;
+        doc["results"] = results;
+        out << QJsonDocument(doc).toJson();
+    }
+    out.flush();
+    qDeleteAll(backends);
+    return 0;
+}
@@ -0,0 +1,372 @@
+#include <cstring>
+#include "bitgrid.h"
+
+
+//Constructors:
+BitGrid::BitGrid() :
+    h(0),
+    w(0),
+    wpr(0)
+{
+}
+
+BitGrid::BitGrid(int height, int width) :
+    h(height),
+    w(width),
+    wpr((width + 63) / 64),
+    data(height * ((width + 63) / 64), 0)
+{
+}
+
+
+//Accessors:
+int BitGrid::height() const
+{
+    return h;
+}
+
+int BitGrid::width() const
+{
+    return w;
+}
+
+int BitGrid::wordsPerRow() const
+{
+    return wpr;
+}
+
+bool BitGrid::isNull() const
+{
+    return h == 0 || w == 0;
+}
+
+int BitGrid::byteSize() const
+{
+    return data.size() * sizeof(quint64);
+}
+
+bool BitGrid::cell(int k, int j) const
+{
+    return (data[k * wpr + (j >> 6)] >> (j & 63)) & 1;
+}
+
+void BitGrid::setCell(int k, int j, bool alive)
+{
+    quint64 bit = Q_UINT64_C(1) << (j & 63);
+    if(alive){
+        data[k * wpr + (j >> 6)] |= bit;
+    } else {
+        data[k * wpr + (j >> 6)] &= ~bit;
+    }
+}
+
+BitGrid BitGrid::region(int top, int left, int height, int width) const
+{
+    BitGrid out(qMax(0, height), qMax(0, width));
+    out.blit(*this, -top, -left);
+    return out;
+}
+
+const quint64 *BitGrid::row(int k) const
+{
+    return data.constData() + k * wpr;
+}
+
+quint64 *BitGrid::row(int k)
+{
+    return data.data() + k * wpr;
+}
+
+const QVector<quint64> &BitGrid::words() const
+{
+    return data;
+}
+
+QVector<quint64> &BitGrid::words()
+{
+    return data;
+}
+
+
+//Whole grid:
+int BitGrid::population() const
+{
+    int n = 0;
+    for(int i = 0; i < data.size(); i++){
+        n += qPopulationCount(data[i]);
+    }
+    return n;
+}
+
+quint64 BitGrid::hash() const
+{
+    //FNV-1a over the words, seeded with the dimensions.
+    quint64 x = Q_UINT64_C(14695981039346656037) ^ ((quint64)h << 32) ^ (quint64)w;
+    for(int i = 0; i < data.size(); i++){
+        x ^= data[i];
+        x *= Q_UINT64_C(1099511628211);
+        x ^= x >> 29;
+    }
+    return x;
+}
+
+bool BitGrid::operator==(const BitGrid &other) const
+{
+    return h == other.h && w == other.w && data == other.data;
+}
+
+bool BitGrid::operator!=(const BitGrid &other) const
+{
+    return !(*this == other);
+}
+
+//Rectangles:
+static quint64 bitsFrom(const quint64 *row, int words, int start)
+{
+    //64 bits of a row from bit start (-63..), 0 beyond its words.
+    if(start < 0){
+        return row[0] << -start;
+    }
+    int q = start >> 6;
+    int r = start & 63;
+    quint64 lo = q < words ? row[q] : 0;
+    if(r == 0){
+        return lo;
+    }
+    quint64 hi = q + 1 < words ? row[q + 1] : 0;
+    return (lo >> r) | (hi << (64 - r));
+}
+
+static quint64 bitMask(int from, int to)
+{
+    //Bits from..to-1 of a word, 0 <= from < to <= 64.
+    quint64 m = to == 64 ? ~Q_UINT64_C(0) : (Q_UINT64_C(1) << to) - 1;
+    return m & ~((Q_UINT64_C(1) << from) - 1);
+}
+
+void BitGrid::blit(const BitGrid &src, int top, int left, Merge mode)
+{
+    int k0 = qMax(0, top);
+    int k1 = qMin(h, top + src.h);
+    int x0 = qMax(0, left);
+    int x1 = qMin(w, left + src.w);
+    if(k0 >= k1 || x0 >= x1){
+        return;
+    }
+    for(int k = k0; k < k1; k++){
+        quint64 *d = row(k);
+        const quint64 *s = src.row(k - top);
+        for(int i = x0 >> 6; i <= (x1 - 1) >> 6; i++){
+            quint64 mask = bitMask(qMax(x0, i * 64) - i * 64, qMin(x1, i * 64 + 64) - i * 64);
+            quint64 v = bitsFrom(s, src.wpr, i * 64 - left) & mask;
+            switch(mode){
+            case Replace: d[i] = (d[i] & ~mask) | v; break;
+            case Or: d[i] |= v; break;
+            case Xor: d[i] ^= v; break;
+            case And: d[i] &= v | ~mask; break;
+            }
+        }
+    }
+}
+
+void BitGrid::fill(int top, int left, int height, int width, bool alive)
+{
+    int k0 = qMax(0, top);
+    int k1 = qMin(h, top + height);
+    int x0 = qMax(0, left);
+    int x1 = qMin(w, left + width);
+    for(int k = k0; k < k1 && x0 < x1; k++){
+        quint64 *d = row(k);
+        for(int i = x0 >> 6; i <= (x1 - 1) >> 6; i++){
+            quint64 mask = bitMask(qMax(x0, i * 64) - i * 64, qMin(x1, i * 64 + 64) - i * 64);
+            d[i] = alive ? d[i] | mask : d[i] & ~mask;
+        }
+    }
+}
+
+void BitGrid::invert(int top, int left, int height, int width)
+{
+    int k0 = qMax(0, top);
+    int k1 = qMin(h, top + height);
+    int x0 = qMax(0, left);
+    int x1 = qMin(w, left + width);
+    for(int k = k0; k < k1 && x0 < x1; k++){
+        quint64 *d = row(k);
+        for(int i = x0 >> 6; i <= (x1 - 1) >> 6; i++){
+            d[i] ^= bitMask(qMax(x0, i * 64) - i * 64, qMin(x1, i * 64 + 64) - i * 64);
+        }
+    }
+}
+
+static void transpose64(quint64 *a)
+{
+    //In place, bit c of a[r] <-> bit r of a[c]: swaps of ever smaller off-diagonal blocks.
+    quint64 m = Q_UINT64_C(0x00000000FFFFFFFF);
+    for(int j = 32; j != 0; j >>= 1, m ^= m << j){
+        for(int k = 0; k < 64; k = ((k | j) + 1) & ~j){
+            quint64 t = ((a[k] >> j) ^ a[k | j]) & m;
+            a[k] ^= t << j;
+            a[k | j] ^= t;
+        }
+    }
+}
+
+BitGrid BitGrid::transposed() const
+{
+    BitGrid out(w, h);
+    quint64 block[64];
+    for(int top = 0; top < h; top += 64){
+        for(int i = 0; i < wpr; i++){
+            for(int r = 0; r < 64; r++){
+                block[r] = top + r < h ? row(top + r)[i] : 0;
+            }
+            transpose64(block);
+            for(int c = 0; c < 64 && i * 64 + c < w; c++){
+                out.row(i * 64 + c)[top >> 6] = block[c];
+            }
+        }
+    }
+    return out;
+}
+
+static quint64 reversed(quint64 x)
+{
+    x = ((x >> 1) & Q_UINT64_C(0x5555555555555555)) | ((x & Q_UINT64_C(0x5555555555555555)) << 1);
+    x = ((x >> 2) & Q_UINT64_C(0x3333333333333333)) | ((x & Q_UINT64_C(0x3333333333333333)) << 2);
+    x = ((x >> 4) & Q_UINT64_C(0x0F0F0F0F0F0F0F0F)) | ((x & Q_UINT64_C(0x0F0F0F0F0F0F0F0F)) << 4);
+    x = ((x >> 8) & Q_UINT64_C(0x00FF00FF00FF00FF)) | ((x & Q_UINT64_C(0x00FF00FF00FF00FF)) << 8);
+    x = ((x >> 16) & Q_UINT64_C(0x0000FFFF0000FFFF)) | ((x & Q_UINT64_C(0x0000FFFF0000FFFF)) << 16);
+    return (x >> 32) | (x << 32);
+}
+
+BitGrid BitGrid::mirrored() const
+{
+    //The reversed padded row has its cells shifted by the padding.
+    BitGrid out(h, w);
+    QVector<quint64> line(wpr);
+    int pad = wpr * 64 - w;
+    for(int k = 0; k < h; k++){
+        const quint64 *s = row(k);
+        for(int i = 0; i < wpr; i++){
+            line[i] = reversed(s[wpr - 1 - i]);
+        }
+        quint64 *d = out.row(k);
+        for(int i = 0; i < wpr; i++){
+            d[i] = bitsFrom(line.constData(), wpr, pad + i * 64);
+        }
+    }
+    return out;
+}
+
+BitGrid BitGrid::flipped() const
+{
+    BitGrid out(h, w);
+    for(int k = 0; k < h; k++){
+        memcpy(out.row(h - 1 - k), row(k), wpr * sizeof(quint64));
+    }
+    return out;
+}
+
+BitGrid BitGrid::rotated(bool clockwise) const
+{
+    return clockwise ? transposed().mirrored() : transposed().flipped();
+}
+
+//Deltas:
+static void putVarint(QByteArray &out, quint32 v)
+{
+    while(v >= 0x80){
+        out.append(char((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+    out.append(char(v));
+}
+
+static quint32 getVarint(const uchar *&p)
+{
+    quint32 v = 0;
+    int shift = 0;
+    while(*p & 0x80){
+        v |= (quint32)(*p++ & 0x7f) << shift;
+        shift += 7;
+    }
+    v |= (quint32)(*p++) << shift;
+    return v;
+}
+
+QByteArray BitGrid::delta(const BitGrid &from, const BitGrid &to)
+/**
+  Delta = runs of (number of unchanged words, number of changed words, XOR of the changed words).
+  Unchanged words after the last run are implicit, so a still board costs 0 byte.
+*/
+{
+    QByteArray out;
+    const quint64 *a = from.words().constData();
+    const quint64 *b = to.words().constData();
+    int n = to.words().size();
+    int i = 0;
+    while(i < n){
+        int start = i;
+        while(i < n && a[i] == b[i]){ i++; }
+        if(i == n){
+            break;
+        }
+        putVarint(out, i - start);
+        start = i;
+        while(i < n && a[i] != b[i]){ i++; }
+        putVarint(out, i - start);
+        for(int x = start; x < i; x++){
+            quint64 d = a[x] ^ b[x];
+            out.append((const char *)&d, sizeof(d));
+        }
+    }
+    return out;
+}
+
+void BitGrid::applyDelta(const QByteArray &delta)
+{
+    quint64 *words = data.data();
+    const uchar *p = (const uchar *)delta.constData();
+    const uchar *end = p + delta.size();
+    int i = 0;
+    while(p < end){
+        i += getVarint(p);
+        int changed = getVarint(p);
+        for(int x = 0; x < changed; x++){
+            quint64 d;
+            memcpy(&d, p, sizeof(d));
+            words[i++] ^= d;
+            p += sizeof(d);
+        }
+    }
+}
+
+
+BitGrid BitGrid::fromUniverse(bool **universe, int height, int width)
+{
+    BitGrid g(height, width);
+    quint64 *out = g.data.data();
+    for(int k = 1; k <= height; k++){
+        const bool *line = universe[k] + 1; //skip the buffer column.
+        for(int base = 0; base < width; base += 64){
+            int n = qMin(64, width - base);
+            quint64 word = 0;
+            for(int b = 0; b < n; b++){
+                word |= (quint64)line[base + b] << b;
+            }
+            *out++ = word;
+        }
+    }
+    return g;
+}
+
+void BitGrid::toUniverse(bool **universe) const
+{
+    for(int k = 0; k < h; k++){
+        const quint64 *in = row(k);
+        bool *line = universe[k + 1] + 1; //skip the buffer row and column.
+        for(int j = 0; j < w; j++){
+            line[j] = (in[j >> 6] >> (j & 63)) & 1;
+        }
+    }
+}
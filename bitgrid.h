@@ -0,0 +1,63 @@
+#ifndef BITGRID_H
+#define BITGRID_H
+
+#include <QVector>
+#include <QByteArray>
+
+/**
+  *
+  * Bit packed copy of a universe: one bit per cell, each row padded to whole 64 bit words.
+  * Cells are addressed from (0,0), without the buffer zone of the bool** maps.
+  * The words are implicitly shared, copies are cheap until one of them is written to.
+  * Rectangles are copied, merged, filled and inverted a word at a time (bit-blit), and
+  * turned with 64x64 bit-matrix transposes, so editing a large area costs no cell loop.
+ */
+
+class BitGrid
+{
+public:
+    enum Merge { Replace, Or, Xor, And };
+
+    BitGrid();
+    BitGrid(int height, int width);
+
+    int height() const;
+    int width() const;
+    int wordsPerRow() const;
+    bool isNull() const;
+    int byteSize() const; // memory held by the cells
+
+    bool cell(int k, int j) const;
+    void setCell(int k, int j, bool alive);
+    BitGrid region(int top, int left, int height, int width) const; // copy of part of the grid, dead outside it
+    void blit(const BitGrid &src, int top, int left, Merge mode = Replace); // src's cells at (top, left), clipped to the grid
+    void fill(int top, int left, int height, int width, bool alive); // rectangle, clipped to the grid
+    void invert(int top, int left, int height, int width);
+    BitGrid transposed() const; // cell (k, j) at (j, k)
+    BitGrid mirrored() const; // left-right
+    BitGrid flipped() const; // top-bottom
+    BitGrid rotated(bool clockwise) const; // quarter turn
+    const quint64 *row(int k) const;
+    quint64 *row(int k);
+    const QVector<quint64> &words() const;
+    QVector<quint64> &words();
+
+    int population() const; // number of live cells
+    quint64 hash() const; // 64 bit hash of size and cells
+    bool operator==(const BitGrid &other) const;
+    bool operator!=(const BitGrid &other) const;
+
+    static QByteArray delta(const BitGrid &from, const BitGrid &to); // run-length coded XOR of two same sized grids
+    void applyDelta(const QByteArray &delta); // from -> to
+
+    static BitGrid fromUniverse(bool **universe, int height, int width); // map[1..h][1..w] -> grid
+    void toUniverse(bool **universe) const; // grid -> map[1..h][1..w]
+
+private:
+    int h;
+    int w;
+    int wpr; // words per row
+    QVector<quint64> data;
+};
+
+#endif // BITGRID_H
@@ -0,0 +1,105 @@
+#include <QRectF>
+#include "boardpainter.h"
+
+
+void BoardPainter::paintGrid(QPainter &p, const QSize &size, int rows, int columns, const QRect &area)
+{
+    QRect borders(0, 0, size.width()-1, size.height()-1); // borders of the universe
+    QColor gridColor = "#000"; // color of the grid
+    QRect cells = visibleCells(size, rows, columns, area.isNull() ? borders : area);
+    double cellWidth = (double)size.width()/columns; // width of the area / number of cells at one row
+    int n = qMax(1, cells.left());
+    for(double k = cellWidth * n; k <= size.width() && n <= cells.right() + 1; k += cellWidth)
+    {
+        if( n % 10 == 0){
+            //every 10n line is thicker.
+            gridColor.setAlpha(100);
+            p.setPen(QPen(QBrush(gridColor), 2.0));
+            p.drawLine(k, 0, k, size.height());
+        } else {
+            gridColor.setAlpha(50);
+            p.setPen(QPen(QBrush(gridColor), 1.0));
+            p.drawLine(k, 0, k, size.height());
+        }
+        n++;
+    }
+    double cellHeight = (double)size.height()/rows; // height of the area / number of cells at one column
+    n = qMax(1, cells.top());
+    for(double k = cellHeight * n; k <= size.height() && n <= cells.bottom() + 1; k += cellHeight)
+    {
+        if(n % 10 == 0){
+            //every 10n line is thicker.
+            gridColor.setAlpha(100);
+            p.setPen(QPen(QBrush(gridColor), 2.0));
+            p.drawLine(0, k, size.width(), k);
+        } else {
+            gridColor.setAlpha(50);
+            p.setPen(QPen(QBrush(gridColor), 1.0));
+            p.drawLine(0, k, size.width(), k);
+        }
+        n++;
+    }
+    p.drawRect(borders);
+}
+
+int BoardPainter::paintRegion(QPainter &p, const QSize &size, int rows, int columns, const QPoint &origin, const BitGrid &cells, const QColor &color)
+{
+    int population = 0;
+    double cellWidth = (double)size.width()/columns;
+    double cellHeight = (double)size.height()/rows;
+    for(int k = 0; k < cells.height(); k++) {
+        const quint64 *row = cells.row(k);
+        for(int i = 0; i < cells.wordsPerRow(); i++) {
+            for(quint64 x = row[i]; x; x &= x - 1) {
+                int j = origin.x() + i * 64 + qCountTrailingZeroBits(x);
+                QRectF r((qreal)(cellWidth*j + 1), (qreal)(cellHeight*(origin.y() + k) + 1), (qreal)(cellWidth) - 1.5, (qreal)(cellHeight) - 1.5);
+                p.fillRect(r, QBrush(color));
+                population++;
+            }
+        }
+    }
+    return population;
+}
+
+QRect BoardPainter::visibleCells(const QSize &size, int rows, int columns, const QRect &area)
+{
+    double cellWidth = (double)size.width()/columns;
+    double cellHeight = (double)size.height()/rows;
+    int left = qBound(0, (int)(area.left() / cellWidth), columns - 1);
+    int top = qBound(0, (int)(area.top() / cellHeight), rows - 1);
+    int right = qBound(0, (int)(area.right() / cellWidth), columns - 1);
+    int bottom = qBound(0, (int)(area.bottom() / cellHeight), rows - 1);
+    return QRect(QPoint(left, top), QPoint(right, bottom));
+}
+
+QVector<QColor> BoardPainter::stateRamp(const QColor &color, int states)
+{
+    //From the live colour towards the white background, the oldest state is still visible.
+    QVector<QColor> ramp(states);
+    for(int s = 1; s < states; s++){
+        double t = 0.8 * (s - 1) / qMax(1, states - 2);
+        ramp[s] = QColor(color.red() + (255 - color.red()) * t,
+                         color.green() + (255 - color.green()) * t,
+                         color.blue() + (255 - color.blue()) * t);
+    }
+    return ramp;
+}
+
+int BoardPainter::paintStates(QPainter &p, const QSize &size, const GenerationsEngine &cells, const QColor &color)
+{
+    QVector<QColor> ramp = stateRamp(color, cells.states());
+    int population = 0;
+    double cellWidth = (double)size.width()/cells.width();
+    double cellHeight = (double)size.height()/cells.height();
+    for(int k = 0; k < cells.height(); k++) {
+        for(int j = 0; j < cells.width(); j++) {
+            int s = cells.cell(k, j);
+            if(s > 0) {
+                QRectF r((qreal)(cellWidth*j + 1), (qreal)(cellHeight*k + 1), (qreal)(cellWidth) - 1.5, (qreal)(cellHeight) - 1.5);
+                p.fillRect(r, QBrush(ramp[s]));
+                population += s == 1;
+            }
+        }
+    }
+    return population;
+}
@@ -0,0 +1,29 @@
+#ifndef BOARDPAINTER_H
+#define BOARDPAINTER_H
+
+#include <QPainter>
+#include <QColor>
+#include <QSize>
+#include <QRect>
+#include "generationsengine.h"
+#include "bitgrid.h"
+
+/**
+  *
+  * Drawing of a universe on any paint device: the game widget or an off-screen QImage.
+  * size is the area covered in pixels, cells are stretched to fill it.
+  * Large boards are painted through a viewport: only the cells (and grid lines) under the
+  * visible area, taken from whatever holds the board as a BitGrid region.
+ */
+
+class BoardPainter
+{
+public:
+    static void paintGrid(QPainter &p, const QSize &size, int rows, int columns, const QRect &area = QRect()); // lines crossing area (pixels), all if null
+    static int paintRegion(QPainter &p, const QSize &size, int rows, int columns, const QPoint &origin, const BitGrid &cells, const QColor &color); // part of a board, cells[0][0] at origin (column, row)
+    static QRect visibleCells(const QSize &size, int rows, int columns, const QRect &area); // cells under area (pixels)
+    static int paintStates(QPainter &p, const QSize &size, const GenerationsEngine &cells, const QColor &color); // live cells in color, refractory ones fading out
+    static QVector<QColor> stateRamp(const QColor &color, int states); // colour of each state, [0] unused
+};
+
+#endif // BOARDPAINTER_H
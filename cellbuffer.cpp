@@ -0,0 +1,59 @@
+#include "cellbuffer.h"
+
+
+//Constructor:
+CellMap::CellMap(int height, int width, MemoryUsage::Kind kind) :
+    h(0),
+    w(0),
+    cells(kind),
+    index(kind)
+{
+    resize(height, width);
+}
+
+
+//Size:
+int CellMap::height() const
+{
+    return h;
+}
+
+int CellMap::width() const
+{
+    return w;
+}
+
+void CellMap::resize(int height, int width)
+{
+    // +2 to array dimension to give a buffer zone.
+    h = qMax(0, height);
+    w = qMax(0, width);
+    cells.fill(false, (h + 2) * (w + 2));
+    index.fill(0, h + 2);
+    for(int k = 0; k < h + 2; k++){
+        index[k] = cells.data() + k * (w + 2);
+    }
+}
+
+void CellMap::clear()
+{
+    cells.fill(false);
+}
+
+bool **CellMap::rows() const
+{
+    return const_cast<bool**>(index.constData()); //As a bool** member would be.
+}
+
+void CellMap::swap(CellMap &other)
+{
+    qSwap(h, other.h);
+    qSwap(w, other.w);
+    cells.swap(other.cells);
+    index.swap(other.index);
+}
+
+qint64 CellMap::byteSize() const
+{
+    return cells.byteSize() + index.byteSize();
+}
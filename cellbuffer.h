@@ -0,0 +1,123 @@
+#ifndef CELLBUFFER_H
+#define CELLBUFFER_H
+
+#include <QtGlobal>
+#include "memoryusage.h"
+
+/**
+  *
+  * Owning storage of cells: one zeroed block, freed when the buffer is destroyed, cleared or
+  * reallocated for another size, with its size counted in MemoryUsage under a kind.
+  * Every board buffer of the engines (current and next generations, packed words, prefix
+  * tables, neighbour planes) is a CellBuffer. BitGrid copies made outside the engines (the
+  * previous board of a step, the clipboard, search and census snapshots) are not counted.
+  * Copies are deep; swap() exchanges the blocks (and their kinds) without copying, for
+  * double buffering.
+  * CellMap is the bool map of LifeEngine on top of it: rows [0..h+1][0..w+1] in a single
+  * block, indexed by a table of row pointers, instead of one allocation per row.
+ */
+
+template<typename T>
+class CellBuffer
+{
+public:
+    explicit CellBuffer(MemoryUsage::Kind kind = MemoryUsage::Board) : cells(0), n(0), usage(kind) {}
+    CellBuffer(int size, MemoryUsage::Kind kind) : cells(0), n(0), usage(kind) { fill(T(), size); }
+    CellBuffer(const CellBuffer &other) : cells(0), n(0), usage(other.usage)
+    {
+        allocate(other.n);
+        for(int i = 0; i < n; i++){ cells[i] = other.cells[i]; }
+    }
+    ~CellBuffer() { release(); }
+
+    CellBuffer &operator=(const CellBuffer &other)
+    {
+        if(this != &other){
+            CellBuffer copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    int size() const { return n; }
+    bool isEmpty() const { return n == 0; }
+    qint64 byteSize() const { return (qint64)n * sizeof(T); }
+    T *data() { return cells; }
+    const T *data() const { return cells; }
+    const T *constData() const { return cells; }
+    T &operator[](int i) { return cells[i]; }
+    const T &operator[](int i) const { return cells[i]; }
+
+    void fill(const T &value) { for(int i = 0; i < n; i++){ cells[i] = value; } }
+    void fill(const T &value, int size) // reallocated only if the size changes
+    {
+        if(size != n){
+            allocate(size);
+        }
+        fill(value);
+    }
+    void clear() { release(); } // frees the block
+    void swap(CellBuffer &other) { qSwap(cells, other.cells); qSwap(n, other.n); qSwap(usage, other.usage); }
+
+private:
+    T *cells;
+    int n;
+    MemoryUsage::Kind usage;
+
+    void allocate(int size)
+    {
+        release();
+        if(size > 0){
+            cells = new T[size]();
+            n = size;
+            MemoryUsage::add(usage, byteSize());
+        }
+    }
+    void release()
+    {
+        if(cells){
+            MemoryUsage::add(usage, -byteSize());
+            delete [] cells;
+        }
+        cells = 0;
+        n = 0;
+    }
+};
+
+template<typename T>
+inline void swap(CellBuffer<T> &a, CellBuffer<T> &b)
+{
+    a.swap(b); //qSwap() finds it.
+}
+
+
+class CellMap
+{
+public:
+    CellMap(int height, int width, MemoryUsage::Kind kind); // dead cells, buffer zone included
+
+    int height() const;
+    int width() const;
+    void resize(int height, int width); // every cell dead
+    void clear(); // every cell dead, same size
+    bool **rows() const; // map[0..h+1][0..w+1], valid until the next resize
+    bool *operator[](int k) { return index[k]; }
+    const bool *operator[](int k) const { return index[k]; }
+    void swap(CellMap &other); // the row pointers go with their cells
+    qint64 byteSize() const;
+
+private:
+    int h;
+    int w;
+    CellBuffer<bool> cells; // (h + 2) * (w + 2), row major
+    CellBuffer<bool*> index; // h + 2 row pointers into cells
+
+    Q_DISABLE_COPY(CellMap)
+};
+
+inline void swap(CellMap &a, CellMap &b)
+{
+    a.swap(b);
+}
+
+#endif // CELLBUFFER_H
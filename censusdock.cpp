@@ -0,0 +1,130 @@
+#include <QtConcurrent>
+#include <QSpinBox>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QLabel>
+#include <QFormLayout>
+#include <QVBoxLayout>
+#include "censusdock.h"
+#include "gamewidget.h"
+
+enum Column { ObjectCol, TypeCol, PeriodCol, VelocityCol, CountCol, CellsCol, ColCount };
+
+
+//Constructor:
+CensusDock::CensusDock(GameWidget *game, QWidget *parent) :
+    QDockWidget("Object census", parent),
+    game(game)
+{
+    setObjectName("censusDock");
+
+    periodBox = new QSpinBox;
+    periodBox->setRange(0, 100000);
+    periodBox->setValue(0);
+    periodBox->setSpecialValueText("Never");
+    periodBox->setToolTip("Take a census every so many generations while the game runs.");
+    maxPeriodBox = new QSpinBox;
+    maxPeriodBox->setRange(2, 1000);
+    maxPeriodBox->setValue(60);
+    maxPeriodBox->setToolTip("Generations run to find periods, longer ones are left unsettled.");
+    takeBut = new QPushButton(QIcon(":/icons/icons/info.png"), "Take census");
+
+    QFormLayout *form = new QFormLayout;
+    form->addRow("Every:", periodBox);
+    form->addRow("Periods up to:", maxPeriodBox);
+
+    summary = new QLabel("...");
+    summary->setWordWrap(true);
+
+    table = new QTableWidget(0, ColCount);
+    table->setHorizontalHeaderLabels(QStringList() << "Object" << "Type" << "Period" << "Velocity" << "Count" << "Cells");
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->verticalHeader()->hide();
+    table->horizontalHeader()->setStretchLastSection(true);
+
+    QWidget *box = new QWidget;
+    QVBoxLayout *layout = new QVBoxLayout(box);
+    layout->addLayout(form);
+    layout->addWidget(takeBut);
+    layout->addWidget(summary);
+    layout->addWidget(table);
+    setWidget(box);
+
+    connect(takeBut, SIGNAL(clicked()), this, SLOT(take()));
+    connect(&watcher, SIGNAL(finished()), this, SLOT(finished()));
+    connect(game, SIGNAL(sendGen(int)), this, SLOT(generation(int)));
+}
+
+void CensusDock::setGame(GameWidget *g)
+{
+    disconnect(game, SIGNAL(sendGen(int)), this, SLOT(generation(int)));
+    game = g;
+    connect(game, SIGNAL(sendGen(int)), this, SLOT(generation(int)));
+}
+
+CensusDock::~CensusDock()
+{
+    watcher.waitForFinished();
+}
+
+
+//Methods:
+void CensusDock::take()
+{
+    if(watcher.isRunning()){
+        return; //Skipped, the running one reports soon.
+    }
+    Checkpoint c = game->checkpoint();
+    if(c.states > 2){
+        summary->setText("The census only follows two state rules.");
+        return;
+    }
+    ObjectCensus::Input in;
+    in.board = c.board;
+    in.rule = game->rule();
+    in.neighMode = c.neighMode;
+    in.edgeMode = c.edgeMode;
+    in.generation = c.generation;
+    in.maxPeriod = maxPeriodBox->value();
+    summary->setText(QString("Taking a census of generation %1...").arg(c.generation));
+    watcher.setFuture(QtConcurrent::run(ObjectCensus::take, in));
+}
+
+void CensusDock::generation(int g)
+{
+    if(periodBox->value() > 0 && isVisible() && g % periodBox->value() == 0){
+        take();
+    }
+}
+
+void CensusDock::finished()
+{
+    ObjectCensus::Result r = watcher.result();
+    int settled = 0;
+    table->setSortingEnabled(false);
+    table->setRowCount(0);
+    foreach(ObjectCensus::Object o, r.census){
+        if(o.type != ObjectCensus::Unsettled){ settled += o.count; }
+        int row = table->rowCount();
+        table->insertRow(row);
+        QTableWidgetItem *object = new QTableWidgetItem(o.name.isEmpty() ? o.key : o.name);
+        object->setToolTip(o.key);
+        table->setItem(row, ObjectCol, object);
+        table->setItem(row, TypeCol, new QTableWidgetItem(ObjectCensus::className(o.type)));
+        QTableWidgetItem *period = new QTableWidgetItem;
+        if(o.period > 0){ period->setData(Qt::DisplayRole, o.period); }
+        table->setItem(row, PeriodCol, period);
+        table->setItem(row, VelocityCol, new QTableWidgetItem(ObjectCensus::velocity(o)));
+        QTableWidgetItem *count = new QTableWidgetItem;
+        count->setData(Qt::DisplayRole, o.count);
+        table->setItem(row, CountCol, count);
+        QTableWidgetItem *cells = new QTableWidgetItem;
+        cells->setData(Qt::DisplayRole, o.cells);
+        table->setItem(row, CellsCol, cells);
+    }
+    table->setSortingEnabled(true);
+    summary->setText(QString("Generation %1: %2 objects (%3 settled), %4 kinds, %5 cells.")
+                     .arg(r.generation).arg(r.objects).arg(settled).arg(r.census.size()).arg(r.population));
+}
@@ -0,0 +1,49 @@
+#ifndef CENSUSDOCK_H
+#define CENSUSDOCK_H
+
+#include <QDockWidget>
+#include <QFutureWatcher>
+#include "objectcensus.h"
+
+class GameWidget;
+class QSpinBox;
+class QPushButton;
+class QTableWidget;
+class QLabel;
+
+/**
+  *
+  * Dockable object census of the game's board. The board is copied and the census
+  * (ObjectCensus::take) runs on the thread pool, so the simulation keeps going;
+  * a census asked for while one runs is skipped. It can also follow the game,
+  * every so many generations. Objects are listed most common first in a sortable table.
+ */
+
+class CensusDock : public QDockWidget
+{
+    Q_OBJECT
+
+public:
+    explicit CensusDock(GameWidget *game, QWidget *parent = 0);
+    ~CensusDock();
+
+    void setGame(GameWidget *g); //Census of another tab's game
+
+public slots:
+    void take(); //Census button
+
+private slots:
+    void generation(int g); //Follows the game
+    void finished();
+
+private:
+    GameWidget *game;
+    QSpinBox *periodBox; //Census every n generations, 0 for never
+    QSpinBox *maxPeriodBox; //Generations run by each census
+    QPushButton *takeBut;
+    QLabel *summary;
+    QTableWidget *table;
+    QFutureWatcher<ObjectCensus::Result> watcher;
+};
+
+#endif // CENSUSDOCK_H
@@ -0,0 +1,187 @@
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QtConcurrentRun>
+#include <cstring>
+#include "checkpointer.h"
+
+static const quint32 checkpointMagic = 0x4c43484b; // "LCHK"
+static const quint32 checkpointVersion = 3; //2: radius and middle cell. 3: Generations states.
+
+
+//Constructor:
+Checkpointer::Checkpointer(const QString &directory, QObject *parent) :
+    QObject(parent),
+    dir(directory),
+    everyGens(0),
+    everySecs(0),
+    lastGen(0),
+    hasPending(false),
+    keep(3)
+{
+    clock.start();
+    connect(&watcher, SIGNAL(finished()), this, SLOT(writeFinished()));
+}
+
+//Destructor:
+Checkpointer::~Checkpointer()
+{
+    //Don't let the process end in the middle of a write.
+    watcher.waitForFinished();
+}
+
+
+//Scheduling:
+void Checkpointer::setPeriod(int generations, int seconds)
+{
+    everyGens = qMax(0, generations);
+    everySecs = qMax(0, seconds);
+    clock.restart();
+}
+
+bool Checkpointer::isEnabled() const
+{
+    return everyGens > 0 || everySecs > 0;
+}
+
+bool Checkpointer::due(int generation) const
+{
+    if(!isEnabled()){
+        return false;
+    }
+    int since = generation >= lastGen ? generation - lastGen : generation; //Board was cleared or rewound.
+    return (everyGens > 0 && since >= everyGens)
+            || (everySecs > 0 && clock.elapsed() >= (qint64)everySecs * 1000);
+}
+
+void Checkpointer::submit(const Checkpoint &c)
+{
+    lastGen = c.generation;
+    clock.restart();
+    if(watcher.isRunning()){
+        pending = c; //Replaces any older waiting checkpoint.
+        hasPending = true;
+        return;
+    }
+    startWrite(c);
+}
+
+void Checkpointer::startWrite(const Checkpoint &c)
+{
+    watcher.setFuture(QtConcurrent::run(&Checkpointer::writeAndPrune, dir, c, keep));
+}
+
+void Checkpointer::writeFinished()
+{
+    QString filename = watcher.result();
+    if(!filename.isEmpty()){
+        emit written(filename);
+    }
+    if(hasPending){
+        hasPending = false;
+        startWrite(pending);
+        pending = Checkpoint();
+    }
+}
+
+QString Checkpointer::directory() const
+{
+    return dir;
+}
+
+
+//Files (worker thread side):
+QString Checkpointer::writeAndPrune(const QString &directory, const Checkpoint &c, int keep)
+{
+    QDir d(directory);
+    if(!d.exists() && !d.mkpath(".")){
+        return QString();
+    }
+    QString filename = d.filePath(QString("checkpoint-%1.lchk").arg(c.generation, 9, 10, QChar('0')));
+    if(!write(filename, c)){
+        return QString();
+    }
+    //Only the most recent checkpoints are kept.
+    QFileInfoList old = d.entryInfoList(QStringList() << "checkpoint-*.lchk", QDir::Files, QDir::Time);
+    for(int i = keep; i < old.size(); i++){
+        if(old[i].absoluteFilePath() != QFileInfo(filename).absoluteFilePath()){
+            QFile::remove(old[i].absoluteFilePath());
+        }
+    }
+    return filename;
+}
+
+bool Checkpointer::write(const QString &filename, const Checkpoint &c)
+{
+    //QSaveFile: a crash while writing leaves the previous file intact.
+    QSaveFile file(filename);
+    if(!file.open(QIODevice::WriteOnly)){
+        return false;
+    }
+    const QVector<quint64> &words = c.board.words();
+    QByteArray raw((const char *)words.constData(), words.size() * sizeof(quint64));
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << checkpointMagic << checkpointVersion;
+    out << (qint32)c.generation << c.birth << c.survival << (qint8)c.neighMode << (qint8)c.edgeMode;
+    out << (qint32)c.radius << c.middle;
+    out << (qint32)c.board.height() << (qint32)c.board.width();
+    out << qCompress(raw);
+    out << (qint32)c.states << (c.states > 2 ? qCompress(c.cells) : QByteArray());
+    return file.commit();
+}
+
+bool Checkpointer::read(const QString &filename, Checkpoint &c)
+{
+    QFile file(filename);
+    if(!file.open(QIODevice::ReadOnly)){
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    quint32 magic, version;
+    qint32 generation, h, w, radius = 1, states = 2;
+    bool middle = false;
+    qint8 neigh, edge;
+    QByteArray packed, cells;
+    in >> magic >> version;
+    if(magic != checkpointMagic || version < 1 || version > checkpointVersion){
+        return false;
+    }
+    in >> generation >> c.birth >> c.survival >> neigh >> edge;
+    if(version >= 2){
+        in >> radius >> middle;
+    }
+    in >> h >> w >> packed;
+    if(version >= 3){
+        in >> states >> cells;
+        if(states > 2){
+            cells = qUncompress(cells);
+        }
+    }
+    if(in.status() != QDataStream::Ok || h <= 0 || w <= 0 || (states > 2 && cells.size() != h * w)){
+        return false;
+    }
+    BitGrid board(h, w);
+    QByteArray raw = qUncompress(packed);
+    if(raw.size() != board.byteSize()){
+        return false;
+    }
+    memcpy(board.words().data(), raw.constData(), raw.size());
+    c.generation = generation;
+    c.neighMode = neigh;
+    c.edgeMode = edge;
+    c.radius = radius;
+    c.middle = middle;
+    c.states = states;
+    c.board = board;
+    c.cells = states > 2 ? cells : QByteArray();
+    return true;
+}
+
+QString Checkpointer::newest(const QString &directory)
+{
+    QFileInfoList files = QDir(directory).entryInfoList(QStringList() << "checkpoint-*.lchk", QDir::Files, QDir::Time);
+    return files.isEmpty() ? QString() : files.first().absoluteFilePath();
+}
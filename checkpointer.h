@@ -0,0 +1,71 @@
+#ifndef CHECKPOINTER_H
+#define CHECKPOINTER_H
+
+#include <QObject>
+#include <QString>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include "bitgrid.h"
+
+/**
+  *
+  * Periodic checkpoints of a running game.
+  * The board is handed over as an implicitly shared BitGrid, so taking a checkpoint
+  * costs one packing pass; compression and writing happen on a worker thread.
+  * While a write is in progress only the newest waiting checkpoint is kept.
+ */
+
+struct Checkpoint
+{
+    Checkpoint() : generation(0), neighMode('m'), edgeMode('p'), radius(1), middle(false), states(2) {}
+    int generation;
+    QString birth; // birth states as typed in the rule input
+    QString survival; // survival states as typed in the rule input
+    char neighMode;
+    char edgeMode;
+    int radius; // > 1 for Larger than Life, states are then "34-45" ranges
+    bool middle;
+    int states; // > 2 for Generations rules
+    BitGrid board; // live cells
+    QByteArray cells; // states > 2: state of every cell, row major
+};
+
+class Checkpointer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit Checkpointer(const QString &directory, QObject *parent = 0);
+    ~Checkpointer();
+
+    void setPeriod(int generations, int seconds); // 0 disables either trigger
+    bool isEnabled() const;
+    bool due(int generation) const; // is a checkpoint expected at this generation?
+    void submit(const Checkpoint &c); // write in the background
+
+    QString directory() const;
+    static QString newest(const QString &directory); // most recent checkpoint file, empty if none
+    static bool read(const QString &filename, Checkpoint &c);
+    static bool write(const QString &filename, const Checkpoint &c);
+
+signals:
+    void written(QString filename);
+
+private slots:
+    void writeFinished();
+
+private:
+    QString dir;
+    int everyGens;
+    int everySecs;
+    int lastGen; // generation of the last checkpoint
+    QElapsedTimer clock; // time since the last checkpoint
+    QFutureWatcher<QString> watcher;
+    Checkpoint pending;
+    bool hasPending;
+    int keep; // number of files kept in the directory
+
+    void startWrite(const Checkpoint &c);
+    static QString writeAndPrune(const QString &directory, const Checkpoint &c, int keep);
+};
+
+#endif // CHECKPOINTER_H
@@ -0,0 +1,20 @@
+#-------------------------------------------------
+#
+# Headless runner: same engine as the GUI, no widgets.
+#
+#-------------------------------------------------
+
+QT       += core network
+QT       -= gui
+
+TARGET = automata-cli
+CONFIG   += console
+CONFIG   -= app_bundle
+TEMPLATE = app
+
+include(../engine.pri)
+
+SOURCES += main.cpp \
+    domains.cpp
+
+HEADERS += domains.h
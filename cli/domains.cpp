@@ -0,0 +1,337 @@
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QLocalSocket>
+#include <QProcess>
+#include <cstring>
+#include "domains.h"
+
+//Messages are blocks with a length prefix, both ends are on the same machine.
+static bool sendBlock(QLocalSocket *socket, const QByteArray &block)
+{
+    qint32 size = block.size();
+    socket->write((const char *)&size, sizeof(size));
+    socket->write(block);
+    while(socket->bytesToWrite() > 0){
+        if(!socket->waitForBytesWritten(-1)){
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool readBlock(QLocalSocket *socket, QByteArray &block)
+{
+    qint32 size;
+    while(socket->bytesAvailable() < (qint64)sizeof(size)){
+        if(!socket->waitForReadyRead(-1)){
+            return false;
+        }
+    }
+    socket->read((char *)&size, sizeof(size));
+    while(socket->bytesAvailable() < size){
+        if(!socket->waitForReadyRead(-1)){
+            return false;
+        }
+    }
+    block = socket->read(size);
+    return true;
+}
+
+static void queueBlock(QLocalSocket *socket, const QByteArray &block)
+{
+    //Buffered by the socket, written while it is waited on.
+    qint32 size = block.size();
+    socket->write((const char *)&size, sizeof(size));
+    socket->write(block);
+}
+
+static bool takeBlock(QLocalSocket *socket, QByteArray &block)
+{
+    //Without waiting: false until the whole block is in.
+    qint32 size;
+    if(socket->peek((char *)&size, sizeof(size)) < (qint64)sizeof(size)
+            || socket->bytesAvailable() < (qint64)sizeof(size) + size){
+        return false;
+    }
+    socket->read((char *)&size, sizeof(size));
+    block = socket->read(size);
+    return true;
+}
+
+static bool exchange(QLocalSocket *up, const QByteArray &toUp, QByteArray &fromUp,
+                     QLocalSocket *down, const QByteArray &toDown, QByteArray &fromDown)
+{
+    //Both halos are queued before either is read, then both sockets are pumped until the
+    //blocks are in and out. Blocking writes would deadlock as soon as a halo is larger than
+    //the socket buffer: every worker would wait in its write for a neighbour doing the same.
+    QLocalSocket *sockets[2] = { up, down };
+    QByteArray *blocks[2] = { &fromUp, &fromDown };
+    bool in[2] = { up == 0, down == 0 };
+    if(up){ queueBlock(up, toUp); }
+    if(down){ queueBlock(down, toDown); }
+    forever {
+        bool done = true;
+        for(int i = 0; i < 2; i++){
+            QLocalSocket *socket = sockets[i];
+            if(!socket){
+                continue;
+            }
+            if(socket->state() != QLocalSocket::ConnectedState){
+                return false;
+            }
+            in[i] = in[i] || takeBlock(socket, *blocks[i]);
+            if(!in[i]){
+                socket->waitForReadyRead(1); //Writes its queue meanwhile. Short, not to stall the other one.
+            } else if(socket->bytesToWrite() > 0){
+                socket->waitForBytesWritten(1);
+            }
+            done = done && in[i] && socket->bytesToWrite() == 0;
+        }
+        if(done){
+            return true;
+        }
+    }
+}
+
+static QByteArray rowsOf(const BitGrid &grid, int first, int count)
+{
+    return QByteArray((const char *)grid.row(first), count * grid.wordsPerRow() * sizeof(quint64));
+}
+
+static void setRows(BitGrid &grid, int first, const QByteArray &rows)
+{
+    int size = qMin(rows.size(), (grid.height() - first) * grid.wordsPerRow() * (int)sizeof(quint64));
+    memcpy(grid.row(first), rows.constData(), size);
+}
+
+
+//Constructor:
+DomainCoordinator::DomainCoordinator() :
+    h(0),
+    w(0)
+{
+}
+
+DomainCoordinator::~DomainCoordinator()
+{
+    stop();
+}
+
+
+//Methods:
+bool DomainCoordinator::start(int processes, const LifeEngine &engine, const BitGrid &board)
+{
+    stop();
+    h = board.height();
+    w = board.width();
+    int radius = engine.radius();
+    int n = qBound(1, processes, qMax(1, h / radius)); //Bands at least as high as the halos.
+    QString name = QString("automata-cli-%1").arg(QCoreApplication::applicationPid());
+    QLocalServer::removeServer(name);
+    if(!server.listen(name)){
+        message = "cannot listen on " + name + ": " + server.errorString();
+        return false;
+    }
+    for(int i = 0; i < n; i++){
+        QProcess *worker = new QProcess;
+        worker->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        worker->start(QCoreApplication::applicationFilePath(), QStringList() << "--worker" << name << QString::number(i));
+        workers << worker;
+        sockets << 0;
+        firstRows << (qint64)i * h / n;
+    }
+    for(int i = 0; i < n; i++){
+        QByteArray hello;
+        if(!server.waitForNewConnection(30000)){
+            message = "a worker did not start";
+            return false;
+        }
+        QLocalSocket *socket = server.nextPendingConnection();
+        if(!readBlock(socket, hello) || hello.toInt() < 0 || hello.toInt() >= n){
+            message = "a worker did not answer";
+            return false;
+        }
+        sockets[hello.toInt()] = socket;
+    }
+    for(int i = 0; i < n; i++){
+        int rows = (i + 1 < n ? firstRows[i + 1] : h) - firstRows[i];
+        QByteArray setup;
+        QDataStream out(&setup, QIODevice::WriteOnly);
+        out << engine.rule() << (qint8)engine.neighMode() << (qint8)engine.edgeMode()
+            << (qint32)w << (qint32)rows << (qint32)radius << (qint32)n << rowsOf(board, firstRows[i], rows);
+        if(!sendBlock(sockets[i], setup)){
+            message = "a worker left";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DomainCoordinator::step(qint64 &population, qint64 &changed)
+{
+    population = 0;
+    changed = 0;
+    foreach(QLocalSocket *socket, sockets){
+        if(!sendBlock(socket, "S")){
+            message = "a worker left";
+            return false;
+        }
+    }
+    foreach(QLocalSocket *socket, sockets){
+        QByteArray report;
+        if(!readBlock(socket, report)){
+            message = "a worker left";
+            return false;
+        }
+        QDataStream in(report);
+        qint64 p;
+        qint64 c;
+        in >> p >> c;
+        population += p;
+        changed += c;
+    }
+    return true;
+}
+
+BitGrid DomainCoordinator::gather()
+{
+    BitGrid board(h, w);
+    foreach(QLocalSocket *socket, sockets){
+        sendBlock(socket, "G");
+    }
+    for(int i = 0; i < sockets.size(); i++){
+        QByteArray rows;
+        if(readBlock(sockets[i], rows)){
+            setRows(board, firstRows[i], rows);
+        }
+    }
+    return board;
+}
+
+int DomainCoordinator::processes() const
+{
+    return workers.size();
+}
+
+QString DomainCoordinator::error() const
+{
+    return message;
+}
+
+void DomainCoordinator::stop()
+{
+    foreach(QLocalSocket *socket, sockets){
+        if(socket){ sendBlock(socket, "Q"); }
+    }
+    foreach(QProcess *worker, workers){
+        if(!worker->waitForFinished(3000)){
+            worker->kill();
+            worker->waitForFinished(1000);
+        }
+        delete worker;
+    }
+    qDeleteAll(sockets);
+    workers.clear();
+    sockets.clear();
+    firstRows.clear();
+    server.close();
+}
+
+int DomainCoordinator::runWorker(const QString &server, int index)
+{
+    //Own server first, the worker above connects to it once everyone is set up.
+    QLocalServer peers;
+    QString name = server + "-" + QString::number(index);
+    QLocalServer::removeServer(name);
+    QLocalSocket coordinator;
+    coordinator.connectToServer(server);
+    if(!peers.listen(name) || !coordinator.waitForConnected(30000) || !sendBlock(&coordinator, QByteArray::number(index))){
+        return 1;
+    }
+    QByteArray block;
+    if(!readBlock(&coordinator, block)){
+        return 1;
+    }
+    QDataStream in(block);
+    QString rule;
+    qint8 neigh;
+    qint8 edge;
+    qint32 width;
+    qint32 rows;
+    qint32 radius;
+    qint32 count;
+    QByteArray cells;
+    in >> rule >> neigh >> edge >> width >> rows >> radius >> count >> cells;
+    BitGrid band(rows, width);
+    setRows(band, 0, cells);
+    LifeEngine engine(rows + 2 * radius, width);
+    engine.setThreadCount(1); //Processes are the parallelism.
+    engine.setNeighMode(neigh);
+    engine.setRule(rule);
+    engine.setEdgeMode(edge); //Columns wrap here, rows through the halos.
+
+    //Neighbour bands: this worker connects to the one below, the one above connects to it.
+    bool torus = edge == 't';
+    bool hasUp = torus ? count > 1 : index > 0;
+    bool hasDown = torus ? count > 1 : index < count - 1;
+    QLocalSocket down;
+    QLocalSocket *up = 0;
+    if(hasDown){
+        down.connectToServer(server + "-" + QString::number((index + 1) % count));
+        if(!down.waitForConnected(30000)){
+            return 1;
+        }
+    }
+    if(hasUp){
+        if(!peers.waitForNewConnection(30000)){
+            return 1;
+        }
+        up = peers.nextPendingConnection();
+    }
+
+    forever {
+        if(!readBlock(&coordinator, block) || block == "Q"){
+            break;
+        }
+        if(block == "G"){
+            sendBlock(&coordinator, rowsOf(band, 0, rows));
+            continue;
+        }
+        //Halo rows: the neighbours' edges, dead beyond a plane, our own when one band is a torus.
+        QByteArray top;
+        QByteArray bottom;
+        if(!exchange(up, rowsOf(band, 0, radius), top,
+                     hasDown ? &down : 0, rowsOf(band, rows - radius, radius), bottom)){
+            return 1;
+        }
+        if(torus && count == 1){
+            top = rowsOf(band, rows - radius, radius);
+            bottom = rowsOf(band, 0, radius);
+        }
+        BitGrid full(rows + 2 * radius, width);
+        setRows(full, 0, top);
+        setRows(full, radius, rowsOf(band, 0, rows));
+        setRows(full, radius + rows, bottom);
+        engine.setBoard(full);
+        engine.step(); //Halo rows come out wrong, they are dropped.
+        BitGrid next = engine.board();
+        qint64 population = 0;
+        qint64 changed = 0;
+        for(int k = 0; k < rows; k++){
+            const quint64 *a = band.row(k);
+            const quint64 *b = next.row(k + radius);
+            for(int i = 0; i < band.wordsPerRow(); i++){
+                population += qPopulationCount(b[i]);
+                changed += qPopulationCount(a[i] ^ b[i]);
+            }
+        }
+        setRows(band, 0, rowsOf(next, radius, rows));
+        QByteArray report;
+        QDataStream out(&report, QIODevice::WriteOnly);
+        out << population << changed;
+        if(!sendBlock(&coordinator, report)){
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,50 @@
+#ifndef DOMAINS_H
+#define DOMAINS_H
+
+#include <QList>
+#include <QString>
+#include <QLocalServer>
+#include "lifeengine.h"
+
+class QProcess;
+class QLocalSocket;
+
+/**
+  *
+  * One universe spread over worker processes: the board is cut into bands of whole rows,
+  * one per worker (automata-cli started again with --worker). Every generation each worker
+  * sends its first and last rows (as many as the neighbourhood radius) to the workers
+  * above and below over local sockets, steps its band with those halo rows around it,
+  * and reports its population to the coordinator. On a torus the halos wrap from the last
+  * band to the first one, columns wrap inside each band as in LifeEngine. The result is
+  * the same, bit for bit, as one LifeEngine stepping the whole board.
+  * Two state rules only: the halos carry live cells, not refractory states.
+ */
+
+class DomainCoordinator
+{
+public:
+    DomainCoordinator();
+    ~DomainCoordinator(); // stops the workers
+
+    bool start(int processes, const LifeEngine &engine, const BitGrid &board); // rule and modes from engine
+    bool step(qint64 &population, qint64 &changed); // one generation on every band
+    BitGrid gather(); // whole board
+    int processes() const;
+    QString error() const;
+
+    static int runWorker(const QString &server, int index); // worker process' main
+
+private:
+    QLocalServer server;
+    QList<QProcess *> workers;
+    QList<QLocalSocket *> sockets; // by band, top first
+    QList<int> firstRows; // by band
+    int h;
+    int w;
+    QString message;
+
+    void stop();
+};
+
+#endif // DOMAINS_H
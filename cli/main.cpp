@@ -0,0 +1,416 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QThread>
+#include "lifeengine.h"
+#include "patternio.h"
+#include "perfcounters.h"
+#include "domains.h"
+#include "framering.h"
+#include "soup.h"
+#include "memoryusage.h"
+
+/**
+  *
+  * automata-cli: runs a pattern for a number of generations without any window or timer.
+  *   automata-cli glider.rle -g 1000 --rule B36/S23 --edge torus -j 8 --stats every -o out.rle
+  * Rules may also be Larger than Life: --rule R5,C0,M1,S34..58,B34..45,NM
+  * --counters adds the hardware counters of each step (Linux), when the system lets us read them.
+ * --processes spreads the board over worker processes (bands of rows exchanging halos), the
+ * workers are this program started again as "automata-cli --worker <server> <band>".
+ * --publish shares every generation in a shared memory frame ring, which
+ * "automata-cli --watch <key>" reads back: it is the reference reader for other tools.
+ * --soup fills the board with a random soup, kept with its seed in the -o file; with --size
+ * the pattern can be left out: automata-cli --soup 0.35,D4,42 -s 512x512 -g 1000
+ * --symmetry D8 steps only the fundamental domain of a symmetric board (see LifeEngine).
+ * The summary ends with the bytes held by cells, now and at the peak (see MemoryUsage).
+ */
+
+static int fail(const QString &message)
+{
+    QTextStream(stderr) << "automata-cli: " << message << "\n";
+    return 1;
+}
+
+static BitGrid placed(const BitGrid &pattern, int height, int width)
+{
+    //Pattern centered on a board of the requested size, cropped if larger.
+    BitGrid board(height, width);
+    int top = (height - pattern.height()) / 2;
+    int left = (width - pattern.width()) / 2;
+    for(int k = 0; k < pattern.height(); k++){
+        for(int j = 0; j < pattern.width(); j++){
+            int y = top + k;
+            int x = left + j;
+            if(y >= 0 && y < height && x >= 0 && x < width && pattern.cell(k, j)){
+                board.setCell(y, x, true);
+            }
+        }
+    }
+    return board;
+}
+
+static int watch(const QString &key)
+{
+    //Reference frame ring reader: one CSV row per frame seen, until the publisher is gone.
+    QTextStream out(stdout);
+    FrameReader reader;
+    QElapsedTimer waiting;
+    waiting.start();
+    while(!reader.attach(key)){
+        if(waiting.elapsed() > 5000){
+            return fail(reader.error());
+        }
+        QThread::msleep(50);
+    }
+    out << "frame,generation,population,hash,missed\n";
+    quint64 next = 0;
+    while(true){
+        if(reader.isClosed()){
+            //Stopped, or remade for another board size: follow it if it comes back.
+            reader.detach();
+            waiting.restart();
+            while(!reader.attach(key) || reader.isClosed()){
+                if(waiting.elapsed() > 5000){
+                    return 0;
+                }
+                QThread::msleep(50);
+            }
+            next = 0;
+            continue;
+        }
+        quint64 frames = reader.frames();
+        if(frames <= next){
+            QThread::msleep(1);
+            continue;
+        }
+        //Zero-copy: count the cells in place, then make sure the slot wasn't rewritten meanwhile.
+        quint64 n = frames - 1;
+        const quint64 *cells = reader.cells(n);
+        qint64 population = 0;
+        for(int i = 0; cells && i < reader.height() * reader.wordsPerRow(); i++){
+            population += qPopulationCount(cells[i]);
+        }
+        Frame frame;
+        if(!cells || !reader.isValid(n) || !reader.read(n, frame) || frame.population != population){
+            continue; //Overtaken by the publisher, take the next newest.
+        }
+        out << frame.number << "," << frame.generation << "," << frame.population << ","
+            << QString::number(frame.hash, 16) << "," << (frame.number - next) << "\n";
+        out.flush();
+        next = frames;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("automata-cli");
+    if(argc == 4 && QString(argv[1]) == "--worker"){
+        return DomainCoordinator::runWorker(argv[2], QString(argv[3]).toInt());
+    }
+    if(argc == 3 && QString(argv[1]) == "--watch"){
+        return watch(argv[2]);
+    }
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Runs a life-like automaton pattern without the GUI.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("pattern", "Pattern file (.laut, .rle or .cells).");
+    QCommandLineOption genOpt(QStringList() << "g" << "generations", "Number of generations to run (default 100).", "n", "100");
+    QCommandLineOption ruleOpt(QStringList() << "r" << "rule", "Rule, e.g. B3/S23 or R5,C0,M1,S34..58,B34..45,NM (default: the file's).", "rule");
+    QCommandLineOption neighOpt(QStringList() << "n" << "neighbourhood", "moore or vonneumann (default: the file's).", "mode");
+    QCommandLineOption edgeOpt(QStringList() << "e" << "edge", "torus or plane (default: the file's).", "mode");
+    QCommandLineOption sizeOpt(QStringList() << "s" << "size", "Board size HxW, the pattern is centered (default: the file's).", "HxW");
+    QCommandLineOption threadOpt(QStringList() << "j" << "threads", "Worker threads (default: one per core).", "n");
+    QCommandLineOption processOpt(QStringList() << "p" << "processes", "Worker processes, each stepping a band of rows (default: none, run here).", "n");
+    QCommandLineOption statsOpt("stats", "none, summary or every (default summary).", "level", "summary");
+    QCommandLineOption formatOpt("format", "csv or json (default csv).", "format", "csv");
+    QCommandLineOption outOpt(QStringList() << "o" << "output", "Write the final board (.laut, .rle or .cells).", "file");
+    QCommandLineOption countersOpt("counters", "Read hardware performance counters around each step (Linux perf_event).");
+    QCommandLineOption soupOpt("soup", "Start from a random soup: density[,C1|C2|C4|D4|D8[,seed]] (default symmetry C1, a new seed).", "soup");
+    QCommandLineOption symmetryOpt("symmetry", "Step only the symmetric part of the board while it has the group: C2, C4, D4 or D8 (any) (default C1: every cell).", "group");
+    QCommandLineOption publishOpt("publish", "Share every generation in a shared memory frame ring (read it with --watch <key>).", "key");
+    parser.addOption(genOpt);
+    parser.addOption(ruleOpt);
+    parser.addOption(neighOpt);
+    parser.addOption(edgeOpt);
+    parser.addOption(sizeOpt);
+    parser.addOption(threadOpt);
+    parser.addOption(processOpt);
+    parser.addOption(statsOpt);
+    parser.addOption(formatOpt);
+    parser.addOption(outOpt);
+    parser.addOption(countersOpt);
+    parser.addOption(publishOpt);
+    parser.addOption(soupOpt);
+    parser.addOption(symmetryOpt);
+    parser.process(app);
+
+    //Arguments:
+    bool soupOnly = parser.positionalArguments().isEmpty() && parser.isSet(soupOpt) && parser.isSet(sizeOpt);
+    if(parser.positionalArguments().size() != 1 && !soupOnly){
+        parser.showHelp(1);
+    }
+    Pattern pattern;
+    QString input = soupOnly ? QString("the soup") : parser.positionalArguments().first();
+    if(!soupOnly && !PatternIO::read(input, pattern)){
+        return fail("cannot read pattern " + input);
+    }
+    bool ok;
+    int generations = parser.value(genOpt).toInt(&ok);
+    if(!ok || generations < 0){
+        return fail("invalid generation count");
+    }
+    LifeEngine engine(1, 1);
+    engine.setNeighMode(pattern.neighMode); //Larger than Life rules carry their own.
+    if(!engine.setRule(PatternIO::rule(pattern))){
+        return fail("invalid rule in " + input);
+    }
+    if(parser.isSet(ruleOpt) && !engine.setRule(parser.value(ruleOpt))){
+        return fail("invalid rule " + parser.value(ruleOpt));
+    }
+    if(parser.isSet(neighOpt)){
+        QString mode = parser.value(neighOpt).toLower();
+        if(mode != "moore" && mode != "vonneumann"){
+            return fail("invalid neighbourhood " + mode);
+        }
+        engine.setNeighMode(mode == "moore" ? 'm' : 'v');
+    }
+    engine.setEdgeMode(pattern.edgeMode);
+    if(parser.isSet(edgeOpt)){
+        QString mode = parser.value(edgeOpt).toLower();
+        if(mode != "torus" && mode != "plane"){
+            return fail("invalid edge mode " + mode);
+        }
+        engine.setEdgeMode(mode == "torus" ? 't' : 'p');
+    }
+    BitGrid board = pattern.board;
+    if(parser.isSet(sizeOpt)){
+        QStringList hw = parser.value(sizeOpt).toLower().split('x');
+        int h = hw.size() == 2 ? hw[0].toInt() : 0;
+        int w = hw.size() == 2 ? hw[1].toInt() : 0;
+        if(h <= 0 || w <= 0){
+            return fail("invalid size " + parser.value(sizeOpt));
+        }
+        board = placed(board, h, w);
+    }
+    if(parser.isSet(soupOpt)){
+        QStringList parts = parser.value(soupOpt).split(',');
+        double density = parts[0].toDouble(&ok);
+        Soup::Symmetry symmetry = Soup::C1;
+        quint64 seed = Soup::randomSeed();
+        if(!ok || density < 0 || density > 1 || parts.size() > 3
+                || (parts.size() > 1 && !Soup::parseSymmetry(parts[1], symmetry))){
+            return fail("invalid soup " + parser.value(soupOpt));
+        }
+        if(parts.size() > 2){
+            seed = parts[2].toULongLong(&ok);
+            if(!ok){
+                return fail("invalid soup seed " + parts[2]);
+            }
+        }
+        board = Soup::generate(board.height(), board.width(), density, seed, symmetry);
+        pattern.board = board;
+        pattern.cells.clear(); //No refractory cells in a soup.
+        pattern.soup = Soup::describe(density, symmetry, seed);
+    }
+    if(parser.isSet(threadOpt)){
+        int n = parser.value(threadOpt).toInt(&ok);
+        if(!ok || n < 1){
+            return fail("invalid thread count");
+        }
+        engine.setThreadCount(n);
+        QThreadPool::globalInstance()->setMaxThreadCount(n);
+    }
+    int processes = 0;
+    if(parser.isSet(processOpt)){
+        processes = parser.value(processOpt).toInt(&ok);
+        if(!ok || processes < 1){
+            return fail("invalid process count");
+        }
+    }
+    QString stats = parser.value(statsOpt);
+    QString format = parser.value(formatOpt);
+    if((stats != "none" && stats != "summary" && stats != "every") || (format != "csv" && format != "json")){
+        return fail("invalid --stats or --format value");
+    }
+    engine.resize(board.height(), board.width());
+    engine.setBoard(board);
+    if(engine.states() > 2 && board.height() == pattern.board.height() && board.width() == pattern.board.width()){
+        engine.setCellStates(pattern.cells); //Refractory cells of Generations rules, unless resized.
+    }
+    if(parser.isSet(symmetryOpt)){
+        Soup::Symmetry group;
+        if(!Soup::parseSymmetry(parser.value(symmetryOpt), group)){
+            return fail("invalid --symmetry value");
+        }
+        engine.setSymmetry(group); //Not with --processes: the workers step their bands whole.
+    }
+    DomainCoordinator domains;
+    if(processes > 0){
+        if(engine.states() > 2){
+            return fail("Generations rules can't be split over processes");
+        }
+        if(!domains.start(processes, engine, board)){
+            return fail(domains.error());
+        }
+    }
+
+    //Frames:
+    FramePublisher publisher;
+    if(parser.isSet(publishOpt)){
+        if(processes > 0){
+            return fail("--publish needs the whole board in this process, not with --processes");
+        }
+        if(!publisher.start(parser.value(publishOpt), engine.height(), engine.width())){
+            return fail(publisher.error());
+        }
+        publisher.publish(0, engine.board());
+    }
+
+    //Counters:
+    PerfCounters counters;
+    QList<PerfCounters::Counter> measured;
+    if(parser.isSet(countersOpt)){
+        if(!counters.open()){
+            QTextStream(stderr) << "automata-cli: hardware counters unavailable (" << counters.error() << "), continuing without them\n";
+        }
+        for(int c = 0; c < PerfCounters::CounterCount; c++){
+            if(counters.isAvailable((PerfCounters::Counter)c)){ measured << (PerfCounters::Counter)c; }
+        }
+        if(!measured.isEmpty() && processes > 0){
+            QTextStream(stderr) << "automata-cli: counters only cover this process, not the workers\n";
+        } else if(!measured.isEmpty() && engine.threadCount() > 1 && (qint64)engine.height() * engine.width() >= 128 * 128){
+            QTextStream(stderr) << "automata-cli: counters only cover the calling thread's band, use -j 1 for whole steps\n";
+        }
+    }
+
+    //Run:
+    QTextStream out(stdout);
+    QJsonArray history;
+    if(stats == "every" && format == "csv"){
+        out << "generation,population,changed";
+        foreach(PerfCounters::Counter c, measured){ out << "," << PerfCounters::name(c); }
+        out << "\n";
+    }
+    QElapsedTimer clock;
+    clock.start();
+    int g = 0;
+    bool still = false;
+    qint64 population = engine.population();
+    qint64 changedCells = 0;
+    while(g < generations){
+        if(!measured.isEmpty()){ counters.start(); }
+        bool changed;
+        if(processes > 0){
+            if(!domains.step(population, changedCells)){
+                return fail(domains.error());
+            }
+            changed = changedCells > 0;
+        } else {
+            changed = engine.step();
+            population = engine.population();
+            changedCells = engine.changed();
+        }
+        if(!measured.isEmpty()){ counters.stop(); }
+        if(changed && publisher.isRunning() && !publisher.publish(g + 1, engine.board())){
+            QTextStream(stderr) << "automata-cli: " << publisher.error() << "\n";
+        }
+        if(!changed){
+            still = true; //Every next generation would be the same.
+            break;
+        }
+        g++;
+        if(stats == "every"){
+            if(format == "csv"){
+                out << g << "," << population << "," << changedCells;
+                foreach(PerfCounters::Counter c, measured){ out << "," << counters.last(c); }
+                out << "\n";
+            } else {
+                QJsonObject row;
+                row["generation"] = g;
+                row["population"] = population;
+                row["changed"] = changedCells;
+                foreach(PerfCounters::Counter c, measured){ row[PerfCounters::name(c)] = (double)counters.last(c); }
+                history.append(row);
+            }
+        }
+    }
+    qint64 elapsed = clock.elapsed();
+
+    //Report:
+    if(stats != "none"){
+        double seconds = qMax<qint64>(elapsed, 1) / 1000.0;
+        QJsonObject summary;
+        summary["rule"] = engine.rule();
+        summary["neighbourhood"] = engine.neighMode() == 'm' ? QString("moore") : QString("vonneumann");
+        summary["edge"] = engine.edgeMode() == 't' ? QString("torus") : QString("plane");
+        summary["height"] = engine.height();
+        summary["width"] = engine.width();
+        summary["threads"] = engine.threadCount();
+        summary["processes"] = domains.processes();
+        summary["symmetry"] = Soup::symmetryName(processes > 0 ? Soup::C1 : engine.activeSymmetry());
+        summary["generations"] = g;
+        summary["population"] = population;
+        summary["still"] = still;
+        summary["elapsed_ms"] = (double)elapsed;
+        summary["generations_per_second"] = g / seconds;
+        summary["cell_updates_per_second"] = (double)g * engine.height() * engine.width() / seconds;
+        summary["memory_bytes"] = (double)MemoryUsage::current(); //Cells of this process, scratch buffers included.
+        summary["peak_memory_bytes"] = (double)MemoryUsage::peak();
+        foreach(PerfCounters::Counter c, measured){
+            double total = counters.total(c);
+            summary[PerfCounters::name(c)] = total;
+            summary[PerfCounters::name(c) + "_per_generation"] = total / qMax(1, g);
+            summary[PerfCounters::name(c) + "_per_cell"] = total / qMax(1.0, (double)g * engine.height() * engine.width());
+        }
+        if(measured.contains(PerfCounters::Cycles) && measured.contains(PerfCounters::Instructions)){
+            summary["ipc"] = (double)counters.total(PerfCounters::Instructions) / qMax<quint64>(1, counters.total(PerfCounters::Cycles));
+        }
+        if(format == "json"){
+            QJsonObject doc;
+            doc["summary"] = summary;
+            if(stats == "every"){
+                doc["history"] = history;
+            }
+            out << QJsonDocument(doc).toJson();
+        } else if(stats == "summary"){
+            QStringList keys = QStringList() << "rule" << "neighbourhood" << "edge" << "height" << "width" << "threads" << "processes" << "symmetry"
+                                             << "generations" << "population" << "still" << "elapsed_ms"
+                                             << "generations_per_second" << "cell_updates_per_second"
+                                             << "memory_bytes" << "peak_memory_bytes";
+            QStringList values;
+            foreach(PerfCounters::Counter c, measured){
+                keys << PerfCounters::name(c) << PerfCounters::name(c) + "_per_generation" << PerfCounters::name(c) + "_per_cell";
+            }
+            if(summary.contains("ipc")){
+                keys << "ipc";
+            }
+            foreach(QString key, keys){
+                QString v = summary.value(key).toVariant().toString();
+                values << (v.contains(',') ? "\"" + v + "\"" : v); //LtL rules hold commas.
+            }
+            out << keys.join(",") << "\n" << values.join(",") << "\n";
+        }
+    }
+    out.flush();
+
+    if(parser.isSet(outOpt)){
+        Pattern result = pattern;
+        PatternIO::setRule(result, engine.rule());
+        result.neighMode = engine.neighMode();
+        result.edgeMode = engine.edgeMode();
+        result.board = processes > 0 ? domains.gather() : engine.board();
+        result.cells = engine.states() > 2 ? engine.cellStates() : QByteArray();
+        if(!PatternIO::write(parser.value(outOpt), result)){
+            return fail("cannot write " + parser.value(outOpt));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,37 @@
+# GUI-free simulation core, shared by automata.pro, cli/automata-cli.pro and bench/bench.pro.
+
+QT       += core concurrent
+
+INCLUDEPATH += $$PWD
+
+SOURCES += $$PWD/lifeengine.cpp \
+    $$PWD/bitgrid.cpp \
+    $$PWD/patternio.cpp \
+    $$PWD/perfcounters.cpp \
+    $$PWD/rulesurvey.cpp \
+    $$PWD/ensembleengine.cpp \
+    $$PWD/henselrule.cpp \
+    $$PWD/generationsengine.cpp \
+    $$PWD/objectcensus.cpp \
+    $$PWD/patternsearch.cpp \
+    $$PWD/tileduniverse.cpp \
+    $$PWD/framering.cpp \
+    $$PWD/soup.cpp \
+    $$PWD/memoryusage.cpp \
+    $$PWD/cellbuffer.cpp
+
+HEADERS  += $$PWD/lifeengine.h \
+    $$PWD/bitgrid.h \
+    $$PWD/patternio.h \
+    $$PWD/perfcounters.h \
+    $$PWD/rulesurvey.h \
+    $$PWD/ensembleengine.h \
+    $$PWD/henselrule.h \
+    $$PWD/generationsengine.h \
+    $$PWD/objectcensus.h \
+    $$PWD/patternsearch.h \
+    $$PWD/tileduniverse.h \
+    $$PWD/framering.h \
+    $$PWD/soup.h \
+    $$PWD/memoryusage.h \
+    $$PWD/cellbuffer.h
@@ -0,0 +1,286 @@
+#include "ensembleengine.h"
+
+//Adds one neighbour word to the bit-sliced 4 bit counters s0..s3 (one counter per lane).
+static inline void addNeighbour(quint64 x, quint64 &s0, quint64 &s1, quint64 &s2, quint64 &s3)
+{
+    quint64 c0 = s0 & x;
+    s0 ^= x;
+    quint64 c1 = s1 & c0;
+    s1 ^= c0;
+    quint64 c2 = s2 & c1;
+    s2 ^= c1;
+    s3 |= c2;
+}
+
+
+//Constructor:
+EnsembleEngine::EnsembleEngine(int height, int width) :
+    h(0),
+    w(0),
+    neigh('m'),
+    edge('p'),
+    cells(MemoryUsage::Board),
+    next(MemoryUsage::Scratch),
+    older(MemoryUsage::Scratch),
+    zeros(MemoryUsage::Scratch)
+{
+    for(int n = 0; n <= 8; n++){
+        birth[n] = 0;
+        survival[n] = 0;
+    }
+    QList<int> b, s;
+    b << 3;
+    s << 2 << 3;
+    setRule(b, s);
+    resize(height, width);
+}
+
+
+//Size:
+int EnsembleEngine::height() const
+{
+    return h;
+}
+
+int EnsembleEngine::width() const
+{
+    return w;
+}
+
+void EnsembleEngine::resize(int height, int width)
+{
+    h = height;
+    w = width;
+    cells.fill(0, h * w);
+    next.fill(0, h * w);
+    older.fill(0, h * w);
+    zeros.fill(0, w);
+    restart();
+}
+
+
+//Rules:
+char EnsembleEngine::neighMode() const
+{
+    return neigh;
+}
+
+void EnsembleEngine::setNeighMode(char mode)
+{
+    neigh = mode;
+}
+
+char EnsembleEngine::edgeMode() const
+{
+    return edge;
+}
+
+void EnsembleEngine::setEdgeMode(char mode)
+{
+    edge = mode;
+}
+
+void EnsembleEngine::setRule(const QList<int> &b, const QList<int> &s)
+{
+    for(int lane = 0; lane < Lanes; lane++){
+        setLaneRule(lane, b, s);
+    }
+}
+
+void EnsembleEngine::setLaneRule(int lane, const QList<int> &b, const QList<int> &s)
+{
+    quint64 bit = Q_UINT64_C(1) << lane;
+    for(int n = 0; n <= 8; n++){
+        birth[n] = b.contains(n) ? birth[n] | bit : birth[n] & ~bit;
+        survival[n] = s.contains(n) ? survival[n] | bit : survival[n] & ~bit;
+    }
+}
+
+
+//Cells:
+bool EnsembleEngine::cell(int lane, int k, int j) const
+{
+    return (cells[k * w + j] >> lane) & 1;
+}
+
+void EnsembleEngine::setCell(int lane, int k, int j, bool alive)
+{
+    quint64 bit = Q_UINT64_C(1) << lane;
+    if(alive){
+        cells[k * w + j] |= bit;
+    } else {
+        cells[k * w + j] &= ~bit;
+    }
+}
+
+BitGrid EnsembleEngine::lane(int lane) const
+{
+    BitGrid board(h, w);
+    for(int k = 0; k < h; k++){
+        for(int j = 0; j < w; j++){
+            if(cell(lane, k, j)){ board.setCell(k, j, true); }
+        }
+    }
+    return board;
+}
+
+void EnsembleEngine::setLane(int lane, const BitGrid &board)
+{
+    if(board.height() != h || board.width() != w){
+        return;
+    }
+    for(int k = 0; k < h; k++){
+        for(int j = 0; j < w; j++){
+            setCell(lane, k, j, board.cell(k, j));
+        }
+    }
+}
+
+void EnsembleEngine::clear()
+{
+    cells.fill(0);
+    restart();
+}
+
+void EnsembleEngine::restart()
+{
+    live = ~Q_UINT64_C(0);
+    gen = 0;
+    for(int lane = 0; lane < Lanes; lane++){
+        laneStatus[lane] = Running;
+        laneStop[lane] = 0;
+    }
+}
+
+
+//Stepping:
+bool EnsembleEngine::step()
+{
+    if(!live || h == 0 || w == 0){
+        return false;
+    }
+    //Counts that some lane reacts to, the others can't produce a live cell.
+    int counts[9];
+    int nCounts = 0;
+    for(int n = 0; n <= (neigh == 'v' ? 4 : 8); n++){
+        if(birth[n] | survival[n]){ counts[nCounts++] = n; }
+    }
+    bool torus = edge == 't';
+    const quint64 *cur = cells.constData();
+    const quint64 *old = older.constData();
+    quint64 *out = next.data();
+    quint64 changed = 0; // lanes with a cell that changed
+    quint64 back = 0; // lanes with a cell that differs from the previous generation
+    quint64 alive = 0; // lanes with a live cell
+    for(int k = 0; k < h; k++){
+        const quint64 *mid = cur + k * w;
+        const quint64 *above = k > 0 ? mid - w : (torus ? cur + (h - 1) * w : zeros.constData());
+        const quint64 *below = k < h - 1 ? mid + w : (torus ? cur : zeros.constData());
+        for(int j = 0; j < w; j++){
+            int l = j > 0 ? j - 1 : (torus ? w - 1 : -1);
+            int r = j < w - 1 ? j + 1 : (torus ? 0 : -1);
+            quint64 s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+            addNeighbour(above[j], s0, s1, s2, s3);
+            addNeighbour(below[j], s0, s1, s2, s3);
+            if(l >= 0){ addNeighbour(mid[l], s0, s1, s2, s3); }
+            if(r >= 0){ addNeighbour(mid[r], s0, s1, s2, s3); }
+            if(neigh == 'm'){
+                if(l >= 0){
+                    addNeighbour(above[l], s0, s1, s2, s3);
+                    addNeighbour(below[l], s0, s1, s2, s3);
+                }
+                if(r >= 0){
+                    addNeighbour(above[r], s0, s1, s2, s3);
+                    addNeighbour(below[r], s0, s1, s2, s3);
+                }
+            }
+            quint64 self = mid[j];
+            quint64 result = 0;
+            for(int i = 0; i < nCounts; i++){
+                int n = counts[i];
+                quint64 eq = (n & 1 ? s0 : ~s0) & (n & 2 ? s1 : ~s1) & (n & 4 ? s2 : ~s2) & (n & 8 ? s3 : ~s3);
+                result |= eq & ((self & survival[n]) | (~self & birth[n]));
+            }
+            out[k * w + j] = result;
+            changed |= result ^ self;
+            back |= result ^ old[k * w + j];
+            alive |= result;
+        }
+    }
+    gen++;
+    //Stopped lanes keep their status, only running ones are looked at.
+    for(int lane = 0; lane < Lanes; lane++){
+        quint64 bit = Q_UINT64_C(1) << lane;
+        if(!(live & bit)){
+            continue;
+        }
+        if(!(changed & bit)){
+            laneStatus[lane] = (alive & bit) ? Stable : Died;
+            laneStop[lane] = gen - 1;
+        } else if(!(alive & bit)){
+            laneStatus[lane] = Died;
+            laneStop[lane] = gen;
+        } else if(gen >= 2 && !(back & bit)){
+            laneStatus[lane] = Period2;
+            laneStop[lane] = gen;
+        } else {
+            continue;
+        }
+        live &= ~bit;
+    }
+    //next holds the new generation, the current one becomes the previous one.
+    qSwap(older, cells);
+    qSwap(cells, next);
+    return true;
+}
+
+int EnsembleEngine::generation() const
+{
+    return gen;
+}
+
+quint64 EnsembleEngine::running() const
+{
+    return live;
+}
+
+EnsembleEngine::Status EnsembleEngine::status(int lane) const
+{
+    return laneStatus[lane];
+}
+
+int EnsembleEngine::stopGeneration(int lane) const
+{
+    return laneStop[lane];
+}
+
+QVector<int> EnsembleEngine::populations() const
+{
+    //Bit-sliced lane counters (carry-save planes), read back lane by lane.
+    quint64 planes[32];
+    for(int b = 0; b < 32; b++){ planes[b] = 0; }
+    for(int i = 0; i < cells.size(); i++){
+        quint64 x = cells[i];
+        for(int b = 0; x && b < 32; b++){
+            quint64 carry = planes[b] & x;
+            planes[b] ^= x;
+            x = carry;
+        }
+    }
+    QVector<int> counts(Lanes, 0);
+    for(int lane = 0; lane < Lanes; lane++){
+        for(int b = 0; b < 31; b++){
+            counts[lane] |= (int)((planes[b] >> lane) & 1) << b;
+        }
+    }
+    return counts;
+}
+
+int EnsembleEngine::population(int lane) const
+{
+    int n = 0;
+    for(int i = 0; i < cells.size(); i++){
+        n += (cells[i] >> lane) & 1;
+    }
+    return n;
+}
@@ -0,0 +1,71 @@
+#ifndef ENSEMBLEENGINE_H
+#define ENSEMBLEENGINE_H
+
+#include <QList>
+#include <QVector>
+#include "bitgrid.h"
+#include "cellbuffer.h"
+
+/**
+  *
+  * 64 independent universes of the same size stepped together: each cell is one word whose
+  * bit L belongs to universe (lane) L, so the neighbour counts are bit-sliced adders and one
+  * pass over the words advances every lane. Each lane may have its own rule.
+  * Lanes stop (and keep their status) when they die, stop changing or flip with period 2;
+  * step() returns false once every lane has stopped.
+  * Cells are addressed from (0,0), as in BitGrid.
+ */
+
+class EnsembleEngine
+{
+public:
+    enum { Lanes = 64 };
+    enum Status { Running, Died, Stable, Period2 };
+
+    explicit EnsembleEngine(int height = 32, int width = 32);
+
+    int height() const;
+    int width() const;
+    void resize(int height, int width); // empties every lane
+
+    char neighMode() const; // 'm': moore, 'v': von neumann
+    void setNeighMode(char mode);
+    char edgeMode() const; // 't': toroidal, 'p': bounded plane
+    void setEdgeMode(char mode);
+    void setRule(const QList<int> &birth, const QList<int> &survival); // every lane
+    void setLaneRule(int lane, const QList<int> &birth, const QList<int> &survival);
+
+    bool cell(int lane, int k, int j) const;
+    void setCell(int lane, int k, int j, bool alive);
+    BitGrid lane(int lane) const;
+    void setLane(int lane, const BitGrid &board); // same size only
+    void clear(); // also restarts every lane
+
+    bool step(); // one generation of every lane, false (and nothing done) once all lanes stopped
+    int generation() const;
+    quint64 running() const; // bit L set while lane L runs
+    Status status(int lane) const;
+    int stopGeneration(int lane) const; // last generation that changed a stopped lane
+    QVector<int> populations() const; // per lane
+    int population(int lane) const;
+
+private:
+    int h;
+    int w;
+    char neigh;
+    char edge;
+    CellBuffer<quint64> cells; // current generation, h*w words
+    CellBuffer<quint64> next; // scratch
+    CellBuffer<quint64> older; // previous generation, for period 2
+    CellBuffer<quint64> zeros; // row beyond the edge of a bounded plane
+    quint64 birth[9]; // bit L set: lane L is born on n neighbours
+    quint64 survival[9]; // bit L set: lane L survives on n neighbours
+    quint64 live; // lanes still running
+    int gen;
+    Status laneStatus[Lanes];
+    int laneStop[Lanes];
+
+    void restart();
+};
+
+#endif // ENSEMBLEENGINE_H
@@ -0,0 +1,334 @@
+#include <atomic>
+#include <cstring>
+#include <climits>
+#include "framering.h"
+
+//Shared layout, the same for every process on the machine.
+struct RingHeader {
+    char magic[4]; // "LFRM"
+    qint32 version;
+    qint32 slotCount;
+    qint32 height;
+    qint32 width;
+    qint32 wordsPerRow;
+    qint32 slotBytes; // slot header and cells, a multiple of 64
+    QAtomicInteger<qint32> closed;
+    QAtomicInteger<quint64> frames; // published so far
+};
+
+struct SlotHeader {
+    QAtomicInteger<quint64> sequence; // odd: being written, 2 * (frame + 1): frame is in the slot
+    qint64 generation;
+    qint64 population;
+    quint64 hash;
+};
+
+struct ControlHeader {
+    char magic[4]; // "LFRC"
+    qint32 version;
+    QAtomicInteger<quint32> ring; // number of the current ring, 0 before the first
+};
+
+enum { ControlBytes = 64, HeaderBytes = 64, SlotHeaderBytes = 64, Version = 2 };
+
+static QString ringKey(const QString &key, quint32 number)
+{
+    return key + "." + QString::number(number);
+}
+
+static int slotBytes(int height, int wordsPerRow)
+{
+    return (SlotHeaderBytes + height * wordsPerRow * 8 + 63) / 64 * 64;
+}
+
+static SlotHeader *slotAt(void *mem, int slot)
+{
+    RingHeader *h = (RingHeader *)mem;
+    return (SlotHeader *)((char *)mem + HeaderBytes + (qint64)slot * h->slotBytes);
+}
+
+static quint64 *cellsOf(SlotHeader *s)
+{
+    return (quint64 *)((char *)s + SlotHeaderBytes);
+}
+
+
+//Publisher:
+FramePublisher::FramePublisher() :
+    ringSlots(DefaultSlots)
+{
+}
+
+FramePublisher::~FramePublisher()
+{
+    stop();
+}
+
+bool FramePublisher::start(const QString &key, int height, int width, int slotCount)
+{
+    stop();
+    ringSlots = qMax(2, slotCount);
+    control.setKey(key);
+    if(control.create(ControlBytes)){
+        memset(control.data(), 0, control.size());
+    } else if(control.error() != QSharedMemory::AlreadyExists || !control.attach()){
+        message = "Cannot share frames as " + key + ": " + control.errorString();
+        return false;
+    }
+    //An existing one, left by a publisher that crashed or still mapped by a reader, is reused: numbering goes on.
+    if(control.size() < ControlBytes){
+        message = key + " is already used by another shared memory segment.";
+        control.detach();
+        return false;
+    }
+    ControlHeader *c = (ControlHeader *)control.data();
+    memcpy(c->magic, "LFRC", 4);
+    c->version = Version;
+    if(!open(height, width)){
+        control.detach();
+        return false;
+    }
+    return true;
+}
+
+bool FramePublisher::open(int height, int width)
+{
+    ControlHeader *c = (ControlHeader *)control.data();
+    int wpr = (width + 63) / 64;
+    int bytes = slotBytes(height, wpr);
+    qint64 size = HeaderBytes + (qint64)ringSlots * bytes;
+    if(size > INT_MAX){
+        message = "Cannot share frames as " + control.key() + ": the board is too large.";
+        return false;
+    }
+    quint32 number = c->ring.loadAcquire();
+    for(int attempt = 0; attempt < 16 && !memory.isAttached(); attempt++){
+        //A ring of that number still mapped by a reader of an older publisher is skipped.
+        memory.setKey(ringKey(control.key(), ++number));
+        if(!memory.create((int)size) && memory.error() != QSharedMemory::AlreadyExists){
+            break;
+        }
+    }
+    if(!memory.isAttached()){
+        message = "Cannot share frames as " + control.key() + ": " + memory.errorString();
+        return false;
+    }
+    memset(memory.data(), 0, memory.size());
+    RingHeader *h = (RingHeader *)memory.data();
+    memcpy(h->magic, "LFRM", 4);
+    h->version = Version;
+    h->slotCount = ringSlots;
+    h->height = height;
+    h->width = width;
+    h->wordsPerRow = wpr;
+    h->slotBytes = bytes;
+    c->ring.storeRelease(number); //Readers attaching from now on find this ring.
+    message.clear();
+    return true;
+}
+
+void FramePublisher::close()
+{
+    if(!memory.isAttached()){
+        return;
+    }
+    ((RingHeader *)memory.data())->closed.storeRelease(1);
+    memory.detach();
+}
+
+void FramePublisher::stop()
+{
+    close();
+    if(control.isAttached()){
+        control.detach();
+    }
+}
+
+bool FramePublisher::isRunning() const
+{
+    return memory.isAttached();
+}
+
+QString FramePublisher::key() const
+{
+    return control.key();
+}
+
+QString FramePublisher::error() const
+{
+    return message;
+}
+
+bool FramePublisher::publish(qint64 generation, const BitGrid &board)
+{
+    if(!memory.isAttached()){
+        return false;
+    }
+    RingHeader *h = (RingHeader *)memory.data();
+    if(h->height != board.height() || h->width != board.width()){
+        close();
+        if(!open(board.height(), board.width())){
+            message = "Frame sharing stopped: " + message;
+            stop();
+            return false;
+        }
+        h = (RingHeader *)memory.data();
+    }
+    quint64 n = h->frames.loadAcquire();
+    SlotHeader *s = slotAt(h, n % h->slotCount);
+    //Odd sequence first (a full barrier), so no reader takes the cells below for the old frame.
+    s->sequence.fetchAndStoreOrdered(2 * n + 1);
+    s->generation = generation;
+    s->population = board.population();
+    s->hash = board.hash();
+    memcpy(cellsOf(s), board.words().constData(), board.words().size() * sizeof(quint64));
+    s->sequence.storeRelease(2 * (n + 1));
+    h->frames.storeRelease(n + 1);
+    return true;
+}
+
+
+//Reader:
+FrameReader::FrameReader()
+{
+}
+
+FrameReader::~FrameReader()
+{
+    detach();
+}
+
+bool FrameReader::attach(const QString &key)
+{
+    detach();
+    //Only long enough to learn the current ring.
+    QSharedMemory control(key);
+    if(!control.attach(QSharedMemory::ReadOnly)){
+        message = "No frames shared as " + key + ": " + control.errorString();
+        return false;
+    }
+    const ControlHeader *c = (const ControlHeader *)control.constData();
+    if(control.size() < ControlBytes || memcmp(c->magic, "LFRC", 4) != 0 || c->version != Version){
+        message = key + " is not a frame ring.";
+        return false;
+    }
+    memory.setKey(ringKey(key, c->ring.loadAcquire()));
+    control.detach();
+    if(!memory.attach(QSharedMemory::ReadOnly)){
+        message = "No frames shared as " + key + ": " + memory.errorString();
+        return false;
+    }
+    const RingHeader *h = (const RingHeader *)memory.constData();
+    if(memory.size() < HeaderBytes || memcmp(h->magic, "LFRM", 4) != 0 || h->version != Version){
+        message = key + " is not a frame ring.";
+        memory.detach();
+        return false;
+    }
+    message.clear();
+    return true;
+}
+
+void FrameReader::detach()
+{
+    if(memory.isAttached()){
+        memory.detach();
+    }
+}
+
+bool FrameReader::isAttached() const
+{
+    return memory.isAttached();
+}
+
+bool FrameReader::isClosed() const
+{
+    return !memory.isAttached() || ((const RingHeader *)memory.constData())->closed.loadAcquire() != 0;
+}
+
+QString FrameReader::error() const
+{
+    return message;
+}
+
+int FrameReader::height() const
+{
+    return memory.isAttached() ? ((const RingHeader *)memory.constData())->height : 0;
+}
+
+int FrameReader::width() const
+{
+    return memory.isAttached() ? ((const RingHeader *)memory.constData())->width : 0;
+}
+
+int FrameReader::wordsPerRow() const
+{
+    return memory.isAttached() ? ((const RingHeader *)memory.constData())->wordsPerRow : 0;
+}
+
+quint64 FrameReader::frames() const
+{
+    return memory.isAttached() ? ((const RingHeader *)memory.constData())->frames.loadAcquire() : 0;
+}
+
+const quint64 *FrameReader::cells(quint64 number) const
+{
+    if(!memory.isAttached()){
+        return 0;
+    }
+    const RingHeader *h = (const RingHeader *)memory.constData();
+    SlotHeader *s = slotAt((void *)h, number % h->slotCount);
+    if(s->sequence.loadAcquire() != 2 * (number + 1)){
+        return 0; //Being written, overwritten, or not there yet.
+    }
+    return cellsOf(s);
+}
+
+bool FrameReader::isValid(quint64 number) const
+{
+    if(!memory.isAttached()){
+        return false;
+    }
+    const RingHeader *h = (const RingHeader *)memory.constData();
+    SlotHeader *s = slotAt((void *)h, number % h->slotCount);
+    std::atomic_thread_fence(std::memory_order_acquire); //Whatever was read of the slot comes before this check.
+    return s->sequence.load() == 2 * (number + 1);
+}
+
+bool FrameReader::read(quint64 number, Frame &frame) const
+{
+    const quint64 *words = cells(number);
+    if(!words){
+        return false;
+    }
+    const RingHeader *h = (const RingHeader *)memory.constData();
+    SlotHeader *s = slotAt((void *)h, number % h->slotCount);
+    BitGrid board(h->height, h->width);
+    memcpy(board.words().data(), words, board.words().size() * sizeof(quint64));
+    qint64 generation = s->generation;
+    qint64 population = s->population;
+    quint64 hash = s->hash;
+    if(!isValid(number)){
+        return false;
+    }
+    frame.number = number;
+    frame.generation = generation;
+    frame.population = population;
+    frame.hash = hash;
+    frame.board = board;
+    return true;
+}
+
+bool FrameReader::latest(Frame &frame) const
+{
+    //The newest frame can be overwritten while it is copied only if the reader falls a whole ring behind.
+    for(int attempt = 0; attempt < 100; attempt++){
+        quint64 n = frames();
+        if(n == 0){
+            return false;
+        }
+        if(read(n - 1, frame)){
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,91 @@
+#ifndef FRAMERING_H
+#define FRAMERING_H
+
+#include <QSharedMemory>
+#include <QAtomicInteger>
+#include <QString>
+#include "bitgrid.h"
+
+/**
+  *
+  * Ring of finished generations in shared memory, for viewers and analysis tools running
+  * next to the game. One publisher writes each generation into the next slot of the ring
+  * (bit-packed cells as in BitGrid, generation, population, hash); any number of local
+  * readers map the same segment read-only. Nobody locks: each slot has a sequence number
+  * (seqlock) that is odd while the slot is written and 2 * (frame + 1) once frame is in it,
+  * so a reader checks it before and after looking at the cells and retries, or skips to a
+  * newer frame, if the publisher went past it. Readers never slow the publisher down.
+  *   control "LFRC", version, number of the current ring (segment "<key>.<number>")
+  *   header  "LFRM", version, slot count, height, width, words per row, closed, frames published
+  *   slot    sequence, generation, population, hash, height * words per row cells
+  * The key itself names the small control segment. When the board is resized the ring is closed
+  * and a new one is made under the next number: a reader still mapping the old ring can't keep
+  * it from being made, it sees the old one closed and attaches to the key again.
+ */
+
+struct Frame
+{
+    Frame() : number(0), generation(0), population(0), hash(0) {}
+    quint64 number; // frames published before this one
+    qint64 generation;
+    qint64 population;
+    quint64 hash; // BitGrid::hash() of the cells
+    BitGrid board;
+};
+
+class FramePublisher
+{
+public:
+    enum { DefaultSlots = 8 };
+
+    FramePublisher();
+    ~FramePublisher();
+
+    bool start(const QString &key, int height, int width, int slotCount = DefaultSlots); // makes the segment
+    void stop(); // readers see it closed
+    bool isRunning() const;
+    QString key() const;
+    QString error() const;
+
+    bool publish(qint64 generation, const BitGrid &board); // new ring if the size changed, false (and stopped) if it can't be made
+
+private:
+    QSharedMemory control; // number of the current ring
+    QSharedMemory memory; // current ring
+    int ringSlots;
+    QString message;
+
+    bool open(int height, int width); // next ring, made current
+    void close(); // current ring closed for its readers
+};
+
+class FrameReader
+{
+public:
+    FrameReader();
+    ~FrameReader();
+
+    bool attach(const QString &key);
+    void detach();
+    bool isAttached() const;
+    bool isClosed() const; // the publisher stopped or remade the segment: detach and attach again
+    QString error() const;
+
+    int height() const;
+    int width() const;
+    int wordsPerRow() const;
+    quint64 frames() const; // published so far, the newest is frames() - 1
+
+    bool read(quint64 number, Frame &frame) const; // copy of a frame, false if it was overwritten
+    bool latest(Frame &frame) const; // copy of the newest frame, false if none
+
+    //Zero-copy access: cells of a frame in place, to be checked with isValid() once used.
+    const quint64 *cells(quint64 number) const; // 0 if the frame isn't in the ring
+    bool isValid(quint64 number) const; // still the same frame, nothing was torn
+
+private:
+    QSharedMemory memory;
+    QString message;
+};
+
+#endif // FRAMERING_H
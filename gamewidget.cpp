@@ -4,19 +4,33 @@
 #include <QDebug>
 #include <QRectF>
 #include <QPainter>
+#include <QFontMetrics>
 #include <qmath.h>
+#include <QDir>
+#include <QtConcurrentRun>
+#include <climits>
 #include "gamewidget.h"
+#include "boardpainter.h"
+#include "henselrule.h"
 
+BitGrid GameWidget::clipboard;
 
 //Constructor:
 GameWidget::GameWidget(QWidget *parent) :
     QWidget(parent),
     timer(new QTimer(this)),
     generations(0),
-    universeHeight(50),
-    universeWidth(50),
-    neighMode('m'),
-    edgeMode('p'),
+    engine(50, 50),
+    stepping(new QFutureWatcher<bool>(this)),
+    pending(false),
+    stepStart(-1),
+    tiled(0),
+    checkpointer(new Checkpointer(".." + QString(QDir::separator()) + "checkpoints", this)),
+    recorder(new RunRecorder(this)),
+    lookAhead(new LookAhead(this)),
+    idle(new QTimer(this)),
+    merge(BitGrid::Replace),
+    drag(NoDrag),
     population(0)
 {
 
@@ -24,17 +38,18 @@ GameWidget::GameWidget(QWidget *parent) :
     m_masterColor = "#000";
     resetUniverse();
     connect(timer, SIGNAL(timeout()), this, SLOT(newGeneration()));
+    connect(stepping, SIGNAL(finished()), this, SLOT(finishGeneration()));
+    idle->setSingleShot(true);
+    idle->setInterval(250);
+    connect(idle, SIGNAL(timeout()), this, SLOT(speculate()));
     setMouseTracking(true);
-    BirthStates <<  3;
-    SurvStates << 2;
-    SurvStates << 3;
 }
 
 //Destructor:
 GameWidget::~GameWidget()
 {
-    delete [] universe;
-    delete [] next;
+    stepping->waitForFinished(); //The engine goes with this widget.
+    delete tiled;
 }
 
 
@@ -50,22 +65,26 @@ void GameWidget::stopGame()
     if(timer->isActive()){
         timer->stop();
         emit info("Game paused.");
+        idle->start();
     }
 }
 
 void GameWidget::clear()
 {
+    edit();
     generations = 0;
     emit sendGen(generations);
     if(timer->isActive()){
         stopGame();
         emit gameStops(true);
     }
-    for(int k = 1; k <= universeHeight; k++) {
-        for(int j = 1; j <= universeWidth; j++) {
-            universe[k][j] = false;
-        }
+    engine.clear();
+    if(tiled){
+        tiled->clear();
     }
+    history.clear();
+    marks.clear();
+    soupRecord.clear();
     update();
     emit info("Board cleared");
     population = 0;
@@ -74,19 +93,20 @@ void GameWidget::clear()
 
 int GameWidget::getUniverseHeight()
 {
-    return universeHeight;
+    return tiled ? tiled->height() : engine.height();
 }
 
 
 int GameWidget::getUniverseWidth()
 {
-    return universeWidth;
+    return tiled ? tiled->width() : engine.width();
 }
 
 
 void GameWidget::setUniverseHeight(const int &s)
 {
-    universeHeight = s;
+    edit();
+    engine.resize(s, engine.width());
     resetUniverse();
     update();
 }
@@ -94,7 +114,8 @@ void GameWidget::setUniverseHeight(const int &s)
 
 void GameWidget::setUniverseWidth(const int &s)
 {
-    universeWidth = s;
+    edit();
+    engine.resize(engine.height(), s);
     resetUniverse();
     update();
 }
@@ -102,33 +123,67 @@ void GameWidget::setUniverseWidth(const int &s)
 
 void GameWidget::setNeighMode(char mode)
 {
-    neighMode = mode;
+    edit();
+    engine.setNeighMode(mode);
 }
 
 void GameWidget::setEdgeMode(char mode)
 {
-    edgeMode = mode;
+    edit();
+    engine.setEdgeMode(mode);
+}
+
+void GameWidget::setRadius(int r)
+{
+    edit();
+    engine.setRadius(r);
+}
+
+void GameWidget::setMiddleCounted(bool counted)
+{
+    edit();
+    engine.setMiddleCounted(counted);
+}
+
+Soup::Symmetry GameWidget::symmetry()
+{
+    return engine.symmetry();
+}
+
+void GameWidget::setSymmetry(Soup::Symmetry group)
+{
+    edit();
+    engine.setSymmetry(group);
+}
+
+Soup::Symmetry GameWidget::activeSymmetry()
+{
+    settle();
+    return engine.activeSymmetry();
+}
+
+void GameWidget::setStates(int n)
+{
+    edit();
+    engine.setStates(n);
+    update();
+}
+
+void GameWidget::setCellStates(const QByteArray &cells)
+{
+    edit();
+    engine.setCellStates(cells);
+    update();
 }
 
 void GameWidget::resetUniverse()
 {
-    //Empty universe building algorithm.
-    delete [] universe;
-    delete [] next;
-    // +2 to array dimension to give a buffer zone.
-    universe = new bool*[universeHeight + 2];
-    for(int k = 0; k < universeHeight + 2; k++){
-       universe[k] = new bool[universeWidth + 2];
-       for(int j = 0; j < universeWidth + 2; j++){
-           universe[k][j] = false;
-       }
-    }
-    next = new bool*[universeHeight + 2];
-    for(int k = 0; k < universeHeight + 2; k++){
-       next[k] = new bool[universeWidth + 2];
-       for(int j = 0; j < universeWidth + 2; j++){
-           next[k][j] = false;
-       }
+    //The engine has been resized: whatever was recorded for the previous size is dropped.
+    history.clear();
+    selected = QRect();
+    soupRecord.clear();
+    if(recorder->isRunning()){
+        stopRecording(); //A stream has one size.
     }
     population = 0;
     emit sendPop(population);
@@ -136,44 +191,208 @@ void GameWidget::resetUniverse()
 
 void GameWidget::invert()
 {
-    for(int k = 1; k <= universeHeight; k++){
-     for(int j = 1; j <= universeWidth; j++){
-         universe[k][j] = !universe[k][j];
-     }
+    edit();
+    engine.invert();
+    update();
+}
+
+
+
+QString GameWidget::rule()
+{
+    settle();
+    return engine.rule();
+}
+
+BitGrid GameWidget::board()
+{
+    settle();
+    return engine.board();
+}
+
+void GameWidget::setMarks(const QList<QRect> &cells)
+{
+    marks = cells;
+    update();
+}
+
+QRect GameWidget::selection()
+{
+    return selected;
+}
+
+void GameWidget::selectAll()
+{
+    selected = QRect(0, 0, getUniverseWidth(), getUniverseHeight());
+    update();
+}
+
+void GameWidget::selectNone()
+{
+    selected = QRect();
+    update();
+}
+
+void GameWidget::copySelection()
+{
+    if(selected.isNull()){
+        emit info("Nothing selected.");
+        return;
+    }
+    clipboard = area(selected);
+    emit info(QString::number(clipboard.population()) + " cells copied.");
+}
+
+void GameWidget::cutSelection()
+{
+    if(selected.isNull() || !editable()){
+        emit info(selected.isNull() ? "Nothing selected." : "Selections only edit two-state boards.");
+        return;
+    }
+    clipboard = area(selected);
+    clearSelection();
+    emit info(QString::number(clipboard.population()) + " cells cut.");
+}
+
+void GameWidget::paste()
+{
+    if(clipboard.isNull() || !editable()){
+        emit info(clipboard.isNull() ? "Nothing to paste." : "Selections only edit two-state boards.");
+        return;
+    }
+    QPoint at = selected.isNull() ? hovered : selected.topLeft();
+    setArea(at.y(), at.x(), clipboard, merge);
+    selected = QRect(at, QSize(clipboard.width(), clipboard.height())) & QRect(0, 0, getUniverseWidth(), getUniverseHeight());
+    update();
+}
+
+void GameWidget::fillSelection()
+{
+    if(selected.isNull() || !editable()){
+        return;
+    }
+    BitGrid cells(selected.height(), selected.width());
+    cells.fill(0, 0, cells.height(), cells.width(), true);
+    setArea(selected.top(), selected.left(), cells);
+    update();
+}
+
+void GameWidget::clearSelection()
+{
+    if(selected.isNull() || !editable()){
+        return;
     }
+    setArea(selected.top(), selected.left(), BitGrid(selected.height(), selected.width()));
     update();
 }
 
+void GameWidget::invertSelection()
+{
+    if(selected.isNull() || !editable()){
+        return;
+    }
+    BitGrid cells = area(selected);
+    cells.invert(0, 0, cells.height(), cells.width());
+    setArea(selected.top(), selected.left(), cells);
+    update();
+}
 
+void GameWidget::rotateSelection(bool clockwise)
+{
+    if(selected.isNull() || !editable()){
+        return;
+    }
+    BitGrid cells = area(selected).rotated(clockwise);
+    QPoint corner = selected.center() - QPoint(cells.width() / 2, cells.height() / 2);
+    QRect to(corner, QSize(cells.width(), cells.height()));
+    replaceArea(selected, to, cells);
+    selected = to & QRect(0, 0, getUniverseWidth(), getUniverseHeight());
+    update();
+}
 
-QString GameWidget::dump()
+void GameWidget::mirrorSelection()
 {
-    char temp;
-    QString master = "";
-    for(int k = 1; k <= universeHeight; k++) {
-        for(int j = 1; j <= universeWidth; j++) {
-            if(universe[k][j] == true) {
-                temp = '*';
-            } else {
-                temp = 'o';
-            }
-            master.append(temp);
-        }
-        master.append("\n");
+    if(selected.isNull() || !editable()){
+        return;
     }
-    return master;
+    setArea(selected.top(), selected.left(), area(selected).mirrored());
+    update();
 }
 
-void GameWidget::setDump(const QString &data)
+void GameWidget::flipSelection()
 {
-    int current = 0;
-    for(int k = 1; k <= universeHeight; k++) {
-        for(int j = 1; j <= universeWidth; j++) {
-            universe[k][j] = (data[current] == '*');
-            current++;
-        }
-        current++;
+    if(selected.isNull() || !editable()){
+        return;
     }
+    setArea(selected.top(), selected.left(), area(selected).flipped());
+    update();
+}
+
+void GameWidget::randomFill(double density, Soup::Symmetry symmetry, quint64 seed)
+{
+    settle();
+    if(!selected.isNull() && !editable()){
+        emit info("Selections only edit two-state boards.");
+        return;
+    }
+    if(selected.isNull() && tiled){
+        emit info("Select the cells to fill on a tiled board.");
+        return;
+    }
+    QRect cells = selected.isNull() ? QRect(0, 0, getUniverseWidth(), getUniverseHeight()) : selected;
+    setArea(cells.top(), cells.left(), Soup::generate(cells.height(), cells.width(), density, seed, symmetry));
+    //Only a whole board can be made again from its seed.
+    soupRecord = selected.isNull() ? Soup::describe(density, symmetry, seed) : QString();
+    if(selected.isNull()){
+        history.clear();
+        population = engine.population();
+        emit sendPop(population);
+    }
+    emit info("Random fill " + Soup::describe(density, symmetry, seed));
+    update();
+}
+
+QString GameWidget::soup()
+{
+    return soupRecord;
+}
+
+void GameWidget::setSoup(const QString &soup)
+{
+    soupRecord = soup;
+}
+
+BitGrid::Merge GameWidget::pasteMode()
+{
+    return merge;
+}
+
+void GameWidget::setPasteMode(BitGrid::Merge mode)
+{
+    merge = mode;
+}
+
+void GameWidget::moveSelection(int dk, int dj)
+{
+    if(selected.isNull() || !editable()){
+        return;
+    }
+    QRect to = selected.translated(dj, dk);
+    replaceArea(selected, to, area(selected));
+    selected = to & QRect(0, 0, getUniverseWidth(), getUniverseHeight());
+    update();
+}
+
+QString GameWidget::dump()
+{
+    settle();
+    return engine.dump();
+}
+
+void GameWidget::setDump(const QString &data)
+{
+    edit();
+    engine.setDump(data);
     update();
 }
 
@@ -189,172 +408,517 @@ void GameWidget::setInterval(int msec)
 
 void GameWidget::setBirthStates(QList<int> states)
 {
-    BirthStates = states;
+    edit();
+    engine.setBirthStates(states);
 }
 
 
 void GameWidget::setSurvStates(QList<int> states)
 {
-    SurvStates = states;
+    edit();
+    engine.setSurvivalStates(states);
+}
+
+bool GameWidget::setBirthConditions(const QString &text)
+{
+    edit();
+    return engine.setBirthConditions(text);
+}
+
+bool GameWidget::setSurvConditions(const QString &text)
+{
+    edit();
+    return engine.setSurvivalConditions(text);
+}
+
+void GameWidget::step()
+{
+    newGeneration();
 }
 
-/*
-bool GameWidget::isAlive(int k, int j)
+void GameWidget::stepBack()
 {
-    int power = 0;
-    if(neighMode == 'm'){
-        //Diagonals only in moore mode.
-        power += universe[k+1][ j-1];
-        power += universe[k-1][j+1];
-        power += universe[k-1][j-1];
-        power += universe[k+1][j+1];
+    if(!history.contains(generations - 1)){
+        emit info("No earlier generation in the history.");
+        return;
     }
-    //Cardinals always:
-    power += universe[k+1][j];
-    power += universe[k-1][j];
-    power += universe[k][j+1];
-    power += universe[k][j-1];
-    if(universe[k][j] == false){
-        foreach( int b, BirthStates){
-            if(power == b){ return true; }
-        }
+    jumpTo(generations - 1);
+}
+
+bool GameWidget::jumpTo(int g)
+{
+    edit();
+    //Restores a generation from the history, newer ones stay available until the next step.
+    BitGrid board = history.at(g);
+    if(board.isNull() || board.height() != engine.height() || board.width() != engine.width()){
+        return false;
     }
-    if(universe[k][j] == true){
-        foreach( int s, SurvStates){
-            if(power == s){ return true; }
-        }
+    QByteArray cells = history.cellsAt(g);
+    if(engine.states() > 2 && cells.size() != board.height() * board.width()){
+        emit info("Generation " + QString::number(g) + " was recorded with two states: its refractory cells are lost.");
+        return false;
     }
-    return false;
-}
-*/
-
-bool GameWidget::isAlive(int k, int j)
-/**
-          0     1       ...     ...       uw      uw+1
-          __|___________________|__
-  0          |                    | k              |
-              |                    |                 |
-  1          |                    |                 |
-   .          |                    |                 |
-   :          |__________|_______> |
-              |  j                 |                 |
-   .          |                    |                 |
-   :          |                    |                 |
- uh     __|__________v________|__
- uh+1     |                                      |
- The universe can have to shapes (edgeMode):
-    -bounded plane(b): the cells at the edge have no neighbour beyond it.
-        A buffer zone of 'dead' cells that are never calculated marks the limit
-    -toroidal plane(t): The edges are connected, top to bottom and left to right.
-        Which means the neighbour of a cell at the edge is the cell facing it at the oposite edge.
-        This could be modelized as the surface of a torus (donut shaped solid).
-*/
-{
-    int power = 0;
-    for(int x = j-1; x <= j+1; x++ ){
-        for(int y = k-1; y <= k+1; y++){
-            int x2 = x;
-            int y2 = y;
-            if(edgeMode == 't'){
-                //Handle edge limits by looping around in toroidal mode.
-                if( x2 == 0){ x2 = universeWidth; } //<-- skip over 0 and uw+1 buffer columns. --
-                else
-                if( x2 == universeWidth + 1){ x2 = 1;} //-- skip over uw+1 and 0 buffer columns -->
-
-                if( y2 == 0){ y2 = universeHeight; } //<-- skip over 0 and uh buffer rows. --
-                else
-                if( y2 == universeHeight + 1){ y2 = 1;} //-- skip over uh+1 and 0 buffer rows -->
-            }
-            if( (x2 == j || y2 == k || neighMode == 'm')
-                 && !(x2 == j && y2 == k)) // don't count u[k][j] itself in its neighbours.
-            {
-                power += universe[y2][x2]; //count live neighbours.
-            }
-        }  }
-    //Rule application
-    if(universe[k][j] == false){
-        //If dead, look if a birth state is satisfied.
-        foreach( int b, BirthStates){
-            // Birth state found => cell becomes alive.
-            if(power == b){ return true; }
-        }
+    if(timer->isActive()){
+        stopGame();
+        emit gameStops(true);
     }
-    if(universe[k][j] == true){
-        //If alive, look if a survival state is satisfied
-        foreach( int s, SurvStates){
-            // Survival state found => cell remains alive.
-            if(power == s){ return true; }
-        }
+    engine.setBoard(board);
+    if(engine.states() > 2){
+        engine.setCellStates(cells);
     }
-    //Nothing found => cell dies / remains dead.
-    return false;
+    generations = g;
+    emit sendGen(generations);
+    update();
+    emit info("Back to generation " + QString::number(g) + ".");
+    return true;
+}
+
+bool GameWidget::isRunning()
+{
+    return timer->isActive();
 }
 
+char GameWidget::neighMode()
+{
+    return engine.neighMode();
+}
 
-void GameWidget::step()
+char GameWidget::edgeMode()
 {
-    newGeneration();
+    return engine.edgeMode();
+}
+
+int GameWidget::radius()
+{
+    return engine.radius();
+}
+
+bool GameWidget::middleCounted()
+{
+    return engine.middleCounted();
+}
+
+int GameWidget::states()
+{
+    return engine.states();
+}
+
+QString GameWidget::birthConditions()
+{
+    return engine.birthConditions();
+}
+
+QString GameWidget::survivalConditions()
+{
+    return engine.survivalConditions();
+}
+
+int GameWidget::generation()
+{
+    return generations;
+}
+
+int GameWidget::historyFirst()
+{
+    return history.first();
+}
+
+int GameWidget::historyLast()
+{
+    return history.last();
+}
+
+void GameWidget::setHistoryLimits(int keyframeInterval, int megabytes)
+{
+    history.setKeyframeInterval(keyframeInterval);
+    history.setMemoryCap((qint64)megabytes * 1024 * 1024);
+}
+
+void GameWidget::setCheckpointPeriod(int gens, int secs)
+{
+    checkpointer->setPeriod(gens, secs);
+}
+
+QString GameWidget::checkpointDirectory()
+{
+    return checkpointer->directory();
+}
+
+Checkpoint GameWidget::checkpoint()
+{
+    settle();
+    Checkpoint c;
+    c.generation = generations;
+    c.birth = engine.birthConditions();
+    c.survival = engine.survivalConditions();
+    c.neighMode = engine.neighMode();
+    c.radius = engine.radius();
+    c.middle = engine.middleCounted();
+    c.edgeMode = engine.edgeMode();
+    c.states = engine.states();
+    c.board = engine.board();
+    if(c.states > 2){
+        c.cells = engine.cellStates();
+    }
+    return c;
+}
+
+void GameWidget::setBoard(const BitGrid &board, int g)
+{
+    edit();
+    if(board.height() != engine.height() || board.width() != engine.width()){
+        return;
+    }
+    engine.setBoard(board);
+    history.clear();
+    generations = g;
+    emit sendGen(generations);
+    update();
+}
+
+bool GameWidget::startRecording(const QString &filename)
+{
+    stopRecording();
+    if(!recorder->begin(filename, checkpoint())){
+        emit info("Could not record to " + filename + ".");
+        return false;
+    }
+    emit recording(true);
+    emit info("Recording to " + filename + ".");
+    return true;
+}
+
+void GameWidget::stopRecording()
+{
+    if(!recorder->isRunning()){
+        return;
+    }
+    recorder->finish();
+    emit recording(false);
+    emit info("Recording saved to " + recorder->fileName() + ".");
+}
+
+bool GameWidget::isRecording()
+{
+    return recorder->isRunning();
+}
+
+bool GameWidget::openTiled(const QString &filename, int height, int width)
+{
+    edit();
+    if(timer->isActive()){
+        stopGame();
+        emit gameStops(true);
+    }
+    TiledUniverse *t = new TiledUniverse;
+    bool ok = height > 0 && width > 0 ? t->create(filename, height, width) : t->open(filename);
+    if(!ok){
+        emit info(t->error());
+        delete t;
+        return false;
+    }
+    if(height > 0 && width > 0){
+        //A new file starts from the current board, in its middle.
+        t->setRule(engine.birthStates(), engine.survivalStates(), engine.neighMode(), engine.edgeMode());
+        t->setRegion((height - engine.height()) / 2, (width - engine.width()) / 2, engine.board());
+    } else {
+        engine.setNeighMode(t->neighMode());
+        engine.setEdgeMode(t->edgeMode());
+        engine.setBirthStates(t->birthStates());
+        engine.setSurvivalStates(t->survivalStates());
+    }
+    stopRecording();
+    delete tiled;
+    tiled = t;
+    history.clear();
+    marks.clear();
+    generations = (int)qMin(tiled->generation(), (qint64)INT_MAX);
+    emit sendGen(generations);
+    update();
+    emit info("Tiled universe " + tiled->fileName() + ": " + QString::number(tiled->height()) + "x"
+              + QString::number(tiled->width()) + " cells, " + QString::number(tiled->tileCount()) + " tiles.");
+    return true;
+}
+
+void GameWidget::closeTiled()
+{
+    if(!tiled){
+        return;
+    }
+    if(timer->isActive()){
+        stopGame();
+        emit gameStops(true);
+    }
+    QString name = tiled->fileName();
+    delete tiled; //Unmapped, the board stays in the file.
+    tiled = 0;
+    history.clear();
+    marks.clear();
+    update();
+    emit info("Tiled universe " + name + " closed.");
+}
+
+bool GameWidget::isTiled()
+{
+    return tiled != 0;
+}
+
+bool GameWidget::startSharing(const QString &key)
+{
+    settle();
+    if(!publisher.start(key, engine.height(), engine.width())){
+        emit info(publisher.error());
+        return false;
+    }
+    if(!publisher.publish(generations, engine.board())){ //Readers start from the current board.
+        emit info(publisher.error());
+        return false;
+    }
+    emit info("Sharing frames as " + key + ".");
+    return true;
+}
+
+void GameWidget::stopSharing()
+{
+    if(!publisher.isRunning()){
+        return;
+    }
+    publisher.stop();
+    emit info("Frame sharing stopped.");
+}
+
+bool GameWidget::isSharing()
+{
+    return publisher.isRunning();
+}
+
+bool GameWidget::hudVisible()
+{
+    return perf.isEnabled();
+}
+
+void GameWidget::setHudVisible(bool on)
+{
+    perf.setEnabled(on);
+    update();
+}
+
+bool GameWidget::writeTimings(const QString &filename)
+{
+    return perf.writeCsv(filename);
 }
 
 
 void GameWidget::newGeneration()
 {
-    int notChanged=0;
-    for(int k=1; k <= universeHeight; k++) {
-        for(int j=1; j <= universeWidth; j++) {
-            next[k][j] = isAlive(k, j);
-            if(next[k][j] == universe[k][j])
-                notChanged++;
+    if(tiled){
+        newTiledGeneration();
+        return;
+    }
+    if(pending){
+        return; //Still stepping: the tick is skipped, a universe never queues more than one step.
+    }
+    LookAhead::Frame ahead;
+    if(lookAhead->take(generations + 1, ahead)){
+        //Computed while the game was paused: only the board to take.
+        previous = engine.board();
+        previousCells = engine.states() > 2 ? engine.cellStates() : QByteArray();
+        if(ahead.changed){
+            PerfMonitor::Scope timing(perf, PerfMonitor::Step);
+            engine.setBoard(ahead.board);
+            if(!ahead.cells.isEmpty()){
+                engine.setCellStates(ahead.cells);
+            }
         }
+        advance(ahead.changed);
+        return;
     }
-    if(notChanged == universeHeight*universeWidth) {
+    lookAhead->cancel(); //Not ready or behind: stepped here, and computed again once paused.
+    //Every universe steps on the shared thread pool, its bands too: a thread waiting for
+    //its bands runs the ones not started yet itself, so universes never starve each other.
+    previous = engine.board(); //For the history, and painted until the step is done.
+    previousCells = engine.states() > 2 ? engine.cellStates() : QByteArray(); //Refractory cells, for the history.
+    stepStart = perf.isEnabled() ? perf.elapsed() : -1; //The overlay's clock starts when it is shown.
+    pending = true;
+    stepping->setFuture(QtConcurrent::run(&engine, &LifeEngine::step));
+}
+
+void GameWidget::finishGeneration()
+{
+    if(!pending){
+        return; //Already taken by settle().
+    }
+    pending = false;
+    if(perf.isEnabled() && stepStart >= 0){
+        perf.add(PerfMonitor::Step, stepStart, perf.elapsed() - stepStart); //Time in the pool queue included.
+    }
+    advance(stepping->result());
+}
+
+void GameWidget::advance(bool changed)
+{
+    if(!changed) {
+        timer->stop(); //Universes in hidden tabs stop on their own.
+        previous = BitGrid();
+        previousCells.clear();
         emit gameStops(true);
         emit info("Game stopped: all the next generations will be the same.");
         return;
     }
-    for(int k=1; k <= universeHeight; k++) {
-        for(int j=1; j <= universeWidth; j++) {
-            universe[k][j] = next[k][j];
+    history.record(generations, previous, previousCells); //Keep the generation being replaced.
+    previous = BitGrid();
+    previousCells.clear();
+    generations++;
+    marks.clear();
+    if(recorder->isRunning() || publisher.isRunning()){
+        BitGrid board = engine.board();
+        if(recorder->isRunning()){
+            recorder->append(generations, board); //Diffed and written on the recorder thread.
         }
+        if(publisher.isRunning() && !publisher.publish(generations, board)){ //One copy into the ring, readers never block it.
+            emit info(publisher.error()); //Stopped, as if toggled off.
+        }
+    }
+    if(checkpointer->due(generations)){
+        checkpointer->submit(checkpoint()); //Packed here, written on a worker thread.
     }
+    PerfMonitor::Scope timing(perf, PerfMonitor::Signals);
     update();
-    generations++;
     emit sendGen(generations);
     emit sendPop(population);
+    if(!timer->isActive()){
+        idle->start(); //Stepped by hand: the next ones are computed meanwhile.
+    }
+}
+
+void GameWidget::speculate()
+{
+    //Paused and left alone: the next generations are computed ahead on a low priority thread.
+    if(tiled || pending || timer->isActive() || lookAhead->isFollowing()){
+        return; //Frames still being taken follow the game already.
+    }
+    lookAhead->restart(checkpoint(), engine.symmetry());
+}
+
+void GameWidget::settle()
+{
+    if(!pending){
+        return;
+    }
+    stepping->waitForFinished();
+    finishGeneration();
+}
+
+void GameWidget::edit()
+{
+    settle();
+    lookAhead->cancel(); //Computed from the board as it was.
+    idle->start(); //Computed again once the edits stop.
+}
+
+void GameWidget::newTiledGeneration()
+{
+    //The rule may have been edited since the last step.
+    if(engine.radius() > 1 || engine.states() > 2
+            || !HenselRule::isTotalistic(engine.birthConditions()) || !HenselRule::isTotalistic(engine.survivalConditions())){
+        if(timer->isActive()){
+            stopGame();
+        }
+        emit gameStops(true);
+        emit info("A tiled universe only runs radius 1 outer-totalistic rules.");
+        return;
+    }
+    tiled->setRule(engine.birthStates(), engine.survivalStates(), engine.neighMode(), engine.edgeMode());
+    {
+        PerfMonitor::Scope timing(perf, PerfMonitor::Step);
+        if(!tiled->step()) {
+            emit gameStops(true);
+            emit info("Game stopped: all the next generations will be the same.");
+            return;
+        }
+        generations++; //No history, recording or checkpoints: the board lives in its file.
+        marks.clear();
+    }
+    PerfMonitor::Scope timing(perf, PerfMonitor::Signals);
+    update();
+    emit sendGen(generations);
 }
 
 
 //Events:
+bool GameWidget::event(QEvent *e)
+{
+    if(e->type() == QEvent::Paint){
+        return QWidget::event(e); //Timed by phase in paintEvent().
+    }
+    PerfMonitor::Scope timing(perf, PerfMonitor::Events);
+    return QWidget::event(e);
+}
+
 void GameWidget::paintEvent(QPaintEvent *)
 {
     QPainter p(this);
-    paintGrid(p);
-    paintUniverse(p);
+    {
+        PerfMonitor::Scope timing(perf, PerfMonitor::Grid);
+        paintGrid(p);
+    }
+    {
+        PerfMonitor::Scope timing(perf, PerfMonitor::Cells);
+        paintUniverse(p);
+    }
+    if(!marks.isEmpty()){
+        paintMarks(p);
+    }
+    if(!selected.isNull()){
+        paintSelection(p);
+    }
+    if(perf.isEnabled()){
+        paintHud(p);
+    }
 }
 
 void GameWidget::mousePressEvent(QMouseEvent *e)
 {
-    double cellHeight = (double)height()/universeHeight;
-    double cellWidth = (double)width()/universeWidth;
+    if((e->modifiers() & Qt::ShiftModifier) && e->buttons() == Qt::LeftButton){
+        //Shift-drag selects, or moves the selection when started inside it.
+        dragFrom = dragTo = cellAt(e->pos());
+        drag = selected.contains(dragFrom) ? Moving : Selecting;
+        if(drag == Selecting){
+            selected = QRect(dragFrom, dragFrom);
+        }
+        update();
+        return;
+    }
+    double cellHeight = (double)height()/getUniverseHeight();
+    double cellWidth = (double)width()/getUniverseWidth();
     int k = floor(e->y()/cellHeight)+1;
     int j = floor(e->x()/cellWidth)+1;
     if( e->buttons() == Qt::LeftButton){
-        universe[k][j] = true;
+        setCell(k, j, true);
     }
     if( e->buttons() == Qt::RightButton){
-        universe[k][j] = false;
+        setCell(k, j, false);
     }
     update();
 }
 
 void GameWidget::mouseMoveEvent(QMouseEvent *e)
 {
+    if(drag != NoDrag){
+        dragTo = cellAt(e->pos());
+        if(drag == Selecting){
+            selected = QRect(dragFrom, dragTo).normalized();
+        }
+        update();
+        return;
+    }
     if(e->x() >= width() || e->y() >= height()){
         //Wihout this, it crashes the program when the mouse is dragged out of the game area.
         return;
     }
-    double cellHeight = (double)height()/universeHeight;
-    double cellWidth = (double)width()/universeWidth;
+    hovered = cellAt(e->pos());
+    double cellHeight = (double)height()/getUniverseHeight();
+    double cellWidth = (double)width()/getUniverseWidth();
     int k = floor(e->y()/cellHeight)+1;
     int j = floor(e->x()/cellWidth)+1;
     if(e->buttons() == Qt::LeftButton){
@@ -363,7 +927,7 @@ void GameWidget::mouseMoveEvent(QMouseEvent *e)
             emit gameStops(true);
             interupted = true;
         }
-        universe[k][j] = true;
+        setCell(k, j, true);
         update();
     }
     if(e->buttons() == Qt::RightButton){
@@ -372,7 +936,7 @@ void GameWidget::mouseMoveEvent(QMouseEvent *e)
             emit gameStops(true);
             interupted = true;
         }
-        universe[k][j] = false;
+        setCell(k, j, false);
         update();
     }
     sendXY(j, k);
@@ -380,6 +944,14 @@ void GameWidget::mouseMoveEvent(QMouseEvent *e)
 
 void GameWidget::mouseReleaseEvent(QMouseEvent *e)
 {
+    if(drag == Moving && dragTo != dragFrom){
+        moveSelection(dragTo.y() - dragFrom.y(), dragTo.x() - dragFrom.x());
+    }
+    if(drag != NoDrag){
+        drag = NoDrag;
+        update();
+        return;
+    }
     if(interupted){
         startGame();
         interupted = false;
@@ -412,8 +984,8 @@ void GameWidget::wheelEvent(QWheelEvent * e){
             emit wheeldw();
         }
     }
-    double cellHeight = (double)height()/universeHeight;
-    double cellWidth = (double)width()/universeWidth;
+    double cellHeight = (double)height()/getUniverseHeight();
+    double cellWidth = (double)width()/getUniverseWidth();
     int k = floor(e->y()/cellHeight)+1;
     int j = floor(e->x()/cellWidth)+1;
     emit sendXY(j, k);
@@ -442,60 +1014,137 @@ void GameWidget::keyPressEvent(QKeyEvent *e)
 //Painting methods:
 void GameWidget::paintGrid(QPainter &p)
 {
-    QRect borders(0, 0, width()-1, height()-1); // borders of the universe
-    QColor gridColor = "#000"; // color of the grid
-    double cellWidth = (double)width()/universeWidth; // width of the widget / number of cells at one row
-    int n = 1;
-    for(double k = cellWidth; k <= width(); k += cellWidth)
-    {
-        if( n % 10 == 0){
-            //every 10n line is thicker.
-            gridColor.setAlpha(100);
-            p.setPen(QPen(QBrush(gridColor), 2.0));
-            p.drawLine(k, 0, k, height());
-        } else {
-            gridColor.setAlpha(50);
-            p.setPen(QPen(QBrush(gridColor), 1.0));
-            p.drawLine(k, 0, k, height());
-        }
-        n++;
+    BoardPainter::paintGrid(p, size(), getUniverseHeight(), getUniverseWidth(), visibleRegion().boundingRect());
+}
+
+void GameWidget::paintUniverse(QPainter &p)
+{
+    if(!tiled && engine.states() > 2){
+        settle();
+        population = BoardPainter::paintStates(p, size(), engine.generations(), m_masterColor);
+        emit sendPop(population);
+        return;
     }
-    double cellHeight = (double)height()/universeHeight; // height of the widget / number of cells at one row
-    n = 1;
-    for(double k = cellHeight; k <= height(); k += cellHeight)
-    {
-        if(n % 10 == 0){
-            //every 10n line is thicker.
-            gridColor.setAlpha(100);
-            p.setPen(QPen(QBrush(gridColor), 2.0));
-            p.drawLine(0, k, width(), k);
-        } else {
-            gridColor.setAlpha(50);
-            p.setPen(QPen(QBrush(gridColor), 1.0));
-            p.drawLine(0, k, width(), k);
-        }
-        n++;
+    //Only the part of the board in the viewport is painted, whatever holds it.
+    QRect cells = visibleCells();
+    //While a step runs, the generation it started from is still the one shown.
+    BitGrid board = tiled || pending ? previous : engine.board();
+    BitGrid shown = tiled ? tiled->region(cells.top(), cells.left(), cells.height(), cells.width())
+                          : board.region(cells.top(), cells.left(), cells.height(), cells.width());
+    BoardPainter::paintRegion(p, size(), getUniverseHeight(), getUniverseWidth(), cells.topLeft(), shown, m_masterColor);
+    if(tiled){
+        population = (int)qMin(tiled->population(), (qint64)INT_MAX);
+    } else {
+        population = board.population();
     }
-    p.drawRect(borders);
+    emit sendPop(population);
 }
 
-void GameWidget::paintUniverse(QPainter &p)
+void GameWidget::paintMarks(QPainter &p)
 {
-    population = 0;
-    double cellWidth = (double)width()/universeWidth;
-    double cellHeight = (double)height()/universeHeight;
-    for(int k=1; k <= universeHeight; k++) {
-        for(int j=1; j <= universeWidth; j++) {
-            if(universe[k][j] == true) { // if there is any sense to paint it
-                qreal left = (qreal)(cellWidth*(j-1) + 1); // margin from left
-                qreal top  = (qreal)(cellHeight*(k-1) + 1); // margin from top
-                QRectF r(left, top, (qreal)(cellWidth) - 1.5, (qreal)(cellHeight) - 1.5);
-                p.fillRect(r, QBrush(m_masterColor)); // fill cell with brush of main color
-                population++;
-            }
+    double cellHeight = (double)height()/getUniverseHeight();
+    double cellWidth = (double)width()/getUniverseWidth();
+    p.setPen(QPen(Qt::red, 2));
+    p.setBrush(Qt::NoBrush);
+    foreach(QRect r, marks){
+        p.drawRect(QRectF(r.x() * cellWidth - 1, r.y() * cellHeight - 1,
+                          r.width() * cellWidth + 2, r.height() * cellHeight + 2));
+    }
+}
+
+void GameWidget::paintSelection(QPainter &p)
+{
+    double cellHeight = (double)height()/getUniverseHeight();
+    double cellWidth = (double)width()/getUniverseWidth();
+    p.setPen(QPen(QBrush(QColor("#06c")), 2, Qt::DashLine));
+    p.setBrush(QColor(0, 102, 204, 30));
+    QRect r = selected;
+    if(drag == Moving){
+        r.translate(dragTo - dragFrom); //Where it would be dropped.
+    }
+    p.drawRect(QRectF(r.x() * cellWidth, r.y() * cellHeight, r.width() * cellWidth, r.height() * cellHeight));
+}
+
+void GameWidget::paintHud(QPainter &p)
+{
+    //Top left corner of the visible part of the board, which sits in a scroll area.
+    QStringList lines = perf.summary();
+    QFont font("Monospace", 8);
+    font.setStyleHint(QFont::TypeWriter);
+    p.setFont(font);
+    QFontMetrics metrics(font);
+    int w = 0;
+    foreach(QString line, lines){ w = qMax(w, metrics.width(line)); }
+    QRect box(visibleRegion().boundingRect().topLeft() + QPoint(6, 6),
+              QSize(w + 12, metrics.lineSpacing() * lines.size() + 8));
+    p.fillRect(box, QColor(0, 0, 0, 170));
+    p.setPen(Qt::green);
+    for(int i = 0; i < lines.size(); i++){
+        p.drawText(box.left() + 6, box.top() + 4 + metrics.ascent() + i * metrics.lineSpacing(), lines[i]);
+    }
+}
+
+QPoint GameWidget::cellAt(const QPoint &pos)
+{
+    double cellHeight = (double)height()/getUniverseHeight();
+    double cellWidth = (double)width()/getUniverseWidth();
+    return QPoint(qBound(0, (int)floor(pos.x()/cellWidth), getUniverseWidth() - 1),
+                  qBound(0, (int)floor(pos.y()/cellHeight), getUniverseHeight() - 1));
+}
+
+bool GameWidget::editable()
+{
+    return tiled || engine.states() == 2;
+}
+
+BitGrid GameWidget::area(const QRect &cells)
+{
+    settle();
+    if(tiled){
+        return tiled->region(cells.top(), cells.left(), cells.height(), cells.width());
+    }
+    return engine.region(cells.top(), cells.left(), cells.height(), cells.width());
+}
+
+void GameWidget::setArea(int top, int left, const BitGrid &cells, BitGrid::Merge mode)
+{
+    //Only the rows and columns of the rectangle are touched, whatever the size of the board.
+    edit();
+    if(tiled){
+        BitGrid now = cells;
+        if(mode != BitGrid::Replace){
+            now = tiled->region(top, left, cells.height(), cells.width());
+            now.blit(cells, 0, 0, mode);
         }
+        tiled->setRegion(top, left, now);
+        return;
     }
-    emit sendPop(population);
+    engine.setRegion(top, left, cells, mode);
+}
+
+void GameWidget::replaceArea(const QRect &from, const QRect &to, const BitGrid &cells)
+{
+    //One edit of both rectangles: from cleared, then cells at to.
+    QRect both = from.united(to);
+    BitGrid now = area(both);
+    now.fill(from.top() - both.top(), from.left() - both.left(), from.height(), from.width(), false);
+    now.blit(cells, to.top() - both.top(), to.left() - both.left());
+    setArea(both.top(), both.left(), now);
+}
+
+void GameWidget::setCell(int k, int j, bool alive)
+{
+    edit();
+    if(tiled){
+        tiled->setCell(k - 1, j - 1, alive);
+    } else {
+        engine.setCell(k, j, alive);
+    }
+}
+
+QRect GameWidget::visibleCells()
+{
+    return BoardPainter::visibleCells(size(), getUniverseHeight(), getUniverseWidth(), visibleRegion().boundingRect());
 }
 
 QColor GameWidget::masterColor()
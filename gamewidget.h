@@ -4,6 +4,17 @@
 #include <QColor>
 #include <QWidget>
 #include <QList>
+#include <QRect>
+#include <QFutureWatcher>
+#include "lifeengine.h"
+#include "generationhistory.h"
+#include "checkpointer.h"
+#include "runrecorder.h"
+#include "lookahead.h"
+#include "perfmonitor.h"
+#include "tileduniverse.h"
+#include "framering.h"
+#include "soup.h"
 
 class GameWidget : public QWidget
 {
@@ -13,6 +24,7 @@ public:
     ~GameWidget();
 
 protected:
+    bool event(QEvent *e);
     void paintEvent(QPaintEvent *);
     void mousePressEvent(QMouseEvent *e);
     void mouseMoveEvent(QMouseEvent *e);
@@ -32,23 +44,85 @@ signals:
     void stwheelup();
     void stwheeldw();
     void info(QString);
+    void recording(bool);
 
 public slots:
     void startGame(); // start
     void stopGame(); // finish
     void clear(); // clear
     void step();
+    void stepBack(); // restore the previous generation
+    bool jumpTo(int g); // restore a recorded generation
     void invert();
 
+    bool isRunning(); // timer started
+    int generation(); // current generation number
+    int historyFirst(); // oldest generation that can be restored
+    int historyLast(); // newest generation that can be restored
+    void setHistoryLimits(int keyframeInterval, int megabytes);
+    void setCheckpointPeriod(int gens, int secs); // automatic checkpoints, 0 disables
+    QString checkpointDirectory();
+    Checkpoint checkpoint(); // current board, rule and generation
+    QString rule(); // LifeEngine::rule()
+    BitGrid board(); // live cells
+    void setMarks(const QList<QRect> &cells); // areas outlined over the board (cell coordinates from 0), until the next generation
+    QRect selection(); // selected cells from 0, null if none (shift-drag to select, shift-drag inside to move)
+    void selectAll();
+    void selectNone();
+    void copySelection();
+    void cutSelection();
+    void paste(); // clipboard at the selection's corner, or under the mouse, merged with pasteMode()
+    void fillSelection();
+    void clearSelection();
+    void invertSelection();
+    void rotateSelection(bool clockwise); // about its centre
+    void mirrorSelection(); // left-right
+    void flipSelection(); // top-bottom
+    void randomFill(double density, Soup::Symmetry symmetry, quint64 seed); // soup over the selection, or the whole board
+    QString soup(); // Soup::describe() of the soup the whole board was filled with, empty if none
+    void setSoup(const QString &soup); // as read from a saved file
+    Soup::Symmetry symmetry(); // largest group stepping may use, LifeEngine::setSymmetry()
+    void setSymmetry(Soup::Symmetry group); // C1 steps every cell
+    Soup::Symmetry activeSymmetry(); // group of the board the next step uses
+    BitGrid::Merge pasteMode();
+    void setPasteMode(BitGrid::Merge mode);
+    void setBoard(const BitGrid &board, int g); // board of the current size at generation g
+    bool startRecording(const QString &filename); // write every following generation to a .lrec stream
+    void stopRecording();
+    bool isRecording();
+    bool hudVisible();
+    void setHudVisible(bool on); // timing overlay, timings are only taken while it is shown
+    bool writeTimings(const QString &filename); // CSV of the recorded timings
+    bool openTiled(const QString &filename, int height = 0, int width = 0); // out-of-core board, created (with the current board in the middle) if a size is given
+    void closeTiled(); // back to the in-memory board
+    bool isTiled();
+    bool startSharing(const QString &key); // publish every generation to a shared memory frame ring
+    void stopSharing();
+    bool isSharing();
+
+    char neighMode();
+    char edgeMode();
+    int radius();
+    bool middleCounted();
+    int states();
+    QString birthConditions(); // as typed in the rule input
+    QString survivalConditions();
+
     int getUniverseHeight();
     int getUniverseWidth();
     void setUniverseHeight(const int &s); // set number of the cells in one row
     void setUniverseWidth(const int &s);
     void setNeighMode(char mode);
     void setEdgeMode(char mode);
+    void setRadius(int r);
+    void setMiddleCounted(bool counted);
+    void setStates(int n); // > 2 for Generations rules
+    void setCellStates(const QByteArray &cells); // every cell's state, row major
 
     void setBirthStates( QList<int> states);
     void setSurvStates( QList<int> states);
+    bool setBirthConditions(const QString &text); // Hensel notation, false if invalid
+    bool setSurvConditions(const QString &text);
 
     int interval(); // interval between generations
     void setInterval(int msec); // set interval between generations
@@ -62,25 +136,57 @@ public slots:
 private slots:
     void paintGrid(QPainter &p);
     void paintUniverse(QPainter &p);
+    void paintHud(QPainter &p);
+    void paintMarks(QPainter &p);
+    void paintSelection(QPainter &p);
     void newGeneration();
+    void finishGeneration(); // the step handed to the thread pool is done
+    void speculate(); // paused: start computing the next generations ahead
+    void newTiledGeneration();
 
 private:
     QColor m_masterColor;
     QTimer* timer;
     int generations;
-    QList<int> BirthStates;
-    QList<int> SurvStates;
-    int universeHeight;
-    int universeWidth;
-    char neighMode;
-    char edgeMode;
-    bool** universe; // map
-    bool** next; // map
+    LifeEngine engine; // universe and rules, only touched by the thread pool while a step is pending
+    QFutureWatcher<bool>* stepping; // step running on the shared thread pool
+    bool pending; // a step was handed over and its result not taken yet
+    BitGrid previous; // board before the pending step
+    QByteArray previousCells; // states > 2: cell states before the pending step
+    qint64 stepStart; // perf clock when the pending step was handed over, -1 if the overlay was hidden then
+    TiledUniverse* tiled; // out-of-core board, 0 while the engine holds it
+    GenerationHistory history; // previous generations
+    Checkpointer* checkpointer; // background saves
+    RunRecorder* recorder; // generation stream writer
+    LookAhead* lookAhead; // next generations of the paused game
+    QTimer* idle; // restarts the look-ahead once the game is left alone
+    PerfMonitor perf; // phase timings
+    FramePublisher publisher; // frames for external viewers
     bool interupted;
+    QList<QRect> marks; // outlined cells, e.g. pattern search matches
+    enum Drag { NoDrag, Selecting, Moving };
+    QRect selected; // selected cells, null if none
+    static BitGrid clipboard; // copied cells, shared by the games of every tab
+    BitGrid::Merge merge; // how pasted cells meet the board
+    Drag drag; // shift-drag in progress
+    QPoint dragFrom; // cell where the drag started
+    QPoint dragTo; // cell under the mouse
+    QPoint hovered; // last cell under the mouse
+    QString soupRecord; // seed of the last whole board fill, kept in saved files
     int population;
 
-    bool isAlive(int k, int j); // return true if universe[k][j] accept rules
     void resetUniverse();// reset the size of universe
+    void settle(); // wait for the pending step and take its result
+    void edit(); // settle() and drop the look-ahead: the board, rule or a mode is about to change
+    void advance(bool changed); // the engine holds the next generation, previous the one it replaced
+    void setCell(int k, int j, bool alive); // from (1,1), on whichever holds the board
+    QRect visibleCells(); // cells under the visible part of the widget
+    QPoint cellAt(const QPoint &pos); // cell (column, row) from 0 under a point, on the board
+    bool editable(); // selection edits keep no refractory states
+    BitGrid area(const QRect &cells); // copy of part of the board, whatever holds it
+    void setArea(int top, int left, const BitGrid &cells, BitGrid::Merge mode = BitGrid::Replace);
+    void replaceArea(const QRect &from, const QRect &to, const BitGrid &cells); // from cleared and cells put at to, in one edit
+    void moveSelection(int dk, int dj);
 };
 
 #endif // GAMEWIDGET_H
@@ -0,0 +1,194 @@
+#include "generationhistory.h"
+#include "memoryusage.h"
+
+
+//Constructor:
+GenerationHistory::GenerationHistory(int keyframeInterval, qint64 memoryCap) :
+    sinceKeyframe(0),
+    interval(qMax(1, keyframeInterval)),
+    cap(memoryCap),
+    used(0),
+    booked(0)
+{
+}
+
+//Destructor:
+GenerationHistory::~GenerationHistory()
+{
+    MemoryUsage::add(MemoryUsage::History, -booked);
+}
+
+
+//Recording:
+int GenerationHistory::Frame::byteSize() const
+{
+    return sizeof(Frame) + board.byteSize() + delta.size() + cells.size();
+}
+
+void GenerationHistory::record(int generation, const BitGrid &board, const QByteArray &cells)
+{
+    truncateAfter(generation - 1);
+    Frame f;
+    f.generation = generation;
+    if(!cells.isEmpty()){
+        f.cells = qCompress(cells, 1); //Mostly dead cells: fast level is enough.
+    }
+    bool keyframe = frames.isEmpty()
+            || frames.last().generation != generation - 1 //Gap: nothing to diff against.
+            || newest.height() != board.height() || newest.width() != board.width()
+            || sinceKeyframe + 1 >= interval;
+    if(keyframe){
+        f.board = board;
+        sinceKeyframe = 0;
+    } else {
+        f.delta = BitGrid::delta(newest, board);
+        sinceKeyframe++;
+    }
+    newest = board;
+    frames.append(f);
+    used += f.byteSize();
+    while(used > cap && frames.size() > 1){
+        dropOldest();
+    }
+    book();
+}
+
+void GenerationHistory::clear()
+{
+    frames.clear();
+    newest = BitGrid();
+    sinceKeyframe = 0;
+    used = 0;
+    book();
+}
+
+void GenerationHistory::truncateAfter(int generation)
+{
+    if(frames.isEmpty() || frames.last().generation <= generation){
+        return;
+    }
+    while(!frames.isEmpty() && frames.last().generation > generation){
+        used -= frames.takeLast().byteSize();
+    }
+    if(frames.isEmpty()){
+        clear();
+        return;
+    }
+    newest = at(frames.last().generation);
+    sinceKeyframe = 0;
+    for(int i = frames.size() - 1; frames[i].board.isNull(); i--){
+        sinceKeyframe++;
+    }
+    book();
+}
+
+void GenerationHistory::dropOldest()
+{
+    //The first frame is always a keyframe, the next one inherits its board if needed.
+    Frame old = frames.takeFirst();
+    used -= old.byteSize();
+    if(!frames.isEmpty() && frames.first().board.isNull()){
+        Frame &next = frames.first();
+        used -= next.byteSize();
+        next.board = old.board;
+        next.board.applyDelta(next.delta);
+        next.delta.clear();
+        used += next.byteSize();
+    }
+}
+
+void GenerationHistory::book()
+{
+    MemoryUsage::add(MemoryUsage::History, used - booked);
+    booked = used;
+}
+
+
+//Lookup:
+int GenerationHistory::indexOf(int generation) const
+{
+    int lo = 0;
+    int hi = frames.size() - 1;
+    while(lo <= hi){
+        int mid = (lo + hi) / 2;
+        int g = frames[mid].generation;
+        if(g == generation){ return mid; }
+        if(g < generation){ lo = mid + 1; } else { hi = mid - 1; }
+    }
+    return -1;
+}
+
+bool GenerationHistory::contains(int generation) const
+{
+    return indexOf(generation) >= 0;
+}
+
+BitGrid GenerationHistory::at(int generation) const
+{
+    int idx = indexOf(generation);
+    if(idx < 0){
+        return BitGrid();
+    }
+    int k = idx;
+    while(frames[k].board.isNull()){ k--; }
+    BitGrid board = frames[k].board;
+    for(int i = k + 1; i <= idx; i++){
+        board.applyDelta(frames[i].delta);
+    }
+    return board;
+}
+
+QByteArray GenerationHistory::cellsAt(int generation) const
+{
+    int idx = indexOf(generation);
+    if(idx < 0 || frames[idx].cells.isEmpty()){
+        return QByteArray();
+    }
+    return qUncompress(frames[idx].cells);
+}
+
+bool GenerationHistory::isEmpty() const
+{
+    return frames.isEmpty();
+}
+
+int GenerationHistory::first() const
+{
+    return frames.isEmpty() ? -1 : frames.first().generation;
+}
+
+int GenerationHistory::last() const
+{
+    return frames.isEmpty() ? -1 : frames.last().generation;
+}
+
+
+//Settings:
+int GenerationHistory::keyframeInterval() const
+{
+    return interval;
+}
+
+void GenerationHistory::setKeyframeInterval(int n)
+{
+    interval = qMax(1, n);
+}
+
+qint64 GenerationHistory::memoryCap() const
+{
+    return cap;
+}
+
+void GenerationHistory::setMemoryCap(qint64 bytes)
+{
+    cap = bytes;
+    while(used > cap && frames.size() > 1){
+        dropOldest();
+    }
+    book();
+}
+
+qint64 GenerationHistory::memoryUsed() const
+{
+    return used;
+}
@@ -0,0 +1,65 @@
+#ifndef GENERATIONHISTORY_H
+#define GENERATIONHISTORY_H
+
+#include <QList>
+#include <QByteArray>
+#include "bitgrid.h"
+
+/**
+  *
+  * Memory capped record of the previous generations of a universe.
+  * A full keyframe is kept every keyframeInterval generations, the generations in between
+  * are stored as the run-length encoded XOR of their words with the previous generation.
+  * When the cap is reached the oldest generations are dropped first.
+  * Boards of Generations rules also keep every cell's state, compressed, on each frame: the
+  * live cells alone would lose the refractory ones.
+  * The memory used is reported to MemoryUsage as History.
+ */
+
+class GenerationHistory
+{
+public:
+    explicit GenerationHistory(int keyframeInterval = 32, qint64 memoryCap = 64 * 1024 * 1024);
+    ~GenerationHistory();
+
+    void record(int generation, const BitGrid &board, const QByteArray &cells = QByteArray()); // store board (and cell states, if more than 2) as generation, forgetting any later one
+    void clear();
+    void truncateAfter(int generation); // forget everything after generation
+
+    bool contains(int generation) const;
+    BitGrid at(int generation) const; // rebuilt board, null if not recorded
+    QByteArray cellsAt(int generation) const; // cell states recorded with it, empty if none
+    bool isEmpty() const;
+    int first() const; // oldest generation available
+    int last() const; // newest generation available
+
+    int keyframeInterval() const;
+    void setKeyframeInterval(int n);
+    qint64 memoryCap() const;
+    void setMemoryCap(qint64 bytes);
+    qint64 memoryUsed() const;
+
+private:
+    struct Frame {
+        int generation;
+        BitGrid board; // set on keyframes only
+        QByteArray delta; // XOR with previous generation, on other frames
+        QByteArray cells; // qCompress()ed cell states, Generations rules only
+        int byteSize() const;
+    };
+    QList<Frame> frames; // oldest first, generations strictly increasing
+    BitGrid newest; // board of the last frame, base of the next delta
+    int sinceKeyframe;
+    int interval;
+    qint64 cap;
+    qint64 used;
+    qint64 booked; // part of used reported to MemoryUsage
+
+    int indexOf(int generation) const;
+    void dropOldest();
+    void book(); // reports the change of used
+
+    Q_DISABLE_COPY(GenerationHistory)
+};
+
+#endif // GENERATIONHISTORY_H
@@ -0,0 +1,458 @@
+#include <QStringList>
+#include "generationsengine.h"
+
+//Lanes are the packed cells of a word, 2 or 4 bits wide.
+static inline quint64 lowBits(int bits)
+{
+    //Lowest bit of every lane.
+    return bits == 2 ? Q_UINT64_C(0x5555555555555555) : Q_UINT64_C(0x1111111111111111);
+}
+
+static inline quint64 zeroLanes(quint64 x, quint64 low, int bits)
+{
+    //Low bit set in every lane of x that is 0.
+    quint64 m = low * ((1 << (bits - 1)) - 1); // all but the high bit of each lane
+    quint64 y = ((x & m) + m) | x | m;
+    return (~y >> (bits - 1)) & low;
+}
+
+static inline quint64 spreadLanes(quint64 x, int bits)
+{
+    //One bit per cell (64 / bits of them) -> low bit of each lane.
+    if(bits == 2){
+        x &= Q_UINT64_C(0xFFFFFFFF);
+        x = (x | (x << 16)) & Q_UINT64_C(0x0000FFFF0000FFFF);
+        x = (x | (x << 8)) & Q_UINT64_C(0x00FF00FF00FF00FF);
+        x = (x | (x << 4)) & Q_UINT64_C(0x0F0F0F0F0F0F0F0F);
+        x = (x | (x << 2)) & Q_UINT64_C(0x3333333333333333);
+        return (x | (x << 1)) & Q_UINT64_C(0x5555555555555555);
+    }
+    x &= Q_UINT64_C(0xFFFF);
+    x = (x | (x << 24)) & Q_UINT64_C(0x000000FF000000FF);
+    x = (x | (x << 12)) & Q_UINT64_C(0x000F000F000F000F);
+    x = (x | (x << 6)) & Q_UINT64_C(0x0303030303030303);
+    return (x | (x << 3)) & Q_UINT64_C(0x1111111111111111);
+}
+
+static inline quint64 compressLanes(quint64 x, int bits)
+{
+    //Inverse of spreadLanes().
+    if(bits == 2){
+        x &= Q_UINT64_C(0x5555555555555555);
+        x = (x | (x >> 1)) & Q_UINT64_C(0x3333333333333333);
+        x = (x | (x >> 2)) & Q_UINT64_C(0x0F0F0F0F0F0F0F0F);
+        x = (x | (x >> 4)) & Q_UINT64_C(0x00FF00FF00FF00FF);
+        x = (x | (x >> 8)) & Q_UINT64_C(0x0000FFFF0000FFFF);
+        return (x | (x >> 16)) & Q_UINT64_C(0xFFFFFFFF);
+    }
+    x &= Q_UINT64_C(0x1111111111111111);
+    x = (x | (x >> 3)) & Q_UINT64_C(0x0303030303030303);
+    x = (x | (x >> 6)) & Q_UINT64_C(0x000F000F000F000F);
+    x = (x | (x >> 12)) & Q_UINT64_C(0x000000FF000000FF);
+    return (x | (x >> 24)) & Q_UINT64_C(0xFFFF);
+}
+
+//Adds one neighbour word to the bit-sliced 4 bit counters s0..s3 (one counter per cell).
+static inline void addNeighbour(quint64 x, quint64 &s0, quint64 &s1, quint64 &s2, quint64 &s3)
+{
+    quint64 c0 = s0 & x;
+    s0 ^= x;
+    quint64 c1 = s1 & c0;
+    s1 ^= c0;
+    quint64 c2 = s2 & c1;
+    s2 ^= c1;
+    s3 |= c2;
+}
+
+
+//Constructor:
+GenerationsEngine::GenerationsEngine(int height, int width, MemoryUsage::Kind kind) :
+    h(0),
+    w(0),
+    nStates(3),
+    bits(2),
+    wpr(0),
+    lpr(0),
+    neigh('m'),
+    edge('p'),
+    lastChanged(0),
+    cells(kind),
+    next(MemoryUsage::Scratch),
+    live(MemoryUsage::Scratch),
+    zeros(MemoryUsage::Scratch)
+{
+    birth << 2; //Brian's Brain.
+    resize(height, width);
+}
+
+
+//Size:
+int GenerationsEngine::height() const
+{
+    return h;
+}
+
+int GenerationsEngine::width() const
+{
+    return w;
+}
+
+void GenerationsEngine::resize(int height, int width)
+{
+    h = height;
+    w = width;
+    wpr = (w * bits + 63) / 64;
+    lpr = (w + 63) / 64;
+    cells.fill(0, h * wpr);
+    next.fill(0, h * wpr);
+    live.fill(0, h * lpr);
+    zeros.fill(0, lpr);
+    lastChanged = 0;
+}
+
+void GenerationsEngine::repack(int newBits)
+{
+    QByteArray states = cellStates();
+    bits = newBits;
+    wpr = (w * bits + 63) / 64;
+    cells.fill(0, h * wpr);
+    next.fill(0, h * wpr);
+    setCellStates(states);
+}
+
+
+//Rules:
+int GenerationsEngine::states() const
+{
+    return nStates;
+}
+
+void GenerationsEngine::setStates(int n)
+{
+    n = qBound(2, n, (int)MaxStates);
+    QByteArray states = cellStates();
+    for(int i = 0; i < states.size(); i++){
+        if(states[i] >= n){ states[i] = 0; }
+    }
+    nStates = n;
+    setCellStates(states);
+    int newBits = n <= 4 ? 2 : 4;
+    if(newBits != bits){
+        repack(newBits);
+    }
+}
+
+int GenerationsEngine::bitsPerCell() const
+{
+    return bits;
+}
+
+char GenerationsEngine::neighMode() const
+{
+    return neigh;
+}
+
+void GenerationsEngine::setNeighMode(char mode)
+{
+    neigh = mode;
+}
+
+char GenerationsEngine::edgeMode() const
+{
+    return edge;
+}
+
+void GenerationsEngine::setEdgeMode(char mode)
+{
+    edge = mode;
+}
+
+QList<int> GenerationsEngine::birthStates() const
+{
+    return birth;
+}
+
+void GenerationsEngine::setBirthStates(const QList<int> &states)
+{
+    birth = states;
+}
+
+QList<int> GenerationsEngine::survivalStates() const
+{
+    return survival;
+}
+
+void GenerationsEngine::setSurvivalStates(const QList<int> &states)
+{
+    survival = states;
+}
+
+bool GenerationsEngine::parseRule(const QString &rule, QList<int> &b, QList<int> &s, int &states)
+{
+    QStringList parts = rule.trimmed().toUpper().split('/');
+    if(parts.size() != 3){
+        return false;
+    }
+    QString bText, sText, cText;
+    if(parts[0].startsWith('B') || parts[0].startsWith('S')){
+        //B2/S/C3, in any order.
+        foreach(QString part, parts){
+            if(part.startsWith('B')){ bText = part.mid(1); }
+            else if(part.startsWith('S')){ sText = part.mid(1); }
+            else if(part.startsWith('C') || part.startsWith('G')){ cText = part.mid(1); }
+            else { return false; }
+        }
+    } else {
+        //Golly's S/B/C.
+        sText = parts[0];
+        bText = parts[1];
+        cText = parts[2];
+    }
+    bool ok;
+    states = cText.toInt(&ok);
+    if(!ok || states < 2 || states > MaxStates){
+        return false;
+    }
+    b.clear();
+    s.clear();
+    foreach(QChar c, bText){
+        if(!c.isDigit() || c.digitValue() > 8){ return false; }
+        if(!b.contains(c.digitValue())){ b << c.digitValue(); }
+    }
+    foreach(QChar c, sText){
+        if(!c.isDigit() || c.digitValue() > 8){ return false; }
+        if(!s.contains(c.digitValue())){ s << c.digitValue(); }
+    }
+    qSort(b);
+    qSort(s);
+    return true;
+}
+
+bool GenerationsEngine::setRule(const QString &rule)
+{
+    QList<int> b, s;
+    int n;
+    if(!parseRule(rule, b, s, n)){
+        return false;
+    }
+    birth = b;
+    survival = s;
+    setStates(n);
+    return true;
+}
+
+QString GenerationsEngine::rule() const
+{
+    QString r = "B";
+    foreach(int b, birth){ r += QString::number(b); }
+    r += "/S";
+    foreach(int s, survival){ r += QString::number(s); }
+    return r + "/C" + QString::number(nStates);
+}
+
+
+//Cells:
+int GenerationsEngine::cell(int k, int j) const
+{
+    int per = 64 / bits;
+    return (cells[k * wpr + j / per] >> ((j % per) * bits)) & ((1 << bits) - 1);
+}
+
+void GenerationsEngine::setCell(int k, int j, int state)
+{
+    if(state < 0 || state >= nStates){
+        state = 0;
+    }
+    int per = 64 / bits;
+    int shift = (j % per) * bits;
+    quint64 &word = cells[k * wpr + j / per];
+    word = (word & ~((((quint64)1 << bits) - 1) << shift)) | ((quint64)state << shift);
+}
+
+void GenerationsEngine::clear()
+{
+    cells.fill(0);
+    lastChanged = 0;
+}
+
+int GenerationsEngine::population() const
+{
+    quint64 low = lowBits(bits);
+    int n = 0;
+    for(int i = 0; i < cells.size(); i++){
+        n += qPopulationCount(zeroLanes(cells[i] ^ low, low, bits));
+    }
+    return n;
+}
+
+int GenerationsEngine::changed() const
+{
+    return lastChanged;
+}
+
+BitGrid GenerationsEngine::board() const
+{
+    BitGrid b(h, w);
+    int per = 64 / bits;
+    quint64 low = lowBits(bits);
+    for(int k = 0; k < h; k++){
+        quint64 *row = b.row(k);
+        for(int p = 0; p < wpr; p++){
+            int j = p * per;
+            row[j / 64] |= compressLanes(zeroLanes(cells[k * wpr + p] ^ low, low, bits), bits) << (j % 64);
+        }
+    }
+    return b;
+}
+
+void GenerationsEngine::setBoard(const BitGrid &board)
+{
+    if(board.height() != h || board.width() != w){
+        return;
+    }
+    int per = 64 / bits;
+    for(int k = 0; k < h; k++){
+        const quint64 *row = board.row(k);
+        for(int p = 0; p < wpr; p++){
+            int j = p * per;
+            cells[k * wpr + p] = spreadLanes(row[j / 64] >> (j % 64), bits);
+        }
+    }
+    lastChanged = 0;
+}
+
+void GenerationsEngine::toUniverse(bool **universe) const
+{
+    for(int k = 0; k < h; k++){
+        for(int j = 0; j < w; j++){
+            universe[k + 1][j + 1] = cell(k, j) == 1;
+        }
+    }
+}
+
+QByteArray GenerationsEngine::cellStates() const
+{
+    QByteArray states(h * w, 0);
+    for(int k = 0; k < h; k++){
+        for(int j = 0; j < w; j++){
+            states[k * w + j] = (char)cell(k, j);
+        }
+    }
+    return states;
+}
+
+void GenerationsEngine::setCellStates(const QByteArray &states)
+{
+    if(states.size() != h * w){
+        return;
+    }
+    for(int k = 0; k < h; k++){
+        for(int j = 0; j < w; j++){
+            setCell(k, j, states[k * w + j]);
+        }
+    }
+    lastChanged = 0;
+}
+
+
+//Stepping:
+void GenerationsEngine::buildLive()
+{
+    int per = 64 / bits;
+    quint64 low = lowBits(bits);
+    live.fill(0);
+    for(int k = 0; k < h; k++){
+        quint64 *row = live.data() + k * lpr;
+        const quint64 *packed = cells.constData() + k * wpr;
+        for(int p = 0; p < wpr; p++){
+            int j = p * per;
+            row[j / 64] |= compressLanes(zeroLanes(packed[p] ^ low, low, bits), bits) << (j % 64);
+        }
+    }
+}
+
+bool GenerationsEngine::step()
+{
+    if(h == 0 || w == 0){
+        return false;
+    }
+    buildLive();
+    //Counts that change something, as in EnsembleEngine.
+    bool born[9], survives[9];
+    int counts[9];
+    int nCounts = 0;
+    for(int c = 0; c <= (neigh == 'v' ? 4 : 8); c++){
+        born[c] = birth.contains(c);
+        survives[c] = survival.contains(c);
+        if(born[c] || survives[c]){ counts[nCounts++] = c; }
+    }
+    bool torus = edge == 't';
+    int per = 64 / bits;
+    quint64 low = lowBits(bits);
+    quint64 full = ((quint64)1 << bits) - 1; // lane low bits -> whole lanes
+    quint64 refractory = nStates > 2 ? low * 2 : 0; // where dying cells go
+    quint64 oldest = low * (nStates - 1);
+    quint64 tail = w % 64 ? ((quint64)1 << (w % 64)) - 1 : ~(quint64)0;
+    int edgeWord = (w - 1) / 64;
+    int edgeBit = (w - 1) % 64;
+    QVector<quint64> bornRow(lpr), surviveRow(lpr);
+    int n = 0;
+    for(int k = 0; k < h; k++){
+        const quint64 *rows[3];
+        rows[1] = live.constData() + k * lpr;
+        rows[0] = k > 0 ? rows[1] - lpr : (torus ? live.constData() + (h - 1) * lpr : zeros.constData());
+        rows[2] = k < h - 1 ? rows[1] + lpr : (torus ? live.constData() : zeros.constData());
+        //Live neighbour counts, 64 cells at a time.
+        for(int i = 0; i < lpr; i++){
+            quint64 s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+            for(int r = 0; r < 3; r++){
+                const quint64 *row = rows[r];
+                //West and east neighbours: the row shifted by one cell, across words and edges.
+                quint64 west = (row[i] << 1) | (i > 0 ? row[i - 1] >> 63 : (torus ? (row[edgeWord] >> edgeBit) & 1 : 0));
+                quint64 east = (row[i] >> 1) | (i < lpr - 1 ? row[i + 1] << 63 : (torus ? (row[0] & 1) << edgeBit : 0));
+                if(r != 1){
+                    addNeighbour(row[i], s0, s1, s2, s3);
+                }
+                if(r == 1 || neigh == 'm'){
+                    addNeighbour(west, s0, s1, s2, s3);
+                    addNeighbour(east, s0, s1, s2, s3);
+                }
+            }
+            quint64 b = 0, s = 0;
+            for(int c = 0; c < nCounts; c++){
+                int m = counts[c];
+                quint64 eq = (m & 1 ? s0 : ~s0) & (m & 2 ? s1 : ~s1) & (m & 4 ? s2 : ~s2) & (m & 8 ? s3 : ~s3);
+                if(born[m]){ b |= eq; }
+                if(survives[m]){ s |= eq; }
+            }
+            if(i == lpr - 1){
+                b &= tail;
+                s &= tail;
+            }
+            bornRow[i] = b;
+            surviveRow[i] = s;
+        }
+        //Transitions, a word of packed cells at a time.
+        const quint64 *cur = cells.constData() + k * wpr;
+        quint64 *out = next.data() + k * wpr;
+        for(int p = 0; p < wpr; p++){
+            int j = p * per;
+            quint64 x = cur[p];
+            quint64 b = spreadLanes(bornRow[j / 64] >> (j % 64), bits);
+            quint64 s = spreadLanes(surviveRow[j / 64] >> (j % 64), bits);
+            quint64 dead = zeroLanes(x, low, bits);
+            quint64 alive = zeroLanes(x ^ low, low, bits);
+            quint64 dying = ~((dead | alive | zeroLanes(x ^ oldest, low, bits)) * full); // states 2..n-2
+            quint64 y = (dead & b) | (alive & s) | ((alive & ~s) * full & refractory) | ((x & dying) + (low & dying));
+            out[p] = y;
+            n += qPopulationCount(~zeroLanes(x ^ y, low, bits) & low);
+        }
+    }
+    if(n == 0){
+        return false;
+    }
+    //next holds the new generation, the old one becomes the scratch buffer.
+    qSwap(cells, next);
+    lastChanged = n;
+    return true;
+}
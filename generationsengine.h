@@ -0,0 +1,84 @@
+#ifndef GENERATIONSENGINE_H
+#define GENERATIONSENGINE_H
+
+#include <QList>
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+#include "bitgrid.h"
+#include "cellbuffer.h"
+
+/**
+  *
+  * "Generations" automaton: cells have 2 to 16 states. 0 is dead, 1 is alive and follows the
+  * birth/survival counts of live neighbours; a live cell that doesn't survive goes through the
+  * refractory states 2, 3 ... states-1 (one per generation, ignoring its neighbours) back to 0.
+  * Cells are packed 2 bits each up to 4 states, 4 bits each above, each row padded to whole
+  * 64 bit words. A step extracts the live cells into a bit plane, counts neighbours with
+  * bit-sliced adders 64 cells at a time, and applies the transitions to a whole word of
+  * packed cells at once (SWAR lane compares and increments).
+  * Cells are addressed from (0,0), as in BitGrid.
+ */
+
+class GenerationsEngine
+{
+public:
+    enum { MaxStates = 16 };
+
+    explicit GenerationsEngine(int height = 50, int width = 50, MemoryUsage::Kind kind = MemoryUsage::Board); // kind: of the cells
+
+    int height() const;
+    int width() const;
+    void resize(int height, int width); // empties the universe
+
+    int states() const;
+    void setStates(int n); // 2..MaxStates, cells in a removed state become dead
+    int bitsPerCell() const; // 2 or 4
+    char neighMode() const; // 'm': moore, 'v': von neumann
+    void setNeighMode(char mode);
+    char edgeMode() const; // 't': toroidal, 'p': bounded plane
+    void setEdgeMode(char mode);
+    QList<int> birthStates() const;
+    void setBirthStates(const QList<int> &states);
+    QList<int> survivalStates() const;
+    void setSurvivalStates(const QList<int> &states);
+    bool setRule(const QString &rule); // "B2/S/C3" or Golly's "/2/3" (S/B/C)
+    QString rule() const; // "B2/S/C3"
+    static bool parseRule(const QString &rule, QList<int> &birth, QList<int> &survival, int &states);
+
+    int cell(int k, int j) const; // state
+    void setCell(int k, int j, int state);
+    void clear();
+    int population() const; // live cells (state 1)
+    int changed() const; // cells changed by the last step
+
+    BitGrid board() const; // live cells
+    void setBoard(const BitGrid &board); // same size only, live cells in state 1, others dead
+    void toUniverse(bool **universe) const; // live cells -> map[1..h][1..w]
+    QByteArray cellStates() const; // one byte per cell, row major
+    void setCellStates(const QByteArray &cells); // same size only
+
+    bool step(); // one generation, false (and nothing done) if no cell would change
+
+private:
+    int h;
+    int w;
+    int nStates;
+    int bits; // per cell
+    int wpr; // packed words per row
+    int lpr; // live plane words per row
+    char neigh;
+    char edge;
+    QList<int> birth;
+    QList<int> survival;
+    int lastChanged;
+    CellBuffer<quint64> cells; // packed states
+    CellBuffer<quint64> next; // packed states
+    CellBuffer<quint64> live; // bit plane of the live cells
+    CellBuffer<quint64> zeros; // dead row beyond a bounded plane
+
+    void repack(int newBits); // change the cell width, keeping the states
+    void buildLive();
+};
+
+#endif // GENERATIONSENGINE_H
@@ -0,0 +1,158 @@
+#include "gifwriter.h"
+
+
+//Constructor:
+GifWriter::GifWriter() :
+    dev(0),
+    w(0),
+    h(0),
+    minCodeSize(2),
+    acc(0),
+    accBits(0)
+{
+}
+
+
+//Stream:
+void GifWriter::put16(int v)
+{
+    char b[2] = { char(v & 0xff), char((v >> 8) & 0xff) };
+    dev->write(b, 2);
+}
+
+bool GifWriter::begin(QIODevice *device, int width, int height, const QVector<QRgb> &palette)
+{
+    if(!device || !device->isWritable() || width <= 0 || height <= 0 || width > 0xffff || height > 0xffff
+            || palette.isEmpty() || palette.size() > 256){
+        return false;
+    }
+    dev = device;
+    w = width;
+    h = height;
+    int bits = 1;
+    while((1 << bits) < palette.size()){ bits++; }
+    minCodeSize = qMax(2, bits);
+
+    dev->write("GIF89a", 6);
+    put16(w);
+    put16(h);
+    dev->putChar(char(0x80 | ((bits - 1) << 4) | (bits - 1))); //Global colour table of 2^bits entries.
+    dev->putChar(0); //Background colour index.
+    dev->putChar(0); //Pixel aspect ratio.
+    for(int i = 0; i < (1 << bits); i++){
+        QRgb c = i < palette.size() ? palette[i] : qRgb(0, 0, 0);
+        dev->putChar(char(qRed(c)));
+        dev->putChar(char(qGreen(c)));
+        dev->putChar(char(qBlue(c)));
+    }
+    //NETSCAPE2.0 extension: loop forever.
+    dev->write("\x21\xff\x0bNETSCAPE2.0\x03\x01", 16);
+    put16(0);
+    dev->putChar(0);
+    return true;
+}
+
+bool GifWriter::addFrame(const QImage &frame, int delayMs)
+{
+    if(!dev || frame.format() != QImage::Format_Indexed8 || frame.width() != w || frame.height() != h){
+        return false;
+    }
+    //Graphic control extension: delay in 1/100 s.
+    dev->write("\x21\xf9\x04\x00", 4);
+    put16(qMax(2, (delayMs + 5) / 10)); //Most viewers treat delays under 2 as 10.
+    dev->putChar(0);
+    dev->putChar(0);
+    //Image descriptor: the whole screen, no local colour table.
+    dev->putChar(0x2c);
+    put16(0);
+    put16(0);
+    put16(w);
+    put16(h);
+    dev->putChar(0);
+    writeImageData(frame);
+    return true;
+}
+
+bool GifWriter::end()
+{
+    if(!dev){
+        return false;
+    }
+    dev->putChar(0x3b);
+    dev = 0;
+    return true;
+}
+
+
+//LZW:
+void GifWriter::putCode(int code, int size)
+{
+    acc |= (quint32)code << accBits;
+    accBits += size;
+    while(accBits >= 8){
+        block.append(char(acc & 0xff));
+        acc >>= 8;
+        accBits -= 8;
+        if(block.size() == 255){
+            dev->putChar(char(255));
+            dev->write(block);
+            block.clear();
+        }
+    }
+}
+
+void GifWriter::writeImageData(const QImage &frame)
+/**
+  Variable length LZW, codes packed from the least significant bit, output in sub-blocks of 255 bytes.
+  The dictionary is a tree: next[code * symbols + pixel] is the code of the string code+pixel, 0 if unknown.
+*/
+{
+    const int symbols = 1 << minCodeSize;
+    const int clearCode = symbols;
+    const int endCode = symbols + 1;
+    QVector<quint16> next(4096 * symbols, 0);
+    int codeSize = minCodeSize + 1;
+    int maxCode = endCode;
+
+    block.clear();
+    acc = 0;
+    accBits = 0;
+    dev->putChar(char(minCodeSize));
+    putCode(clearCode, codeSize);
+    int current = -1;
+    for(int k = 0; k < h; k++){
+        const uchar *line = frame.constScanLine(k);
+        for(int j = 0; j < w; j++){
+            int pixel = line[j] & (symbols - 1);
+            if(current < 0){
+                current = pixel;
+            } else if(next[current * symbols + pixel]){
+                current = next[current * symbols + pixel];
+            } else {
+                putCode(current, codeSize);
+                next[current * symbols + pixel] = ++maxCode;
+                if(maxCode >= (1 << codeSize)){
+                    codeSize++;
+                }
+                if(maxCode == 4095){ //Dictionary full: start over.
+                    putCode(clearCode, codeSize);
+                    next.fill(0);
+                    codeSize = minCodeSize + 1;
+                    maxCode = endCode;
+                }
+                current = pixel;
+            }
+        }
+    }
+    putCode(current, codeSize);
+    putCode(clearCode, codeSize);
+    putCode(endCode, minCodeSize + 1);
+    if(accBits > 0){
+        putCode(0, 8 - accBits); //Pad the last byte.
+    }
+    if(!block.isEmpty()){
+        dev->putChar(char(block.size()));
+        dev->write(block);
+    }
+    dev->putChar(0); //Block terminator.
+}
@@ -0,0 +1,39 @@
+#ifndef GIFWRITER_H
+#define GIFWRITER_H
+
+#include <QIODevice>
+#include <QColor>
+#include <QVector>
+#include <QImage>
+
+/**
+  *
+  * Minimal animated GIF89a encoder (Qt reads GIFs but can't write them).
+  * Frames are 8 bit indexed images of the same size, sharing a global palette of
+  * at most 256 colours; the animation loops forever.
+ */
+
+class GifWriter
+{
+public:
+    GifWriter();
+
+    bool begin(QIODevice *device, int width, int height, const QVector<QRgb> &palette);
+    bool addFrame(const QImage &frame, int delayMs); // Format_Indexed8, width x height
+    bool end();
+
+private:
+    QIODevice *dev;
+    int w;
+    int h;
+    int minCodeSize; // LZW root code size, log2 of the palette size (at least 2)
+    QByteArray block; // sub-block being filled
+    quint32 acc; // bits not yet written
+    int accBits;
+
+    void put16(int v);
+    void putCode(int code, int size);
+    void writeImageData(const QImage &frame);
+};
+
+#endif // GIFWRITER_H
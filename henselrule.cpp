@@ -0,0 +1,125 @@
+#include "henselrule.h"
+
+//Canonical configurations of 1 to 4 live neighbours, in the letter order of letters().
+static const int canonical1[2] = { 0x02, 0x01 };
+static const int canonical2[6] = { 0x0A, 0x05, 0x09, 0x03, 0x11, 0x22 };
+static const int canonical3[10] = { 0x2A, 0x45, 0x25, 0x07, 0x83, 0x0B, 0x29, 0x23, 0x43, 0x13 };
+static const int canonical4[13] = { 0xAA, 0x55, 0x4B, 0x0F, 0x1B, 0x8B, 0x2B, 0x27, 0x53, 0x17, 0x93, 0x63, 0x33 };
+
+static int bitCount(int mask)
+{
+    int n = 0;
+    for(; mask; mask >>= 1){ n += mask & 1; }
+    return n;
+}
+
+
+QString HenselRule::letters(int count)
+{
+    switch(count){
+    case 1: case 7: return "ce";
+    case 2: case 6: return "cekain";
+    case 3: case 5: return "cekainyqjr";
+    case 4: return "cekainyqjrtwz";
+    default: return "";
+    }
+}
+
+int HenselRule::canonical(int count, QChar letter)
+{
+    int i = letters(count).indexOf(letter);
+    if(i < 0){
+        return -1;
+    }
+    if(count > 4){
+        return ~canonical(8 - count, letter) & 0xFF; //Complement of 8 - count.
+    }
+    switch(count){
+    case 1: return canonical1[i];
+    case 2: return canonical2[i];
+    case 3: return canonical3[i];
+    default: return canonical4[i];
+    }
+}
+
+void HenselRule::addOrbit(int mask, QVector<bool> &masks, bool value)
+{
+    //Rotations by a quarter turn move every neighbour two places clockwise,
+    //the mirror swaps east and west (bit i <-> bit 8 - i).
+    for(int mirror = 0; mirror < 2; mirror++){
+        int m = mask;
+        if(mirror){
+            m = 0;
+            for(int i = 0; i < 8; i++){
+                if(mask & (1 << i)){ m |= 1 << ((8 - i) % 8); }
+            }
+        }
+        for(int turn = 0; turn < 4; turn++){
+            masks[m] = value;
+            m = ((m << 2) | (m >> 6)) & 0xFF;
+        }
+    }
+}
+
+bool HenselRule::expand(const QString &conditions, QVector<bool> &masks)
+{
+    masks.fill(false, 256);
+    int i = 0;
+    while(i < conditions.size()){
+        QChar c = conditions[i++];
+        if(c.isSpace() || c == ','){
+            continue;
+        }
+        if(!c.isDigit() || c.digitValue() > 8){
+            return false;
+        }
+        int count = c.digitValue();
+        bool exclude = i < conditions.size() && conditions[i] == '-';
+        if(exclude){ i++; }
+        QString chosen;
+        while(i < conditions.size() && conditions[i].isLetter()){
+            QChar l = conditions[i++].toLower();
+            if(!letters(count).contains(l)){
+                return false;
+            }
+            chosen += l;
+        }
+        if(chosen.isEmpty() || exclude){
+            for(int m = 0; m < 256; m++){
+                if(bitCount(m) == count){ masks[m] = true; }
+            }
+        }
+        foreach(QChar l, chosen){
+            addOrbit(canonical(count, l), masks, !exclude);
+        }
+    }
+    return true;
+}
+
+bool HenselRule::isValid(const QString &conditions)
+{
+    QVector<bool> masks;
+    return expand(conditions, masks);
+}
+
+QList<int> HenselRule::counts(const QString &conditions)
+{
+    QList<int> list;
+    QVector<bool> masks;
+    if(!expand(conditions, masks)){
+        return list;
+    }
+    for(int m = 0; m < 256; m++){
+        if(masks[m] && !list.contains(bitCount(m))){ list << bitCount(m); }
+    }
+    qSort(list);
+    return list;
+}
+
+bool HenselRule::isTotalistic(const QString &conditions)
+{
+    foreach(QChar c, conditions){
+        if(c.isLetter() || c == '-'){ return false; }
+    }
+    return true;
+}
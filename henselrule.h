@@ -0,0 +1,36 @@
+#ifndef HENSELRULE_H
+#define HENSELRULE_H
+
+#include <QString>
+#include <QList>
+#include <QVector>
+
+/**
+  *
+  * Isotropic non-totalistic conditions in Hensel notation, e.g. "2-a" or "1e2ci3".
+  * Each neighbour count may be followed by letters naming configurations of that many
+  * live neighbours (up to rotation and reflection), or by '-' and the letters to exclude;
+  * a count alone means every configuration. Plain "23" is the outer-totalistic case.
+  *   1, 7: c e
+  *   2, 6: c e k a i n
+  *   3, 5: c e k a i n y q j r
+  *   4:    c e k a i n y q j r t w z
+  * Letters of 5 to 7 name the complements of those of 3 to 1.
+  * Neighbour masks have bit 0 for N, then clockwise: NE, E, SE, S, SW, W, NW.
+ */
+
+class HenselRule
+{
+public:
+    static bool expand(const QString &conditions, QVector<bool> &masks); // 256 masks -> condition met, false if invalid
+    static bool isValid(const QString &conditions);
+    static QList<int> counts(const QString &conditions); // neighbour counts with at least one configuration
+    static bool isTotalistic(const QString &conditions); // digits only
+    static QString letters(int count); // letters allowed after a count
+
+private:
+    static int canonical(int count, QChar letter); // one mask of the configuration, -1 if none
+    static void addOrbit(int mask, QVector<bool> &masks, bool value); // mask under the 8 symmetries
+};
+
+#endif // HENSELRULE_H
@@ -0,0 +1,1030 @@
+#include <cstring>
+#include <QFuture>
+#include <QThread>
+#include <QStringList>
+#include <QtConcurrentRun>
+#include "lifeengine.h"
+#include "henselrule.h"
+
+
+//Constructor:
+LifeEngine::LifeEngine(int height, int width, MemoryUsage::Kind kind) :
+    h(height),
+    w(width),
+    universe(height, width, kind),
+    next(height, width, MemoryUsage::Scratch),
+    neigh('m'),
+    edge('p'),
+    threads(QThread::idealThreadCount()),
+    lastChanged(0),
+    bornText("3"),
+    surviveText("23"),
+    tableDirty(true),
+    rad(1),
+    middle(false),
+    padded(MemoryUsage::Scratch),
+    sumA(MemoryUsage::Scratch),
+    sumB(MemoryUsage::Scratch),
+    nStates(2),
+    gens(0, 0, kind),
+    symmetryGroup(Soup::C1),
+    active(Soup::C1),
+    symmetryDirty(true)
+{
+    birth << 3;
+    survival << 2 << 3;
+}
+
+
+//Maps:
+int LifeEngine::height() const
+{
+    return h;
+}
+
+int LifeEngine::width() const
+{
+    return w;
+}
+
+void LifeEngine::resize(int height, int width)
+{
+    h = height;
+    w = width;
+    universe.resize(h, w);
+    next.resize(h, w);
+    padded.clear(); //Tables of the old size, made again by the next step.
+    sumA.clear();
+    sumB.clear();
+    lastChanged = 0;
+    symmetryDirty = true;
+    if(nStates > 2){
+        gens.resize(h, w);
+    }
+}
+
+
+//Rules:
+char LifeEngine::neighMode() const
+{
+    return neigh;
+}
+
+void LifeEngine::setNeighMode(char mode)
+{
+    neigh = mode;
+    tableDirty = true;
+}
+
+char LifeEngine::edgeMode() const
+{
+    return edge;
+}
+
+void LifeEngine::setEdgeMode(char mode)
+{
+    edge = mode;
+}
+
+QList<int> LifeEngine::birthStates() const
+{
+    return birth;
+}
+
+void LifeEngine::setBirthStates(const QList<int> &states)
+{
+    birth = states;
+    QList<int> sorted = states;
+    qSort(sorted);
+    bornText = statesText(sorted, false);
+    tableDirty = true;
+}
+
+QList<int> LifeEngine::survivalStates() const
+{
+    return survival;
+}
+
+void LifeEngine::setSurvivalStates(const QList<int> &states)
+{
+    survival = states;
+    QList<int> sorted = states;
+    qSort(sorted);
+    surviveText = statesText(sorted, false);
+    tableDirty = true;
+}
+
+QString LifeEngine::birthConditions() const
+{
+    return rad > 1 ? statesText(birth, true) : bornText;
+}
+
+bool LifeEngine::setBirthConditions(const QString &text)
+{
+    if(rad > 1){
+        birth = parseStates(text, true);
+        return true;
+    }
+    if(!HenselRule::isValid(text)){
+        return false;
+    }
+    bornText = text.simplified().remove(' ').toLower();
+    birth = HenselRule::counts(bornText);
+    tableDirty = true;
+    return true;
+}
+
+QString LifeEngine::survivalConditions() const
+{
+    return rad > 1 ? statesText(survival, true) : surviveText;
+}
+
+bool LifeEngine::setSurvivalConditions(const QString &text)
+{
+    if(rad > 1){
+        survival = parseStates(text, true);
+        return true;
+    }
+    if(!HenselRule::isValid(text)){
+        return false;
+    }
+    surviveText = text.simplified().remove(' ').toLower();
+    survival = HenselRule::counts(surviveText);
+    tableDirty = true;
+    return true;
+}
+
+int LifeEngine::radius() const
+{
+    return rad;
+}
+
+void LifeEngine::setRadius(int r)
+{
+    rad = qBound(1, r, (int)MaxRadius);
+}
+
+bool LifeEngine::middleCounted() const
+{
+    return middle;
+}
+
+void LifeEngine::setMiddleCounted(bool counted)
+{
+    middle = counted;
+}
+
+int LifeEngine::states() const
+{
+    return nStates;
+}
+
+void LifeEngine::setStates(int n)
+{
+    n = qBound(2, n, (int)GenerationsEngine::MaxStates);
+    int old = nStates;
+    nStates = n;
+    symmetryDirty = true;
+    if(n > 2 && old <= 2){
+        gens.resize(h, w);
+        gens.setStates(n);
+        syncStates();
+    } else if(n > 2){
+        gens.setStates(n); //Cells in a removed state die.
+        gens.toUniverse(universe.rows());
+    } else {
+        gens.resize(0, 0); //The map alone holds the cells.
+    }
+}
+
+bool LifeEngine::parseRule(const QString &rule, QList<int> &b, QList<int> &s)
+{
+    QString r = rule.trimmed().toUpper();
+    b.clear();
+    s.clear();
+    if(r.contains('|')){
+        //.laut notation: birth|survival.
+        QStringList parts = r.split('|');
+        if(parts.size() < 2){
+            return false;
+        }
+        for(int i = 0; i < parts[0].size(); i++){
+            if(!parts[0][i].isDigit()){ return false; }
+            b << parts[0][i].digitValue();
+        }
+        for(int i = 0; i < parts[1].size(); i++){
+            if(!parts[1][i].isDigit()){ return false; }
+            s << parts[1][i].digitValue();
+        }
+        return true;
+    }
+    //B/S notation.
+    QList<int> *target = 0;
+    for(int i = 0; i < r.size(); i++){
+        QChar c = r[i];
+        if(c == 'B'){ target = &b; }
+        else if(c == 'S'){ target = &s; }
+        else if(c == '/'){ continue; }
+        else if(c.isDigit() && c.digitValue() <= 8 && target){ target->append(c.digitValue()); }
+        else { return false; }
+    }
+    return r.contains('B') && r.contains('S');
+}
+
+bool LifeEngine::parseConditions(const QString &rule, QString &b, QString &s)
+{
+    //As parseRule(), but the Hensel letters and '-' are kept (none of them is a B or an S).
+    QString r = rule.trimmed();
+    b.clear();
+    s.clear();
+    if(r.contains('|')){
+        QStringList parts = r.split('|');
+        if(parts.size() < 2){
+            return false;
+        }
+        b = parts[0].toLower();
+        s = parts[1].toLower();
+    } else {
+        QString *target = 0;
+        foreach(QChar c, r){
+            QChar u = c.toUpper();
+            if(u == 'B'){ target = &b; }
+            else if(u == 'S'){ target = &s; }
+            else if(c == '/'){ continue; }
+            else if(target){ target->append(c.toLower()); }
+            else { return false; }
+        }
+        if(!r.contains('B', Qt::CaseInsensitive) || !r.contains('S', Qt::CaseInsensitive)){
+            return false;
+        }
+    }
+    return HenselRule::isValid(b) && HenselRule::isValid(s);
+}
+
+bool LifeEngine::parseWideRule(const QString &rule, QList<int> &b, QList<int> &s,
+                               int &r, bool &m, char &n)
+{
+    //"R5,C0,M1,S34..58,B34..45,NM" (LtL) or "R5,C2,S34-58,B34-45,NN" (HROT), lists allowed:
+    //fields without a letter continue the last S or B field.
+    QString text = rule.trimmed().toUpper();
+    if(!text.startsWith('R')){
+        return false;
+    }
+    b.clear();
+    s.clear();
+    r = 1;
+    m = false;
+    n = 'm';
+    QList<int> *target = 0;
+    foreach(QString field, text.split(',')){
+        field = field.trimmed();
+        if(field.isEmpty()){ continue; }
+        QChar key = field[0];
+        if(key.isLetter()){
+            field = field.mid(1);
+            target = 0;
+        }
+        if(key == 'R'){
+            r = field.toInt();
+        } else if(key == 'C'){
+            if(field.toInt() > 2){ return false; } //Multi-state rules are not life-like.
+        } else if(key == 'M'){
+            m = field.toInt() != 0;
+        } else if(key == 'N'){
+            if(field == "M"){ n = 'm'; }
+            else if(field == "N"){ n = 'v'; }
+            else { return false; }
+        } else if(key == 'S' || key == 'B' || key.isDigit()){
+            if(key == 'S'){ target = &s; }
+            if(key == 'B'){ target = &b; }
+            if(!target){ return false; }
+            if(!field.isEmpty()){ *target += parseStates(field, true); }
+        } else {
+            return false;
+        }
+    }
+    return r >= 1 && r <= MaxRadius;
+}
+
+QList<int> LifeEngine::parseStates(const QString &text, bool ranges)
+{
+    QList<int> states;
+    if(!ranges){
+        foreach(QChar c, text){
+            if(c.isDigit() && !states.contains(c.digitValue())){ states << c.digitValue(); }
+        }
+    } else {
+        foreach(QString item, text.split(',', QString::SkipEmptyParts)){
+            QStringList bounds = item.contains("..") ? item.split("..") : item.split('-');
+            bool ok1, ok2 = true;
+            int from = bounds[0].toInt(&ok1);
+            int to = bounds.size() > 1 ? bounds[1].toInt(&ok2) : from;
+            if(!ok1 || !ok2){ continue; }
+            for(int c = from; c <= to; c++){
+                if(!states.contains(c)){ states << c; }
+            }
+        }
+    }
+    qSort(states);
+    return states;
+}
+
+QString LifeEngine::statesText(const QList<int> &states, bool ranges)
+{
+    QString text;
+    if(!ranges){
+        foreach(int c, states){ text += QString::number(c); }
+        return text;
+    }
+    //Consecutive counts as "a-b".
+    for(int i = 0; i < states.size(); i++){
+        int last = i;
+        while(last + 1 < states.size() && states[last + 1] == states[last] + 1){ last++; }
+        if(!text.isEmpty()){ text += ","; }
+        text += QString::number(states[i]);
+        if(last > i){ text += "-" + QString::number(states[last]); }
+        i = last;
+    }
+    return text;
+}
+
+bool LifeEngine::setRule(const QString &rule)
+{
+    QList<int> b, s;
+    int r;
+    bool m;
+    char n;
+    QString bText, sText;
+    if(GenerationsEngine::parseRule(rule, b, s, r)){
+        rad = 1;
+        setBirthStates(b);
+        setSurvivalStates(s);
+        setStates(r);
+        return true;
+    }
+    if(parseWideRule(rule, b, s, r, m, n)){
+        setStates(2);
+        rad = r;
+        middle = m;
+        neigh = n;
+        birth = b;
+        survival = s;
+        tableDirty = true;
+        return true;
+    }
+    if(!parseConditions(rule, bText, sText)){
+        return false;
+    }
+    rad = 1;
+    setStates(2);
+    setBirthConditions(bText);
+    setSurvivalConditions(sText);
+    return true;
+}
+
+QString LifeEngine::rule() const
+{
+    if(rad > 1){
+        QString r = QString("R%1,C0,M%2,S").arg(rad).arg(middle ? 1 : 0);
+        r += statesText(survival, true).replace("-", "..");
+        r += ",B" + statesText(birth, true).replace("-", "..");
+        r += neigh == 'v' ? ",NN" : ",NM";
+        return r;
+    }
+    if(nStates > 2){
+        return "B" + bornText + "/S" + surviveText + "/C" + QString::number(nStates);
+    }
+    return "B" + bornText + "/S" + surviveText;
+}
+
+int LifeEngine::threadCount() const
+{
+    return threads;
+}
+
+void LifeEngine::setThreadCount(int n)
+{
+    threads = qMax(1, n);
+}
+
+
+//Cells:
+bool LifeEngine::cell(int k, int j) const
+{
+    return universe[k][j];
+}
+
+void LifeEngine::setCell(int k, int j, bool alive)
+{
+    universe[k][j] = alive;
+    symmetryDirty = true;
+    if(nStates > 2){
+        gens.setCell(k - 1, j - 1, alive ? 1 : 0);
+    }
+}
+
+int LifeEngine::state(int k, int j) const
+{
+    return nStates > 2 ? gens.cell(k - 1, j - 1) : universe[k][j];
+}
+
+void LifeEngine::setState(int k, int j, int s)
+{
+    if(nStates > 2){
+        gens.setCell(k - 1, j - 1, s);
+    }
+    universe[k][j] = s == 1;
+    symmetryDirty = true;
+}
+
+const GenerationsEngine &LifeEngine::generations() const
+{
+    return gens;
+}
+
+QByteArray LifeEngine::cellStates() const
+{
+    if(nStates > 2){
+        return gens.cellStates();
+    }
+    QByteArray cells(h * w, 0);
+    for(int k = 1; k <= h; k++){
+        for(int j = 1; j <= w; j++){
+            cells[(k - 1) * w + j - 1] = universe[k][j];
+        }
+    }
+    return cells;
+}
+
+void LifeEngine::setCellStates(const QByteArray &cells)
+{
+    if(cells.size() != h * w){
+        return;
+    }
+    for(int k = 1; k <= h; k++){
+        for(int j = 1; j <= w; j++){
+            setState(k, j, cells[(k - 1) * w + j - 1]);
+        }
+    }
+}
+
+void LifeEngine::syncStates()
+{
+    if(nStates > 2){
+        gens.setBoard(board());
+    }
+}
+
+bool **LifeEngine::map()
+{
+    return universe.rows();
+}
+
+void LifeEngine::clear()
+{
+    universe.clear();
+    syncStates();
+}
+
+void LifeEngine::invert()
+{
+    for(int k = 1; k <= h; k++){
+     for(int j = 1; j <= w; j++){
+         universe[k][j] = !universe[k][j];
+     }
+    }
+    syncStates(); //Refractory cells die.
+}
+
+int LifeEngine::population() const
+{
+    int n = 0;
+    for(int k = 1; k <= h; k++) {
+        for(int j = 1; j <= w; j++) {
+            n += universe[k][j];
+        }
+    }
+    return n;
+}
+
+int LifeEngine::changed() const
+{
+    return lastChanged;
+}
+
+QString LifeEngine::dump() const
+{
+    char temp;
+    QString master = "";
+    for(int k = 1; k <= h; k++) {
+        for(int j = 1; j <= w; j++) {
+            int s = state(k, j);
+            if(s > 1) {
+                temp = 'A' + s - 1; //Letters of the RLE states.
+            } else if(s == 1) {
+                temp = '*';
+            } else {
+                temp = 'o';
+            }
+            master.append(temp);
+        }
+        master.append("\n");
+    }
+    return master;
+}
+
+void LifeEngine::setDump(const QString &data)
+{
+    int current = 0;
+    for(int k = 1; k <= h; k++) {
+        for(int j = 1; j <= w; j++) {
+            QChar c = current < data.size() ? data[current] : QChar('o');
+            if(c >= 'B' && c <= 'P'){
+                setState(k, j, c.unicode() - 'A' + 1);
+            } else {
+                setState(k, j, c == '*' ? 1 : 0);
+            }
+            current++;
+        }
+        current++;
+    }
+}
+
+BitGrid LifeEngine::board() const
+{
+    return BitGrid::fromUniverse(universe.rows(), h, w);
+}
+
+void LifeEngine::setBoard(const BitGrid &board)
+{
+    if(board.height() == h && board.width() == w){
+        board.toUniverse(universe.rows());
+        symmetryDirty = true;
+        syncStates();
+    }
+}
+
+BitGrid LifeEngine::region(int top, int left, int height, int width) const
+{
+    //Only the rows and columns of the rectangle are read.
+    BitGrid out(qMax(0, height), qMax(0, width));
+    int k0 = qMax(0, -top), k1 = qMin(out.height(), h - top);
+    int j0 = qMax(0, -left), j1 = qMin(out.width(), w - left);
+    for(int k = k0; k < k1; k++){
+        const bool *line = universe[top + k + 1] + left + 1;
+        quint64 *row = out.row(k);
+        for(int j = j0; j < j1; j++){
+            row[j >> 6] |= (quint64)line[j] << (j & 63);
+        }
+    }
+    return out;
+}
+
+void LifeEngine::setRegion(int top, int left, const BitGrid &cells, BitGrid::Merge mode)
+{
+    BitGrid now = cells;
+    if(mode != BitGrid::Replace){
+        now = region(top, left, cells.height(), cells.width());
+        now.blit(cells, 0, 0, mode);
+    }
+    int k0 = qMax(0, -top), k1 = qMin(now.height(), h - top);
+    int j0 = qMax(0, -left), j1 = qMin(now.width(), w - left);
+    for(int k = k0; k < k1; k++){
+        bool *line = universe[top + k + 1] + left + 1;
+        const quint64 *row = now.row(k);
+        for(int j = j0; j < j1; j++){
+            bool alive = (row[j >> 6] >> (j & 63)) & 1;
+            if(nStates > 2 && alive != line[j]){
+                gens.setCell(top + k, left + j, alive ? 1 : 0);
+            }
+            line[j] = alive;
+        }
+    }
+    symmetryDirty = true;
+}
+
+
+//Symmetry:
+static bool within(Soup::Symmetry group, Soup::Symmetry of)
+{
+    //D8 holds every other group, C4 and D4 hold C2.
+    return group == of || of == Soup::D8 || group == Soup::C1 || (group == Soup::C2 && of != Soup::C1);
+}
+
+Soup::Symmetry LifeEngine::symmetry() const
+{
+    return symmetryGroup;
+}
+
+void LifeEngine::setSymmetry(Soup::Symmetry group)
+{
+    symmetryGroup = group;
+    symmetryDirty = true;
+}
+
+Soup::Symmetry LifeEngine::activeSymmetry()
+{
+    if(symmetryDirty){
+        //Largest groups first, C4 and D4 both save three quarters of the cells.
+        static const Soup::Symmetry order[] = { Soup::D8, Soup::C4, Soup::D4, Soup::C2 };
+        active = Soup::C1;
+        for(int i = 0; i < 4 && active == Soup::C1; i++){
+            if(within(order[i], symmetryGroup) && hasSymmetry(order[i])){
+                active = order[i];
+            }
+        }
+        symmetryDirty = false;
+    }
+    return nStates > 2 ? Soup::C1 : active;
+}
+
+bool LifeEngine::hasSymmetry(Soup::Symmetry group) const
+{
+    if((group == Soup::C4 || group == Soup::D8) && h != w){
+        return false;
+    }
+    for(int k = 1; k <= h; k++){
+        for(int j = 1; j <= w; j++){
+            bool alive = universe[k][j];
+            switch(group){
+            case Soup::C2:
+                if(universe[h + 1 - k][w + 1 - j] != alive){ return false; }
+                break;
+            case Soup::C4:
+                if(universe[j][w + 1 - k] != alive){ return false; } //Quarter turn.
+                break;
+            case Soup::D4:
+                if(universe[k][w + 1 - j] != alive || universe[h + 1 - k][j] != alive){ return false; }
+                break;
+            case Soup::D8:
+                if(universe[j][k] != alive || universe[k][w + 1 - j] != alive || universe[h + 1 - k][j] != alive){ return false; }
+                break;
+            default:
+                return true;
+            }
+        }
+    }
+    return true;
+}
+
+void LifeEngine::domainColumns(int k, int &first, int &last) const
+{
+    first = 1;
+    last = w;
+    if(active == Soup::C4 || active == Soup::D4 || active == Soup::D8){
+        last = (w + 1) / 2; //Top-left quarter.
+    }
+    if(active == Soup::D8){
+        first = k; //On and above the diagonal.
+    }
+}
+
+static int differences(const bool *a, const bool *b, int count)
+{
+    //Cells are 0 or 1 bytes: the XOR of 8 of them has one bit set per changed cell.
+    int n = 0;
+    int i = 0;
+    for(; i + 8 <= count; i += 8){
+        quint64 x, y;
+        memcpy(&x, a + i, 8);
+        memcpy(&y, b + i, 8);
+        n += qPopulationCount(x ^ y);
+    }
+    for(; i < count; i++){
+        n += a[i] != b[i];
+    }
+    return n;
+}
+
+int LifeEngine::completeDomain()
+{
+    //next[] holds the domain: the rest is turned or mirrored from it, the changed cells counted
+    //against the current generation.
+    int half = (h + 1) / 2;
+    int halfW = (w + 1) / 2;
+    int n = 0;
+    if(active == Soup::D8){
+        for(int k = 2; k <= half; k++){
+            for(int j = 1; j < k; j++){
+                next[k][j] = next[j][k]; //Below the diagonal.
+            }
+            n += differences(next[k] + 1, universe[k] + 1, k - 1);
+        }
+    }
+    if(active != Soup::C2){
+        //Top-right quarter: from a quarter turn (C4) or the mirror of the top-left one.
+        for(int k = 1; k <= half; k++){
+            bool *out = next[k];
+            for(int j = halfW + 1; j <= w; j++){
+                out[j] = active == Soup::C4 ? next[w + 1 - j][k] : out[w + 1 - j];
+            }
+            n += differences(out + halfW + 1, universe[k] + halfW + 1, w - halfW);
+        }
+    }
+    //Bottom half: half turn of the top (C2, C4) or its mirror (D4, D8).
+    bool turn = active == Soup::C2 || active == Soup::C4;
+    for(int k = half + 1; k <= h; k++){
+        const bool *src = next[h + 1 - k];
+        bool *out = next[k];
+        if(turn){
+            for(int j = 1; j <= w; j++){
+                out[j] = src[w + 1 - j];
+            }
+        } else {
+            memcpy(out + 1, src + 1, w);
+        }
+        n += differences(out + 1, universe[k] + 1, w);
+    }
+    return n;
+}
+
+
+//Stepping:
+bool LifeEngine::step()
+{
+    if(nStates > 2){
+        //The rule is handed over at each step, it is only read there.
+        gens.setNeighMode(neigh);
+        gens.setEdgeMode(edge);
+        gens.setBirthStates(birth);
+        gens.setSurvivalStates(survival);
+        if(!gens.step()){
+            return false;
+        }
+        gens.toUniverse(universe.rows());
+        lastChanged = gens.changed();
+        return true;
+    }
+    //Under a symmetry only the rows of the fundamental domain are stepped.
+    int rows = activeSymmetry() == Soup::C1 ? h : (h + 1) / 2;
+    //Bands are only worth their scheduling on large universes.
+    int bands = (threads > 1 && (qint64)rows * w >= 128 * 128) ? qMin(threads, rows) : 1;
+    if(rad > 1){
+        prepareWide(); //Read only from the bands.
+    } else {
+        if(!padded.isEmpty()){
+            padded.clear(); //Tables of a previous radius > 1 rule.
+            sumA.clear();
+            sumB.clear();
+        }
+        if(tableDirty){
+            buildTable();
+        }
+        fillBorder();
+    }
+    QList< QFuture<int> > jobs;
+    for(int i = 0; i < bands - 1; i++){
+        jobs << QtConcurrent::run(this, &LifeEngine::stepRows, 1 + rows * i / bands, rows * (i + 1) / bands);
+    }
+    int n = stepRows(1 + rows * (bands - 1) / bands, rows); //Last band on this thread.
+    for(int i = 0; i < jobs.size(); i++){
+        n += jobs[i].result();
+    }
+    if(active != Soup::C1){
+        n += completeDomain();
+    }
+    if(n == 0){
+        return false;
+    }
+    //next[] holds the new generation, the old one becomes the scratch map.
+    universe.swap(next);
+    lastChanged = n;
+    return true;
+}
+
+bool LifeEngine::stepReference()
+{
+    //The original stepping, kept as the definition the fast kernels are verified against.
+    if(rad > 1 || nStates > 2 || !HenselRule::isTotalistic(bornText) || !HenselRule::isTotalistic(surviveText)){
+        return false;
+    }
+    fillBorder(); //isAlive() wraps by itself, but reads the buffer zone of a bounded plane.
+    int n = 0;
+    for(int k = 1; k <= h; k++){
+        for(int j = 1; j <= w; j++){
+            next[k][j] = isAlive(k, j);
+            n += next[k][j] != universe[k][j];
+        }
+    }
+    if(n == 0){
+        return false;
+    }
+    universe.swap(next);
+    lastChanged = n;
+    return true;
+}
+
+int LifeEngine::stepRows(int first, int last)
+{
+    if(rad > 1){
+        return stepRowsWide(first, last);
+    }
+    const char *t = table.constData();
+    int n = 0;
+    for(int k = first; k <= last; k++) {
+        const bool *a = universe[k - 1];
+        const bool *m = universe[k];
+        const bool *b = universe[k + 1];
+        bool *out = next[k];
+        int from, to;
+        domainColumns(k, from, to);
+        //Sliding index: the centre and right columns become the left and centre ones.
+        int idx = (a[from - 1] << 7) | (m[from - 1] << 4) | (b[from - 1] << 1) | (a[from] << 6) | (m[from] << 3) | b[from];
+        for(int j = from; j <= to; j++) {
+            idx = ((idx << 1) & 0x1B6) | (a[j + 1] << 6) | (m[j + 1] << 3) | b[j + 1];
+            out[j] = t[idx];
+            n += out[j] != m[j];
+        }
+    }
+    return n;
+}
+
+void LifeEngine::buildTable()
+{
+    //Index bits: row above (8 left, 7, 6 right), own row (5, 4 = the cell, 3), row below (2, 1, 0).
+    static const int bit[8] = { 7, 6, 3, 0, 1, 2, 5, 8 }; // N, NE, E, SE, S, SW, W, NW
+    QVector<bool> born, survive;
+    HenselRule::expand(bornText, born);
+    HenselRule::expand(surviveText, survive);
+    table.resize(512);
+    for(int idx = 0; idx < 512; idx++){
+        int mask = 0;
+        for(int i = 0; i < 8; i++){
+            if(neigh == 'v' && (i & 1)){ continue; } //Corners are not neighbours.
+            if(idx & (1 << bit[i])){ mask |= 1 << i; }
+        }
+        table[idx] = (idx & (1 << 4)) ? survive[mask] : born[mask];
+    }
+    tableDirty = false;
+}
+
+void LifeEngine::fillBorder()
+{
+    //Buffer zone: dead on a bounded plane, a copy of the opposite edges on a torus.
+    bool torus = edge == 't';
+    for(int j = 1; j <= w; j++){
+        universe[0][j] = torus && universe[h][j];
+        universe[h + 1][j] = torus && universe[1][j];
+    }
+    for(int k = 0; k <= h + 1; k++){
+        int src = k == 0 ? h : (k == h + 1 ? 1 : k);
+        universe[k][0] = torus && universe[src][w];
+        universe[k][w + 1] = torus && universe[src][1];
+    }
+}
+
+void LifeEngine::prepareWide()
+{
+    //Padded copy: rad cells of border, wrapped (torus) or dead (plane), and one more ring
+    //of zeros so that every prefix difference below has an origin inside the tables.
+    int o = rad + 1;
+    int ph = h + 2 * o;
+    int pw = w + 2 * o;
+    int py = qMin(ph, (active == Soup::C1 ? h : (h + 1) / 2) + 2 * o); //Rows the domain reads.
+    padded.fill(0, ph * pw);
+    for(int y = 1; y < qMin(py, ph - 1); y++){
+        int k = y - o + 1;
+        if(edge == 't'){ k = ((k - 1) % h + h) % h + 1; }
+        else if(k < 1 || k > h){ continue; }
+        for(int x = 1; x < pw - 1; x++){
+            int j = x - o + 1;
+            if(edge == 't'){ j = ((j - 1) % w + w) % w + 1; }
+            else if(j < 1 || j > w){ continue; }
+            padded[y * pw + x] = universe[k][j];
+        }
+    }
+    if(neigh == 'v'){
+        //sumA: along the main diagonal (x - y constant), sumB: along the anti-diagonal.
+        sumA.fill(0, ph * pw);
+        sumB.fill(0, ph * pw);
+        for(int y = 0; y < py; y++){
+            for(int x = 0; x < pw; x++){
+                int c = padded[y * pw + x];
+                sumA[y * pw + x] = c + (y > 0 && x > 0 ? sumA[(y - 1) * pw + x - 1] : 0);
+                sumB[y * pw + x] = c + (y > 0 && x < pw - 1 ? sumB[(y - 1) * pw + x + 1] : 0);
+            }
+        }
+    } else {
+        //Summed-area table, one row and column of zeros in front.
+        sumA.fill(0, (ph + 1) * (pw + 1));
+        sumB.clear(); //Von Neumann only.
+        for(int y = 0; y < py; y++){
+            for(int x = 0; x < pw; x++){
+                sumA[(y + 1) * (pw + 1) + x + 1] = padded[y * pw + x] + sumA[y * (pw + 1) + x + 1]
+                        + sumA[(y + 1) * (pw + 1) + x] - sumA[y * (pw + 1) + x];
+            }
+        }
+    }
+    int size = neigh == 'v' ? 2 * rad * (rad + 1) + 1 : (2 * rad + 1) * (2 * rad + 1);
+    bornAt.fill(0, size + 1);
+    surviveAt.fill(0, size + 1);
+    foreach(int b, birth){ if(b >= 0 && b <= size){ bornAt[b] = 1; } }
+    foreach(int s, survival){ if(s >= 0 && s <= size){ surviveAt[s] = 1; } }
+}
+
+int LifeEngine::stepRowsWide(int first, int last)
+{
+    int o = rad + 1;
+    int pw = w + 2 * o;
+    int n = 0;
+    for(int k = first; k <= last; k++){
+        int y = k - 1 + o;
+        int count = 0;
+        int from, to;
+        domainColumns(k, from, to);
+        if(neigh == 'v'){
+            //Diamond of the first cell counted directly, then slid: moving right drops the
+            //left edge (anti-diagonal above, main diagonal below) and adds the right one.
+            int x = from - 1 + o;
+            for(int dy = -rad; dy <= rad; dy++){
+                int span = rad - qAbs(dy);
+                for(int dx = -span; dx <= span; dx++){
+                    count += padded[(y + dy) * pw + x + dx];
+                }
+            }
+        }
+        for(int j = from; j <= to; j++){
+            int x = j - 1 + o;
+            if(neigh == 'v'){
+                if(j > from){
+                    int px = x - 1; //Previous centre.
+                    count -= sumB[y * pw + px - rad] - sumB[(y - rad - 1) * pw + px + 1];
+                    count -= sumA[(y + rad) * pw + px] - sumA[y * pw + px - rad];
+                    count += sumA[y * pw + px + 1 + rad] - sumA[(y - rad - 1) * pw + px];
+                    count += sumB[(y + rad) * pw + px + 1] - sumB[y * pw + px + rad + 1];
+                }
+            } else {
+                int w1 = pw + 1;
+                count = sumA[(y + rad + 1) * w1 + x + rad + 1] - sumA[(y - rad) * w1 + x + rad + 1]
+                        - sumA[(y + rad + 1) * w1 + x - rad] + sumA[(y - rad) * w1 + x - rad];
+            }
+            bool alive = universe[k][j];
+            int c = middle ? count : count - alive;
+            next[k][j] = alive ? surviveAt[c] : bornAt[c];
+            n += next[k][j] != alive;
+        }
+    }
+    return n;
+}
+
+bool LifeEngine::isAlive(int k, int j) const
+/**
+          0     1       ...     ...       uw      uw+1
+          __|___________________|__
+  0          |                    | k              |
+              |                    |                 |
+  1          |                    |                 |
+   .          |                    |                 |
+   :          |__________|_______> |
+              |  j                 |                 |
+   .          |                    |                 |
+   :          |                    |                 |
+ uh     __|__________v________|__
+ uh+1     |                                      |
+ The universe can have to shapes (edgeMode):
+    -bounded plane(b): the cells at the edge have no neighbour beyond it.
+        A buffer zone of 'dead' cells that are never calculated marks the limit
+    -toroidal plane(t): The edges are connected, top to bottom and left to right.
+        Which means the neighbour of a cell at the edge is the cell facing it at the oposite edge.
+        This could be modelized as the surface of a torus (donut shaped solid).
+*/
+{
+    int power = 0;
+    for(int x = j-1; x <= j+1; x++ ){
+        for(int y = k-1; y <= k+1; y++){
+            int x2 = x;
+            int y2 = y;
+            if(edge == 't'){
+                //Handle edge limits by looping around in toroidal mode.
+                if( x2 == 0){ x2 = w; } //<-- skip over 0 and uw+1 buffer columns. --
+                else
+                if( x2 == w + 1){ x2 = 1;} //-- skip over uw+1 and 0 buffer columns -->
+
+                if( y2 == 0){ y2 = h; } //<-- skip over 0 and uh buffer rows. --
+                else
+                if( y2 == h + 1){ y2 = 1;} //-- skip over uh+1 and 0 buffer rows -->
+            }
+            if( (x2 == j || y2 == k || neigh == 'm')
+                 && !(x2 == j && y2 == k)) // don't count u[k][j] itself in its neighbours.
+            {
+                power += universe[y2][x2]; //count live neighbours.
+            }
+        }  }
+    //Rule application
+    if(universe[k][j] == false){
+        //If dead, look if a birth state is satisfied.
+        foreach( int b, birth){
+            // Birth state found => cell becomes alive.
+            if(power == b){ return true; }
+        }
+    }
+    if(universe[k][j] == true){
+        //If alive, look if a survival state is satisfied
+        foreach( int s, survival){
+            // Survival state found => cell remains alive.
+            if(power == s){ return true; }
+        }
+    }
+    //Nothing found => cell dies / remains dead.
+    return false;
+}
@@ -0,0 +1,147 @@
+#ifndef LIFEENGINE_H
+#define LIFEENGINE_H
+
+#include <QList>
+#include <QString>
+#include <QVector>
+#include "bitgrid.h"
+#include "cellbuffer.h"
+#include "soup.h"
+#include "generationsengine.h"
+
+/**
+  *
+  * Life-like automaton on a finite universe, without any GUI dependency.
+  * Shared by the game widget and the command-line runner (see engine.pri).
+  * Cells are addressed from (1,1) to (height,width), row 0/h+1 and column 0/w+1 form a
+  * buffer zone of dead cells that is never calculated.
+  * Large universes are stepped in bands of rows on the global thread pool.
+  * Radius 1 rules, outer-totalistic or isotropic (Hensel notation, see HenselRule), are
+  * compiled into a 512 entry table indexed by the 3x3 neighbourhood, which is built
+  * incrementally while sliding along each row; on a torus the buffer zone holds the
+  * opposite edges during a step.
+  * Radius 1 is the classic Moore/von Neumann neighbourhood. Larger radii (Larger than Life)
+  * count a (2r+1)^2 box or a diamond of radius r from prefix sums of a padded copy of the
+  * universe (summed-area table, or diagonal sums slid along each row), so a cell costs the
+  * same whatever the radius; birth/survival counts then go up to the neighbourhood size.
+  * Rules with more than 2 states ("Generations", radius 1 and outer-totalistic) are run by a
+  * packed GenerationsEngine; the map then holds its live cells.
+  * Every buffer of cells is a CellMap or CellBuffer, counted in MemoryUsage: the current generation
+  * as Board, unless another kind is given for an engine that only works on a copy of a game.
+  * Symmetric stepping: every rule here is invariant under the rotations and reflections of the
+  * board, so a board with one of the symmetries of Soup (C2, C4, D4, D8, about its centre) keeps
+  * it. With setSymmetry() step() then only computes the fundamental domain (top half, top-left
+  * quarter, or the part of it above the diagonal) and copies it turned or mirrored over the
+  * rest. The group is checked again on the first step after an edit and falls back to a
+  * smaller one, or to every cell, when the edit broke it. Generations rules step every cell.
+ */
+
+class LifeEngine
+{
+public:
+    enum { MaxRadius = 10 };
+
+    explicit LifeEngine(int height = 50, int width = 50, MemoryUsage::Kind kind = MemoryUsage::Board); // kind: of the current generation
+
+    int height() const;
+    int width() const;
+    void resize(int height, int width); // empties the universe
+
+    char neighMode() const; // 'm': moore, 'v': von neumann
+    void setNeighMode(char mode);
+    char edgeMode() const; // 't': toroidal, 'p': bounded plane
+    void setEdgeMode(char mode);
+    QList<int> birthStates() const;
+    void setBirthStates(const QList<int> &states);
+    QList<int> survivalStates() const;
+    void setSurvivalStates(const QList<int> &states);
+    QString birthConditions() const; // as typed in the rule input: "2-a", or "34-45" ranges for radius > 1
+    bool setBirthConditions(const QString &text); // false (and nothing changed) if invalid
+    QString survivalConditions() const;
+    bool setSurvivalConditions(const QString &text);
+    int radius() const;
+    void setRadius(int r); // 1..MaxRadius
+    bool middleCounted() const;
+    void setMiddleCounted(bool counted); // radius > 1: the cell counts itself (LtL "M1")
+    int states() const;
+    void setStates(int n); // 2: life-like, 3..GenerationsEngine::MaxStates: Generations rule
+    bool setRule(const QString &rule); // "B3/S23", "B2-a/S12", "b3s23", "3|23", "B2/S/C3" or "R5,C0,M1,S34..58,B34..45,NM"
+    QString rule() const; // "B3/S23", "B2-a/S12", "B2/S/C3" for Generations, or LtL notation for radius > 1
+    static bool parseRule(const QString &rule, QList<int> &birth, QList<int> &survival); // outer-totalistic only
+    static bool parseConditions(const QString &rule, QString &birth, QString &survival); // Hensel letters kept
+    static bool parseWideRule(const QString &rule, QList<int> &birth, QList<int> &survival,
+                              int &radius, bool &middle, char &neighMode); // LtL / HROT notation
+    static QList<int> parseStates(const QString &text, bool ranges); // "23", or "34-45,50" with ranges
+    static QString statesText(const QList<int> &states, bool ranges);
+
+    int threadCount() const;
+    void setThreadCount(int n); // bands used by step(), 1 steps on the calling thread
+
+    bool cell(int k, int j) const;
+    void setCell(int k, int j, bool alive);
+    bool **map(); // universe[0..h+1][0..w+1], valid until the next step or resize
+    int state(int k, int j) const; // 0 dead, 1 alive, 2.. refractory (Generations)
+    void setState(int k, int j, int s);
+    const GenerationsEngine &generations() const; // states > 2: every cell's state, from (0,0)
+    QByteArray cellStates() const; // one byte per cell, row major
+    void setCellStates(const QByteArray &cells); // same size only
+    void clear();
+    void invert();
+    int population() const;
+    int changed() const; // cells changed by the last step
+
+    QString dump() const; // 'o'/'*' rows, as in .laut files, 'B'.. for states 2.. of Generations rules
+    void setDump(const QString &data);
+    BitGrid board() const;
+    void setBoard(const BitGrid &board); // same size only
+    BitGrid region(int top, int left, int height, int width) const; // rectangle from (0,0), dead outside the universe
+    void setRegion(int top, int left, const BitGrid &cells, BitGrid::Merge mode = BitGrid::Replace); // cells merged in at (top, left), clipped
+
+    Soup::Symmetry symmetry() const; // largest group step() may use, C1 (default): every cell
+    void setSymmetry(Soup::Symmetry group); // C2 or D4 on any board, C4 or D8 on square ones
+    Soup::Symmetry activeSymmetry(); // group of the board the next step uses, within symmetry()
+    bool hasSymmetry(Soup::Symmetry group) const; // is the board unchanged by the group's turns and mirrors
+
+    bool step(); // one generation, false (and nothing done) if no cell would change
+    bool stepReference(); // the same through isAlive(), cell by cell, for checking step(): radius 1, 2 states, outer-totalistic only
+
+private:
+    int h;
+    int w;
+    CellMap universe; // current generation
+    CellMap next; // scratch
+    char neigh;
+    char edge;
+    QList<int> birth;
+    QList<int> survival;
+    int threads;
+    int lastChanged;
+    QString bornText; // radius 1 conditions, Hensel notation
+    QString surviveText; // radius 1 conditions, Hensel notation
+    QVector<char> table; // radius 1: 3x3 neighbourhood index -> next state
+    bool tableDirty;
+    int rad;
+    bool middle;
+    CellBuffer<int> padded; // radius > 1: universe with a border of rad + 1 cells
+    CellBuffer<int> sumA; // radius > 1: summed-area table (moore) or main diagonal sums
+    CellBuffer<int> sumB; // radius > 1, von neumann: anti-diagonal sums
+    QVector<char> bornAt; // radius > 1: count -> birth
+    QVector<char> surviveAt; // radius > 1: count -> survival
+    int nStates;
+    GenerationsEngine gens; // states > 2
+    Soup::Symmetry symmetryGroup; // asked for
+    Soup::Symmetry active; // of the board, while symmetryDirty is false
+    bool symmetryDirty; // the board changed by an edit since active was found
+
+    bool isAlive(int k, int j) const; // return true if universe[k][j] accept rules (outer-totalistic reference)
+    int stepRows(int first, int last); // next[first..last] from universe, returns the changed cells
+    void domainColumns(int k, int &first, int &last) const; // part of row k stepped under the active group
+    int completeDomain(); // next outside the fundamental domain from inside it, returns the changed cells there
+    void buildTable();
+    void fillBorder(); // buffer zone for the table kernel
+    void prepareWide(); // prefix tables of the current generation
+    int stepRowsWide(int first, int last);
+    void syncStates(); // states > 2: live cells of the map in state 1, others dead
+};
+
+#endif // LIFEENGINE_H
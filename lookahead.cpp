@@ -0,0 +1,156 @@
+#include <QMutexLocker>
+#include "lookahead.h"
+#include "lifeengine.h"
+#include "memoryusage.h"
+
+
+//Constructor:
+LookAhead::LookAhead(QObject *parent) :
+    QThread(parent),
+    group(Soup::C1),
+    epoch(0),
+    idle(true),
+    still(false),
+    capacity(4),
+    stopping(false),
+    booked(0)
+{
+}
+
+//Destructor:
+LookAhead::~LookAhead()
+{
+    mutex.lock();
+    stopping = true;
+    wake.wakeOne();
+    mutex.unlock();
+    wait(); //The step in progress is finished first.
+    drop();
+}
+
+
+//Game thread side:
+void LookAhead::restart(const Checkpoint &from, Soup::Symmetry symmetry)
+{
+    QMutexLocker lock(&mutex);
+    drop();
+    origin = from;
+    group = symmetry;
+    epoch++;
+    idle = false;
+    still = false;
+    wake.wakeOne();
+    if(!isRunning()){
+        QThread::start(QThread::LowestPriority); //Only takes what the games leave.
+    }
+}
+
+void LookAhead::cancel()
+{
+    QMutexLocker lock(&mutex);
+    if(idle){
+        return;
+    }
+    drop();
+    origin = Checkpoint();
+    epoch++;
+    idle = true;
+}
+
+bool LookAhead::take(int generation, Frame &f)
+{
+    QMutexLocker lock(&mutex);
+    if(idle || frames.isEmpty() || frames.head().generation != generation){
+        return false;
+    }
+    f = frames.dequeue();
+    qint64 bytes = frameBytes(f);
+    MemoryUsage::add(MemoryUsage::Scratch, -bytes);
+    booked -= bytes;
+    wake.wakeOne(); //Room for one more.
+    return true;
+}
+
+bool LookAhead::isFollowing()
+{
+    QMutexLocker lock(&mutex);
+    return !idle;
+}
+
+void LookAhead::drop()
+{
+    frames.clear();
+    MemoryUsage::add(MemoryUsage::Scratch, -booked);
+    booked = 0;
+}
+
+qint64 LookAhead::frameBytes(const Frame &f)
+{
+    return f.board.byteSize() + f.cells.size();
+}
+
+
+//Worker thread side:
+void LookAhead::run()
+{
+    LifeEngine engine(1, 1, MemoryUsage::Scratch); //A copy of the game: its board is counted once.
+    engine.setThreadCount(1); //On this thread alone, the pool is left to the games.
+    int running = 0; // epoch the engine was loaded for
+    int generation = 0;
+    forever {
+        mutex.lock();
+        while(!stopping && (idle || (running == epoch && (still || frames.size() >= capacity)))){
+            wake.wait(&mutex);
+        }
+        if(stopping){
+            mutex.unlock();
+            break;
+        }
+        if(running != epoch){
+            //A new game to follow: same rule, modes and board as the one handed over.
+            Checkpoint c = origin;
+            origin = Checkpoint();
+            Soup::Symmetry symmetry = group;
+            running = epoch;
+            mutex.unlock();
+            engine.setNeighMode(c.neighMode);
+            engine.setRadius(c.radius);
+            engine.setMiddleCounted(c.middle);
+            engine.setStates(c.states);
+            engine.setBirthConditions(c.birth);
+            engine.setSurvivalConditions(c.survival);
+            engine.setEdgeMode(c.edgeMode);
+            engine.setSymmetry(symmetry);
+            if(engine.height() != c.board.height() || engine.width() != c.board.width()){
+                engine.resize(c.board.height(), c.board.width());
+            }
+            engine.setBoard(c.board);
+            if(c.states > 2){
+                engine.setCellStates(c.cells);
+            }
+            generation = c.generation;
+            continue; //It may have been cancelled meanwhile.
+        }
+        int ticket = running;
+        mutex.unlock();
+
+        Frame f;
+        f.changed = engine.step();
+        f.generation = ++generation;
+        if(f.changed){
+            f.board = engine.board();
+            if(engine.states() > 2){
+                f.cells = engine.cellStates();
+            }
+        }
+
+        mutex.lock();
+        if(ticket == epoch){
+            frames.enqueue(f);
+            booked += frameBytes(f);
+            MemoryUsage::add(MemoryUsage::Scratch, frameBytes(f));
+            still = !f.changed;
+        }
+        mutex.unlock();
+    }
+}
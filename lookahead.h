@@ -0,0 +1,62 @@
+#ifndef LOOKAHEAD_H
+#define LOOKAHEAD_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include "checkpointer.h"
+#include "soup.h"
+
+/**
+  *
+  * Generations computed ahead of a paused game, so that stepping it only takes the next one.
+  * restart() hands over the game as a Checkpoint (rule, modes, board, generation); this low
+  * priority thread then steps its own copy of it, on one thread so the games keep the pool,
+  * until capacity frames wait or the board stops changing. take() gives the frames in order.
+  * Frames are only valid for the board they were computed from: the game calls cancel()
+  * before any edit, rule or mode change, and before stepping itself when it gets ahead.
+  * The queued boards and the engine's own copy of the game are counted in MemoryUsage as scratch.
+ */
+
+class LookAhead : public QThread
+{
+    Q_OBJECT
+public:
+    struct Frame {
+        Frame() : generation(0), changed(false) {}
+        int generation;
+        bool changed; // false: the board stays as it is from then on
+        BitGrid board; // live cells
+        QByteArray cells; // states > 2: state of every cell, row major
+    };
+
+    explicit LookAhead(QObject *parent = 0);
+    ~LookAhead();
+
+    void restart(const Checkpoint &from, Soup::Symmetry symmetry); // frames dropped, computed again after from.generation
+    void cancel(); // frames dropped, the thread waits for the next restart()
+    bool take(int generation, Frame &f); // next frame, false if it isn't ready or of another generation
+    bool isFollowing(); // restarted and not cancelled since
+
+protected:
+    void run();
+
+private:
+    QMutex mutex;
+    QWaitCondition wake;
+    QQueue<Frame> frames;
+    Checkpoint origin; // game the frames follow
+    Soup::Symmetry group; // LifeEngine::setSymmetry() for the copy
+    int epoch; // bumped by every restart() and cancel(), frames of an older one are dropped
+    bool idle; // cancelled, nothing to compute
+    bool still; // the last frame didn't change
+    int capacity; // max queued frames
+    bool stopping;
+    qint64 booked; // bytes of the queued frames reported to MemoryUsage
+
+    void drop(); // empty the queue, mutex held
+    static qint64 frameBytes(const Frame &f);
+};
+
+#endif // LOOKAHEAD_H
@@ -10,6 +10,21 @@
 #include <QValidator>
 #include <QInputDialog>
 #include <QStandardItemModel>
+#include <QMenu>
+#include <QAction>
+#include <QTransform>
+#include <QTimer>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QMessageBox>
+#include <QPainter>
+#include <QApplication>
+#include <QSignalMapper>
+#include "recordingexporter.h"
+#include "henselrule.h"
+#include "patternio.h"
+#include "patternsearch.h"
+#include "memoryusage.h"
 
 #include <QDebug>
 
@@ -20,8 +35,9 @@ MainWindow::MainWindow(QWidget *parent) :
     ui(new Ui::MainWindow),
     currentColor(QColor("#000")), //Cells are black by default.
     game(new GameWidget(this)), //Create custom widget instance.
-    reg8(QRegExp("[0-8]{0,9}")), //For 8 neighbours rules.
+    reg8(QRegExp("[0-8cekainyqjrtwz\\-]{0,40}")), //For 8 neighbours rules, with Hensel letters.
     reg4(QRegExp("[0-4]{0,5}")), //For 4 neighbours rules.
+    regWide(QRegExp("[0-9,\\-]{0,40}")), //For Larger than Life rules: counts and ranges.
     gridRatio(10),
     infoDialog(new InfoDialog(this)),
     intervalMin(25),
@@ -36,48 +52,146 @@ MainWindow::MainWindow(QWidget *parent) :
     QPixmap icon(12, 12);
     icon.fill(currentColor);
     ui->colorButton->setIcon( QIcon(icon) );
+    //Step back is the mirror image of step.
+    ui->backBut->setIcon(QIcon(QPixmap(":/icons/icons/next.png").transformed(QTransform().scale(-1, 1))));
+    //Record is a red dot.
+    QPixmap dot(22, 22);
+    dot.fill(Qt::transparent);
+    QPainter dotPainter(&dot);
+    dotPainter.setRenderHint(QPainter::Antialiasing);
+    dotPainter.setPen(Qt::NoPen);
+    dotPainter.setBrush(QColor("#d00"));
+    dotPainter.drawEllipse(4, 4, 14, 14);
+    dotPainter.end();
+    ui->recBut->setIcon(QIcon(dot));
 
     connect(ui->StartStopBut, SIGNAL(clicked()), this,SLOT(startStopGame()));
-    connect(game,SIGNAL(gameStops(bool)), this,SLOT(startStopGame()));
     connect(ui->saveBut, SIGNAL(clicked()), this,SLOT(saveGame()));
     connect(ui->loadBut, SIGNAL(clicked()), this,SLOT(loadGame()));
     connect(ui->rootBut, SIGNAL(clicked()), this,SLOT(setTreeRoot()));
-    connect(ui->ClearBut, SIGNAL(clicked()), game,SLOT(clear()));
-    connect(ui->stepBut, SIGNAL(clicked()), game, SLOT(step()));
     connect(ui->infoBut, SIGNAL(clicked()), this, SLOT(showInfo()));
     connect(ui->intervalSlider, SIGNAL(valueChanged(int)), this, SLOT(setInterval(int)));
-    connect(ui->heightControl, SIGNAL(valueChanged(int)), game, SLOT(setUniverseHeight(int)));
-    connect(ui->widthControl, SIGNAL(valueChanged(int)), game, SLOT(setUniverseWidth(int)));
     connect(ui->heightControl, SIGNAL(valueChanged(int)), this, SLOT(gridResize()));
     connect(ui->widthControl, SIGNAL(valueChanged(int)), this, SLOT(gridResize()));
     connect(ui->modeBox, SIGNAL(currentIndexChanged(int)), this, SLOT(setNeighMode(int)));
     connect(ui->edgeRadio, SIGNAL(toggled(bool)), this, SLOT(setEdgeMode(bool)));
+    connect(ui->radiusBox, SIGNAL(valueChanged(int)), this, SLOT(setRadius(int)));
+    connect(ui->middleCheck, SIGNAL(toggled(bool)), this, SLOT(setMiddleCounted(bool)));
+    connect(ui->statesBox, SIGNAL(valueChanged(int)), this, SLOT(setStates(int)));
     connect(ui->Bstates, SIGNAL(textChanged(QString)), this, SLOT(setBStates(QString)));
     connect(ui->Sstates, SIGNAL(textChanged(QString)), this, SLOT(setSStates(QString)));
-    connect(game,SIGNAL(info(QString)), ui->labelInfo, SLOT(setText(QString)));
     connect(ui->rulesetsBox, SIGNAL(currentIndexChanged(int)), this, SLOT(selectRuleset(int)));
     connect(ui->addBut, SIGNAL(clicked()), this, SLOT(addRuleset()));
     connect(ui->removeBut, SIGNAL(clicked()), this, SLOT(removeRuleset()));
-    connect(ui->invBut,  SIGNAL(clicked()), game, SLOT(invert()));
-
-    connect(game, SIGNAL(sendGen(int)), ui->lcdG, SLOT(display(int)));
-    connect(game, SIGNAL(sendPop(int)), ui->lcdP, SLOT(display(int)));
-    connect(game, SIGNAL(sendXY(int,int)), this, SLOT(showCoord(int, int)));
+    connect(ui->exploreBut, SIGNAL(clicked()), this, SLOT(exploreRules()));
+    connect(ui->recBut, SIGNAL(clicked(bool)), this, SLOT(toggleRecording(bool)));
 
     connect(ui->colorButton, SIGNAL(clicked()), this, SLOT(selectMasterColor()));
     connect(ui->zoomInBut, SIGNAL(clicked()), this, SLOT(zoomIn()));
     connect(ui->zoomOutBut, SIGNAL(clicked()), this, SLOT(zoomOut()));
 
-    connect(game, SIGNAL(crwheelup()), this, SLOT(zoomIn()));
-    connect(game, SIGNAL(crwheeldw()), this, SLOT(zoomOut()));
-    connect(game, SIGNAL(wheelup()), this, SLOT(scrollUp()));
-    connect(game, SIGNAL(wheeldw()), this, SLOT(scrollDw()));
-    connect(game, SIGNAL(stwheelup()), this, SLOT(scrollRt()));
-    connect(game, SIGNAL(stwheeldw()), this, SLOT(scrollLt()));
+    QAction *jumpAct = new QAction("Go to generation", this);
+    jumpAct->setShortcut(QKeySequence("Ctrl+G"));
+    addAction(jumpAct);
+    connect(jumpAct, SIGNAL(triggered()), this, SLOT(jumpToGeneration()));
+    QAction *exportAct = new QAction("Export recording", this);
+    exportAct->setShortcut(QKeySequence("Ctrl+E"));
+    addAction(exportAct);
+    connect(exportAct, SIGNAL(triggered()), this, SLOT(exportRecording()));
+    QAction *hudAct = new QAction("Performance overlay", this);
+    hudAct->setShortcut(QKeySequence("F3"));
+    hudAct->setCheckable(true);
+    addAction(hudAct);
+    connect(hudAct, SIGNAL(toggled(bool)), this, SLOT(setHudVisible(bool)));
+    QAction *timingsAct = new QAction("Export timings", this);
+    timingsAct->setShortcut(QKeySequence("Ctrl+F3"));
+    addAction(timingsAct);
+    connect(timingsAct, SIGNAL(triggered()), this, SLOT(exportTimings()));
+    QAction *exploreAct = new QAction("Explore rules", this);
+    exploreAct->setShortcut(QKeySequence("Ctrl+Shift+R"));
+    addAction(exploreAct);
+    connect(exploreAct, SIGNAL(triggered()), this, SLOT(exploreRules()));
+
+    QAction *findAct = new QAction("Find pattern on the board", this);
+    findAct->setShortcut(QKeySequence::Find);
+    addAction(findAct);
+    connect(findAct, SIGNAL(triggered()), this, SLOT(findPattern()));
+    QAction *findSelectionAct = new QAction("Find selection on the board", this);
+    findSelectionAct->setShortcut(QKeySequence("Ctrl+Alt+F"));
+    addAction(findSelectionAct);
+    connect(findSelectionAct, SIGNAL(triggered()), this, SLOT(findSelection()));
+    QAction *tiledAct = new QAction("Tiled universe", this);
+    tiledAct->setShortcut(QKeySequence("Ctrl+Shift+T"));
+    addAction(tiledAct);
+    connect(tiledAct, SIGNAL(triggered()), this, SLOT(toggleTiled()));
+    QAction *shareAct = new QAction("Share frames", this);
+    shareAct->setShortcut(QKeySequence("Ctrl+Shift+P"));
+    addAction(shareAct);
+    connect(shareAct, SIGNAL(triggered()), this, SLOT(toggleSharing()));
+    QAction *soupAct = new QAction("Random fill", this);
+    soupAct->setShortcut(QKeySequence("Ctrl+Shift+S"));
+    addAction(soupAct);
+    connect(soupAct, SIGNAL(triggered()), this, SLOT(randomFill()));
+    QAction *symmetryAct = new QAction("Symmetric stepping", this);
+    symmetryAct->setShortcut(QKeySequence("Ctrl+Shift+G"));
+    addAction(symmetryAct);
+    connect(symmetryAct, SIGNAL(triggered()), this, SLOT(chooseSymmetry()));
+
+    //Selection edits, on whichever game is shown:
+    QSignalMapper *editMapper = new QSignalMapper(this);
+    QList<QPair<QString, QKeySequence> > edits;
+    edits << qMakePair(QString("Copy"), QKeySequence(QKeySequence::Copy))
+          << qMakePair(QString("Cut"), QKeySequence(QKeySequence::Cut))
+          << qMakePair(QString("Paste"), QKeySequence(QKeySequence::Paste))
+          << qMakePair(QString("Select all"), QKeySequence(QKeySequence::SelectAll))
+          << qMakePair(QString("Select none"), QKeySequence("Esc"))
+          << qMakePair(QString("Fill selection"), QKeySequence("Ctrl+Shift+F"))
+          << qMakePair(QString("Clear selection"), QKeySequence(QKeySequence::Delete))
+          << qMakePair(QString("Invert selection"), QKeySequence("Ctrl+Shift+I"))
+          << qMakePair(QString("Rotate clockwise"), QKeySequence("Ctrl+]"))
+          << qMakePair(QString("Rotate anticlockwise"), QKeySequence("Ctrl+["))
+          << qMakePair(QString("Mirror selection"), QKeySequence("Ctrl+Shift+X"))
+          << qMakePair(QString("Flip selection"), QKeySequence("Ctrl+Shift+Y"))
+          << qMakePair(QString("Paste mode"), QKeySequence("Ctrl+Shift+M"));
+    for(int i = 0; i < edits.size(); i++){
+        QAction *editAct = new QAction(edits[i].first, this);
+        editAct->setShortcut(edits[i].second);
+        addAction(editAct);
+        connect(editAct, SIGNAL(triggered()), editMapper, SLOT(map()));
+        editMapper->setMapping(editAct, edits[i].first);
+    }
+    connect(editMapper, SIGNAL(mapped(QString)), this, SLOT(editSelection(QString)));
+
+    censusDock = new CensusDock(game, this);
+    addDockWidget(Qt::RightDockWidgetArea, censusDock);
+    censusDock->hide();
+    QAction *censusAct = censusDock->toggleViewAction();
+    censusAct->setShortcut(QKeySequence("Ctrl+Shift+C"));
+    addAction(censusAct);
 
     connect(ui->SaveMenu, SIGNAL(triggered()), this, SLOT(saveGame()));
     connect(ui->LoadMenu, SIGNAL(triggered()), this, SLOT(loadGame()));
 
+    //Universes in tabs, each with its own board, rule and timer. Only the shown one is bound to the controls.
+    tabs = new QTabBar(this);
+    tabs->setTabsClosable(true);
+    tabs->setExpanding(false);
+    tabs->addTab("Universe 1");
+    tabCount = 1;
+    games << game;
+    ui->verticalLayout_2->insertWidget(ui->verticalLayout_2->indexOf(ui->GameArea), tabs);
+    bindGame(true);
+    connect(tabs, SIGNAL(currentChanged(int)), this, SLOT(selectGame(int)));
+    connect(tabs, SIGNAL(tabCloseRequested(int)), this, SLOT(closeGame(int)));
+    QAction *newGameAct = new QAction("New universe", this);
+    newGameAct->setShortcut(QKeySequence("Ctrl+T"));
+    addAction(newGameAct);
+    connect(newGameAct, SIGNAL(triggered()), this, SLOT(newGame()));
+    QAction *closeGameAct = new QAction("Close universe", this);
+    closeGameAct->setShortcut(QKeySequence("Ctrl+Shift+W"));
+    addAction(closeGameAct);
+    connect(closeGameAct, SIGNAL(triggered()), this, SLOT(closeGame()));
+
     game->setSizePolicy(QSizePolicy::Ignored, QSizePolicy::Ignored);
     ui->GameArea->setBackgroundRole(QPalette::Dark);
     ui->GameArea->setWidget(game); //Custom widget, has to be added manually.
@@ -95,6 +209,12 @@ MainWindow::MainWindow(QWidget *parent) :
     ui->treeView->hideColumn(1);
     ui->treeView->hideColumn(2);
     ui->treeView->hideColumn(3);
+    ui->treeView->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(ui->treeView, SIGNAL(customContextMenuRequested(QPoint)), this, SLOT(treeMenu(QPoint)));
+
+    patternIndex = new PatternIndex(this);
+    patternIndex->setRoot(treeRoot);
+    ruleExplorer = 0;
 
     ui->Bstates->setValidator( new QRegExpValidator(reg8, this) );
     ui->Sstates->setValidator( new QRegExpValidator(reg8, this) );
@@ -105,6 +225,16 @@ MainWindow::MainWindow(QWidget *parent) :
     ui->lcdY->setPalette(Qt::red);
     ui->labelInfo->setText("...");
 
+    QTimer *memoryTimer = new QTimer(this);
+    connect(memoryTimer, SIGNAL(timeout()), this, SLOT(showMemory()));
+    memoryTimer->start(1000);
+    QAction *resetPeakAct = new QAction("Reset peak", this);
+    ui->labelMemory->setContextMenuPolicy(Qt::ActionsContextMenu);
+    ui->labelMemory->addAction(resetPeakAct);
+    connect(resetPeakAct, SIGNAL(triggered()), this, SLOT(resetMemoryPeak()));
+    showMemory();
+
+    QTimer::singleShot(0, this, SLOT(offerResume())); //Once the window is up.
 }
 
 //Destructor:
@@ -152,13 +282,15 @@ void MainWindow::readDefaults()
     if(!file_d.open(QIODevice::ReadOnly)){
         //if no default.ini, write it.
         file_d.open(QIODevice::WriteOnly | QIODevice::Truncate);
-        QString def = "#grid:\nheight:50\nwidth:50\n\n#game:\ninterval:100\nmode:m\nruleB:3\nruleS:23\n\n#color:\nr:0\ng:0\nb:0";
+        QString def = "#grid:\nheight:50\nwidth:50\n\n#game:\ninterval:100\nmode:m\nruleB:3\nruleS:23\n\n#color:\nr:0\ng:0\nb:0\n\n#history:\nkeyframe:32\nhistoryMB:64\n\n#checkpoints:\ncheckpointGens:0\ncheckpointSecs:0";
         file_d.write(def.toUtf8());
         defBstates = "3";
         defSstates = "23";
     }
     //read:
     int r = 0;  int g = 0; int b = 0;
+    int keyframe = 32; int historyMB = 64;
+    int checkpointGens = 0; int checkpointSecs = 0;
     QTextStream in_d(&file_d);
     QString buf;
     while( ! in_d.atEnd()){
@@ -198,9 +330,19 @@ void MainWindow::readDefaults()
                g = var[1].toInt();
             } else if(var[0] == "b"){
                b = var[1].toInt();
+            } else if(var[0] == "keyframe"){
+               keyframe = var[1].toInt();
+            } else if(var[0] == "historyMB"){
+               historyMB = var[1].toInt();
+            } else if(var[0] == "checkpointGens"){
+               checkpointGens = var[1].toInt();
+            } else if(var[0] == "checkpointSecs"){
+               checkpointSecs = var[1].toInt();
             }
          }
      }
+    game->setHistoryLimits(keyframe, historyMB);
+    game->setCheckpointPeriod(checkpointGens, checkpointSecs);
     //Set Color
     currentColor = QColor(r,g,b);
     game->setMasterColor(currentColor); // sets color of the cells
@@ -297,7 +439,15 @@ void MainWindow::saveGame()
     curPath =  QFileInfo(file).absolutePath(); //Save path for next time.
     QString n;
     if(ui->modeBox->currentIndex() == 0){ n = 'm';} else { n = 'v';}
-    QString s = ui->Bstates->text() + "|" + ui->Sstates->text() + "|" + n + "\n"; //Ruleset for the pattern.
+    QString s = ui->Bstates->text() + "|" + ui->Sstates->text() + "|" + n; //Ruleset for the pattern.
+    if(ui->radiusBox->value() > 1 || ui->statesBox->value() > 2){
+        //Larger than Life: radius and self count.
+        s += "|" + QString::number(ui->radiusBox->value()) + "|" + (ui->middleCheck->isChecked() ? "1" : "0");
+    }
+    if(ui->statesBox->value() > 2){
+        s += "|" + QString::number(ui->statesBox->value()); //Generations.
+    }
+    s += "\n";
     file.write(s.toUtf8());
     s = QString::number(game->getUniverseHeight()) + "|" + QString::number(game->getUniverseWidth()) +"\n"; //Grid dimensions.
     file.write(s.toUtf8());
@@ -311,6 +461,10 @@ void MainWindow::saveGame()
     file.write(s.toUtf8());
     s = QString::number(ui->intervalSlider->value())+"\n";   //Timer setting.
     file.write(s.toUtf8());
+    if(!game->soup().isEmpty()){
+        s = "soup " + game->soup() + "\n"; //Seed of the random fill the board started from.
+        file.write(s.toUtf8());
+    }
     file.close();
     ui->labelInfo->setText("Pattern saved: " + QFileInfo(file).fileName());
 }
@@ -347,13 +501,17 @@ void MainWindow::readGame(QString filename)
     QString tmp;
     in >> tmp;
     QList<QString> tmpl =  tmp.split('|');
-    ui->Bstates->setText(tmpl[0]);
-    ui->Sstates->setText(tmpl[1]);
+    //Mode and radius first: changing them resets the rule input.
     if(tmpl[2] == "m"){
         ui->modeBox->setCurrentIndex(0);
     }else{
         ui->modeBox->setCurrentIndex(1);
     }
+    ui->radiusBox->setValue(tmpl.size() > 3 ? qMax(1, tmpl[3].toInt()) : 1);
+    ui->middleCheck->setChecked(tmpl.size() > 4 && tmpl[4] == "1");
+    ui->statesBox->setValue(tmpl.size() > 5 ? tmpl[5].toInt() : 2);
+    ui->Bstates->setText(tmpl[0]);
+    ui->Sstates->setText(tmpl[1]);
     //Setup grid:
     in >> tmp;
     tmpl =  tmp.split('|');
@@ -385,12 +543,58 @@ void MainWindow::readGame(QString filename)
     //Setup speed increment:
     ui->intervalSlider->setValue(r);
     setInterval(r);
+    //Random soup the board started from, if any:
+    in >> tmp;
+    if(tmp == "soup"){
+        game->setSoup(in.readLine().trimmed());
+    }
    //End:
     file.close();
     ui->labelInfo->setText("Pattern loaded: " + QFileInfo(file).fileName());
     game->update();
 }
 
+void MainWindow::offerResume()
+{
+    //Proposes to continue from the most recent automatic checkpoint.
+    QString filename = Checkpointer::newest(game->checkpointDirectory());
+    Checkpoint c;
+    if(filename.isEmpty() || !Checkpointer::read(filename, c)){
+        return;
+    }
+    if(c.board.height() < ui->heightControl->minimum() || c.board.height() > ui->heightControl->maximum()
+            || c.board.width() < ui->widthControl->minimum() || c.board.width() > ui->widthControl->maximum()){
+        //The size boxes would clamp it to another board.
+        ui->labelInfo->setText("Checkpoint not resumed: its " + QString::number(c.board.height()) + "x"
+                               + QString::number(c.board.width()) + " board is out of the size range of the window"
+                               + " (" + QString::number(ui->heightControl->maximum()) + "x"
+                               + QString::number(ui->widthControl->maximum()) + " at most).");
+        return;
+    }
+    QString when = QFileInfo(filename).lastModified().toString("yyyy-MM-dd hh:mm");
+    if(QMessageBox::question(this, "Resume checkpoint",
+                             "Resume the run checkpointed at generation " + QString::number(c.generation)
+                             + " (B" + c.birth + "/S" + c.survival + ", " + when + ")?",
+                             QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes){
+        return;
+    }
+    //Mode first: changing it resets the rule input.
+    ui->modeBox->setCurrentIndex(c.neighMode == 'v' ? 1 : 0);
+    ui->radiusBox->setValue(c.radius);
+    ui->middleCheck->setChecked(c.middle);
+    ui->statesBox->setValue(c.states);
+    ui->Bstates->setText(c.birth);
+    ui->Sstates->setText(c.survival);
+    ui->edgeRadio->setChecked(c.edgeMode == 't');
+    ui->heightControl->setValue(c.board.height());
+    ui->widthControl->setValue(c.board.width());
+    game->setBoard(c.board, c.generation);
+    if(c.states > 2){
+        game->setCellStates(c.cells); //Refractory cells.
+    }
+    ui->labelInfo->setText("Checkpoint resumed: generation " + QString::number(c.generation));
+}
+
 //====================================================================================~~Action-Slots~~====================================================================================
 
 void MainWindow::startStopGame()
@@ -410,11 +614,281 @@ void MainWindow::startStopGame()
     }
 }
 
+void MainWindow::gameStopped()
+{
+    //The shown game stopped by itself.
+    if(state){
+        startStopGame();
+    }
+}
+
+void MainWindow::bindGame(bool on)
+{
+    //Connections between the controls and the game shown in the tabs.
+    if(!on){
+        disconnect(game, 0, this, 0);
+        disconnect(game, 0, ui->labelInfo, 0);
+        disconnect(game, 0, ui->recBut, 0);
+        disconnect(game, 0, ui->lcdG, 0);
+        disconnect(game, 0, ui->lcdP, 0);
+        disconnect(ui->ClearBut, 0, game, 0);
+        disconnect(ui->stepBut, 0, game, 0);
+        disconnect(ui->backBut, 0, game, 0);
+        disconnect(ui->invBut, 0, game, 0);
+        return;
+    }
+    connect(game, SIGNAL(gameStops(bool)), this, SLOT(gameStopped()));
+    connect(game, SIGNAL(info(QString)), ui->labelInfo, SLOT(setText(QString)));
+    connect(game, SIGNAL(recording(bool)), ui->recBut, SLOT(setChecked(bool)));
+    connect(game, SIGNAL(sendGen(int)), ui->lcdG, SLOT(display(int)));
+    connect(game, SIGNAL(sendPop(int)), ui->lcdP, SLOT(display(int)));
+    connect(game, SIGNAL(sendXY(int,int)), this, SLOT(showCoord(int, int)));
+    connect(game, SIGNAL(crwheelup()), this, SLOT(zoomIn()));
+    connect(game, SIGNAL(crwheeldw()), this, SLOT(zoomOut()));
+    connect(game, SIGNAL(wheelup()), this, SLOT(scrollUp()));
+    connect(game, SIGNAL(wheeldw()), this, SLOT(scrollDw()));
+    connect(game, SIGNAL(stwheelup()), this, SLOT(scrollRt()));
+    connect(game, SIGNAL(stwheeldw()), this, SLOT(scrollLt()));
+    connect(ui->ClearBut, SIGNAL(clicked()), game, SLOT(clear()));
+    connect(ui->stepBut, SIGNAL(clicked()), game, SLOT(step()));
+    connect(ui->backBut, SIGNAL(clicked()), game, SLOT(stepBack()));
+    connect(ui->invBut, SIGNAL(clicked()), game, SLOT(invert()));
+}
+
+void MainWindow::newGame()
+{
+    //Empty board of the size in the controls, with the shown game's rule, speed and color.
+    GameWidget *g = new GameWidget(this);
+    g->hide();
+    g->setSizePolicy(QSizePolicy::Ignored, QSizePolicy::Ignored);
+    g->setBackgroundRole(QPalette::Base);
+    g->setToolTip(game->toolTip());
+    g->setUniverseHeight(ui->heightControl->value());
+    g->setUniverseWidth(ui->widthControl->value());
+    g->setNeighMode(game->neighMode());
+    g->setEdgeMode(game->edgeMode());
+    g->setRadius(game->radius());
+    g->setMiddleCounted(game->middleCounted());
+    g->setStates(game->states());
+    if(game->radius() > 1){
+        g->setBirthStates(LifeEngine::parseStates(game->birthConditions(), true));
+        g->setSurvStates(LifeEngine::parseStates(game->survivalConditions(), true));
+    } else {
+        g->setBirthConditions(game->birthConditions());
+        g->setSurvConditions(game->survivalConditions());
+    }
+    g->setInterval(game->interval());
+    g->setMasterColor(game->masterColor());
+    games << g;
+    tabs->addTab("Universe " + QString::number(++tabCount));
+    tabs->setCurrentIndex(tabs->count() - 1);
+}
+
+void MainWindow::selectGame(int index)
+{
+    if(index < 0 || index >= games.size() || games[index] == game){
+        return;
+    }
+    bool hud = game->hudVisible();
+    bindGame(false);
+    ui->GameArea->takeWidget();
+    game->setParent(this); //Keeps running, hidden: nothing is painted.
+    game->hide();
+    game = games[index];
+    game->setHudVisible(hud);
+    ui->GameArea->setWidget(game);
+    bindGame(true);
+    censusDock->setGame(game);
+    showGame();
+}
+
+void MainWindow::closeGame()
+{
+    closeGame(tabs->currentIndex());
+}
+
+void MainWindow::closeGame(int index)
+{
+    if(games.size() < 2){
+        ui->labelInfo->setText("The last universe can't be closed.");
+        return;
+    }
+    GameWidget *g = games[index];
+    if(g == game){
+        tabs->setCurrentIndex(index > 0 ? index - 1 : 1);
+    }
+    games.removeAt(index);
+    tabs->removeTab(index);
+    g->stopRecording();
+    delete g;
+}
+
+void MainWindow::showGame()
+{
+    //Controls follow the game of the selected tab, without being applied back to it.
+    QList<QWidget*> controls = QList<QWidget*>() << ui->modeBox << ui->edgeRadio << ui->radiusBox << ui->middleCheck
+                                                 << ui->statesBox << ui->Bstates << ui->Sstates
+                                                 << ui->heightControl << ui->widthControl << ui->intervalSlider;
+    foreach(QWidget *w, controls){ w->blockSignals(true); }
+    ui->modeBox->setCurrentIndex(game->neighMode() == 'v' ? 1 : 0);
+    ui->edgeRadio->setChecked(game->edgeMode() == 't');
+    ui->radiusBox->setValue(game->radius());
+    ui->middleCheck->setChecked(game->middleCounted());
+    ui->statesBox->setValue(game->states());
+    ui->Bstates->setText(game->birthConditions());
+    ui->Sstates->setText(game->survivalConditions());
+    ui->heightControl->setValue(game->getUniverseHeight());
+    ui->widthControl->setValue(game->getUniverseWidth());
+    ui->intervalSlider->setValue(game->interval());
+    foreach(QWidget *w, controls){ w->blockSignals(false); }
+    QRegExp reg = game->radius() > 1 ? regWide : (game->neighMode() == 'v' ? reg4 : reg8);
+    ui->Bstates->setValidator( new QRegExpValidator(reg, this) );
+    ui->Sstates->setValidator( new QRegExpValidator(reg, this) );
+    ui->middleCheck->setEnabled(game->radius() > 1);
+    ui->radiusBox->setEnabled(game->states() == 2);
+    currentColor = game->masterColor();
+    QPixmap icon(12, 12);
+    icon.fill(currentColor);
+    ui->colorButton->setIcon( QIcon(icon) );
+    ui->recBut->setChecked(game->isRecording());
+    state = game->isRunning();
+    ui->StartStopBut->setIcon(QIcon(state ? ":/icons/icons/pause.png" : ":/icons/icons/play.png"));
+    ui->StartStopBut->setToolTip(state ? "Pause game (space)" : "Start game (space)");
+    ui->lcdG->display(game->generation());
+    ruleSwich(); //Compare the tab's ruleset.
+    scaleGame(1.0); //Size of the tab's board.
+}
+
+void MainWindow::editSelection(QString edit)
+{
+    //Selection shortcuts. Shift-drag on the board selects, or moves the selection.
+    if(edit == "Copy"){
+        game->copySelection();
+    } else if(edit == "Cut"){
+        game->cutSelection();
+    } else if(edit == "Paste"){
+        game->paste();
+    } else if(edit == "Select all"){
+        game->selectAll();
+    } else if(edit == "Select none"){
+        game->selectNone();
+    } else if(edit == "Fill selection"){
+        game->fillSelection();
+    } else if(edit == "Clear selection"){
+        game->clearSelection();
+    } else if(edit == "Invert selection"){
+        game->invertSelection();
+    } else if(edit == "Rotate clockwise"){
+        game->rotateSelection(true);
+    } else if(edit == "Rotate anticlockwise"){
+        game->rotateSelection(false);
+    } else if(edit == "Mirror selection"){
+        game->mirrorSelection();
+    } else if(edit == "Flip selection"){
+        game->flipSelection();
+    } else if(edit == "Paste mode"){
+        BitGrid::Merge mode = (BitGrid::Merge)((game->pasteMode() + 1) % 4);
+        game->setPasteMode(mode);
+        QStringList names = QStringList() << "replace" << "OR" << "XOR" << "AND";
+        ui->labelInfo->setText("Paste mode: " + names[mode] + ".");
+    }
+}
+
 void MainWindow::setInterval(int ms){
     game->setInterval(ms);
     ui->intervalSlider->setToolTip("<html>Turn interval ("  + QString::number(ms) + "ms<sup>-1</sup>)</html>");
 }
 
+void MainWindow::jumpToGeneration()
+{
+    //Prompt for a generation kept in the game history.
+    if(game->historyFirst() < 0){
+        ui->labelInfo->setText("No generation recorded yet.");
+        return;
+    }
+    bool ok;
+    int g = QInputDialog::getInt(this, "Go to generation",
+                                 "Generation (" + QString::number(game->historyFirst()) + " - " + QString::number(game->historyLast()) + "):",
+                                 game->historyLast(), game->historyFirst(), game->historyLast(), 1, &ok);
+    if(ok){
+        game->jumpTo(g);
+    }
+}
+
+void MainWindow::toggleRecording(bool on)
+{
+    if(!on){
+        game->stopRecording();
+        return;
+    }
+    QString filename = QFileDialog::getSaveFileName(this,
+                                                    tr("Record run"),
+                                                    curPath,
+                                                    tr("Life recording Files (*.lrec)"));
+    if(filename.length() < 1 || !game->startRecording(filename.endsWith(".lrec") ? filename : filename + ".lrec")){
+        ui->recBut->setChecked(false);
+    }
+}
+
+void MainWindow::exportRecording()
+{
+    //Recording -> animated GIF, or PNG frames in a directory.
+    QString recording = QFileDialog::getOpenFileName(this,
+                                                     tr("Export recording"),
+                                                     curPath,
+                                                     tr("Life recording Files (*.lrec)"));
+    if(recording.length() < 1){
+        return;
+    }
+    QString filter;
+    QString target = QFileDialog::getSaveFileName(this,
+                                                  tr("Export as"),
+                                                  QFileInfo(recording).absolutePath(),
+                                                  tr("Animated GIF (*.gif);;PNG frames directory (*)"),
+                                                  &filter);
+    if(target.length() < 1){
+        return;
+    }
+    bool ok;
+    int zoom = QInputDialog::getInt(this, "Export recording", "Pixels per cell:", 4, 1, 32, 1, &ok);
+    if(!ok){
+        return;
+    }
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    bool done;
+    if(filter.startsWith("Animated GIF")){
+        if(!target.endsWith(".gif")){ target += ".gif"; }
+        done = RecordingExporter::exportGif(recording, target, zoom, game->interval(), game->masterColor());
+    } else {
+        done = RecordingExporter::exportFrames(recording, target, zoom, game->masterColor());
+    }
+    QApplication::restoreOverrideCursor();
+    ui->labelInfo->setText(done ? "Recording exported: " + QFileInfo(target).fileName() : "Export failed.");
+}
+
+void MainWindow::setHudVisible(bool on)
+{
+    game->setHudVisible(on);
+}
+
+void MainWindow::exportTimings()
+{
+    //Timings are only taken while the overlay (F3) is shown.
+    if(!game->hudVisible()){
+        ui->labelInfo->setText("Show the performance overlay (F3) to record timings.");
+        return;
+    }
+    QString filename = QFileDialog::getSaveFileName(this,
+                                                    tr("Export timings"),
+                                                    curPath,
+                                                    tr("CSV Files (*.csv)"));
+    if(filename.length() < 1){
+        return;
+    }
+    if(!filename.endsWith(".csv")){ filename += ".csv"; }
+    ui->labelInfo->setText(game->writeTimings(filename) ? "Timings exported: " + QFileInfo(filename).fileName() : "Export failed.");
+}
+
 void MainWindow::setTreeRoot()
 //Prompt for the tree root button. Saves path in ini file.
 {
@@ -426,6 +900,7 @@ void MainWindow::setTreeRoot()
         tmp = QDir("." + QString(QDir::separator())).relativeFilePath(tmp);
         treeRoot = tmp;
         ui->treeView->setRootIndex(treeModel->setRootPath(treeRoot));
+        patternIndex->setRoot(treeRoot);
         QFile file(".." + QString(QDir::separator()) + "rootpath.ini");
         if(!file.open(QIODevice::WriteOnly| QIODevice::Truncate)){
             return;}
@@ -435,6 +910,226 @@ void MainWindow::setTreeRoot()
 }
 
 
+void MainWindow::treeMenu(const QPoint &pos)
+{
+    //Pattern index queries on the tree view.
+    QModelIndex index = ui->treeView->indexAt(pos);
+    QString filename;
+    if(index.isValid() && !treeModel->isDir(index)){
+        filename = treeModel->fileInfo(index).absoluteFilePath();
+    }
+    QMenu menu(this);
+    QAction *copiesAct = menu.addAction("Find copies of this pattern");
+    copiesAct->setEnabled(filename.endsWith(".laut"));
+    QAction *boardAct = menu.addAction("Find current board in library");
+    QAction *allAct = menu.addAction("List all duplicates");
+    menu.addSeparator();
+    QAction *findAct = menu.addAction("Find this pattern on the board");
+    findAct->setEnabled(PatternIO::isSupported(filename));
+    QAction *chosen = menu.exec(ui->treeView->viewport()->mapToGlobal(pos));
+    if(chosen == copiesAct){
+        showMatches("Copies of " + QFileInfo(filename).fileName(), patternIndex->duplicatesOf(filename));
+    } else if(chosen == boardAct){
+        QByteArray key = PatternIndex::canonicalKey(game->dump());
+        if(key.isEmpty()){
+            ui->labelInfo->setText("The board is empty.");
+            return;
+        }
+        showMatches("Files holding the current board", patternIndex->filesFor(key));
+    } else if(chosen == allAct){
+        QStringList lines;
+        foreach(QStringList group, patternIndex->duplicateGroups()){
+            if(!lines.isEmpty()){ lines.append(""); } //Blank line between objects.
+            lines.append(group);
+        }
+        showMatches("Duplicate patterns", lines);
+    } else if(chosen == findAct){
+        findPattern(filename);
+    }
+}
+
+void MainWindow::findPattern()
+{
+    QString filename = QFileDialog::getOpenFileName(this,
+                                                    tr("Find pattern"),
+                                                    curPath,
+                                                    tr("Patterns (*.laut *.rle *.cells)"));
+    if(filename.length() < 1)
+        return;
+    findPattern(filename);
+}
+
+void MainWindow::toggleTiled()
+{
+    if(game->isTiled()){
+        game->closeTiled();
+    } else {
+        QString filename = QFileDialog::getSaveFileName(this,
+                                                        tr("Open or create a tiled universe"),
+                                                        curPath,
+                                                        tr("Tiled universes (*.ltil)"),
+                                                        0,
+                                                        QFileDialog::DontConfirmOverwrite);
+        if(filename.length() < 1)
+            return;
+        if(!filename.endsWith(".ltil"))
+            filename += ".ltil";
+        if(QFile::exists(filename)){
+            game->openTiled(filename);
+        } else {
+            bool ok;
+            QString text = QInputDialog::getText(this, "New tiled universe", "Height x width (cells):",
+                                                 QLineEdit::Normal, "10000x10000", &ok);
+            QStringList size = text.split(QRegExp("[x* ]+"), QString::SkipEmptyParts);
+            if(!ok || size.size() != 2)
+                return;
+            game->openTiled(filename, size[0].toInt(), size[1].toInt());
+        }
+    }
+    gridRatio = 10;
+    scaleGame(1.0); //New size in cells.
+}
+
+void MainWindow::toggleSharing()
+{
+    if(game->isSharing()){
+        game->stopSharing();
+        return;
+    }
+    bool ok;
+    QString key = QInputDialog::getText(this, "Share frames", "Shared memory key:",
+                                        QLineEdit::Normal, "automata-frames", &ok);
+    if(!ok || key.isEmpty())
+        return;
+    game->startSharing(key);
+}
+
+void MainWindow::randomFill()
+{
+    //Soup over the selection or the whole board. The last density and symmetry are offered with a new seed.
+    double density = 0.35;
+    Soup::Symmetry symmetry = Soup::C1;
+    quint64 seed = 0;
+    Soup::parse(game->soup(), density, symmetry, seed);
+    bool ok;
+    QString text = QInputDialog::getText(this, "Random fill",
+                                         "Density (0 - 1), symmetry (C1, C2, C4, D4, D8) and seed:",
+                                         QLineEdit::Normal, Soup::describe(density, symmetry, Soup::randomSeed()), &ok);
+    if(!ok)
+        return;
+    if(!Soup::parse(text, density, symmetry, seed)){
+        ui->labelInfo->setText("Random fill: expected a density, a symmetry and a seed, e.g. 0.35 C1 42.");
+        return;
+    }
+    game->randomFill(density, symmetry, seed);
+}
+
+void MainWindow::chooseSymmetry()
+{
+    //Largest group the shown game may step with: only the fundamental domain is computed
+    //while the board has it, every cell again after an edit that breaks it.
+    static const Soup::Symmetry groups[] = { Soup::C1, Soup::C2, Soup::C4, Soup::D4, Soup::D8 };
+    QStringList items;
+    items << "C1: every cell" << "C2: half turn" << "C4: quarter turns" << "D4: mirrors" << "D8: any symmetry";
+    int current = 0;
+    for(int i = 0; i < 5; i++){
+        if(groups[i] == game->symmetry()){ current = i; }
+    }
+    bool ok;
+    QString item = QInputDialog::getItem(this, "Symmetric stepping", "Step only the symmetric part of the board, up to:",
+                                         items, current, false, &ok);
+    if(!ok)
+        return;
+    game->setSymmetry(groups[items.indexOf(item)]);
+    static const char *shares[] = { "every cell", "half of the cells", "a quarter of the cells", "a quarter of the cells", "an eighth of the cells" };
+    Soup::Symmetry active = game->activeSymmetry();
+    ui->labelInfo->setText("Symmetry " + Soup::symmetryName(active) + ": stepping " + shares[active] + ".");
+}
+
+void MainWindow::findPattern(QString filename)
+{
+    Pattern pattern;
+    if(!PatternIO::read(filename, pattern) || pattern.board.population() == 0){
+        ui->labelInfo->setText("Could not read a pattern from " + QFileInfo(filename).fileName() + ".");
+        return;
+    }
+    findCopies(pattern.board, QFileInfo(filename).fileName() + " on the board");
+}
+
+void MainWindow::findSelection()
+{
+    QRect selected = game->selection();
+    if(selected.isNull()){
+        ui->labelInfo->setText("Nothing selected.");
+        return;
+    }
+    BitGrid cells = game->board().region(selected.top(), selected.left(), selected.height(), selected.width());
+    if(cells.population() == 0){
+        ui->labelInfo->setText("No live cell in the selection.");
+        return;
+    }
+    findCopies(cells, "Selection on the board"); //Itself included.
+}
+
+void MainWindow::findCopies(const BitGrid &cells, const QString &title)
+{
+    //Copies of the live cells, in any orientation, with nothing else around them.
+    QElapsedTimer clock;
+    clock.start();
+    QList<PatternSearch::Match> matches = PatternSearch::find(game->board(), cells, ui->edgeRadio->isChecked(), true);
+    qint64 ms = clock.elapsed();
+    QList<QRect> marks;
+    QStringList lines;
+    foreach(PatternSearch::Match m, matches){
+        marks.append(QRect(m.j, m.k, m.width, m.height));
+        if(lines.size() < 200){
+            lines.append(QString("x %1, y %2 (%3x%4)").arg(m.j + 1).arg(m.k + 1).arg(m.width).arg(m.height));
+        }
+    }
+    game->setMarks(marks);
+    ui->labelInfo->setText(QString("%1: %2 match(es) in %3 ms.").arg(title).arg(matches.size()).arg(ms));
+    if(matches.size() > lines.size()){
+        lines.append(QString("... and %1 more").arg(matches.size() - lines.size()));
+    }
+    if(!lines.isEmpty()){
+        QMessageBox::information(this, title, lines.join("\n"));
+    }
+}
+
+void MainWindow::showMatches(QString title, QStringList files)
+{
+    //Lists index results relative to the tree root.
+    if(files.isEmpty()){
+        ui->labelInfo->setText(title + ": none found.");
+        return;
+    }
+    QDir rootDir(treeRoot);
+    QStringList lines;
+    foreach(QString f, files){
+        lines.append(f.isEmpty() ? f : rootDir.relativeFilePath(f));
+    }
+    ui->labelInfo->setText(title + ": " + QString::number(files.size() - files.count("")) + " file(s).");
+    QMessageBox::information(this, title, lines.join("\n"));
+}
+
+
+static int rulesetRadius(const QList<QString> &rule)
+{
+    //Optional 5th field of a ruleset, absent for radius 1.
+    return rule.size() > 4 ? qMax(1, rule[4].toInt()) : 1;
+}
+
+static bool rulesetMiddle(const QList<QString> &rule)
+{
+    return rulesetRadius(rule) > 1 && rule.size() > 5 && rule[5] == "1";
+}
+
+static int rulesetStates(const QList<QString> &rule)
+{
+    //Optional 7th field, Generations rules only.
+    return rule.size() > 6 ? qMax(2, rule[6].toInt()) : 2;
+}
+
 void MainWindow::selectRuleset(int index)
 {
     //Handler for the ruleset comboBox.
@@ -446,6 +1141,9 @@ void MainWindow::selectRuleset(int index)
         ui->modeBox->setCurrentIndex(0);
         setNeighMode(0);
     }
+    ui->radiusBox->setValue(rulesetRadius(rule));
+    ui->middleCheck->setChecked(rulesetMiddle(rule));
+    ui->statesBox->setValue(rulesetStates(rule));
     ui->Bstates->setText(rule[0]);
     setBStates(rule[0]);
     ui->Sstates->setText(rule[1]);
@@ -492,13 +1190,23 @@ QList<QString> MainWindow::getRuleSet()
         rule[2] = "v";
     }
     rule[3].append("");
+    if(ui->radiusBox->value() > 1 || ui->statesBox->value() > 2){
+        //Optional fields, only written for Larger than Life and Generations rules.
+        rule.append(QString::number(ui->radiusBox->value()));
+        rule.append(ui->middleCheck->isChecked() ? "1" : "0");
+    }
+    if(ui->statesBox->value() > 2){
+        rule.append(QString::number(ui->statesBox->value()));
+    }
     return rule;
 }
 
 int MainWindow::rulesetExists(QList<QString> rule){
     //Compare a ruleset to saved rulesets, ignores name.
     for(int r = 0; r < rulesets.size(); r++){
-        if(rulesets[r][0] == rule[0] && rulesets[r][1] == rule[1] && rulesets[r][2] == rule[2])
+        if(rulesets[r][0] == rule[0] && rulesets[r][1] == rule[1] && rulesets[r][2] == rule[2]
+                && rulesetRadius(rulesets[r]) == rulesetRadius(rule) && rulesetMiddle(rulesets[r]) == rulesetMiddle(rule)
+                && rulesetStates(rulesets[r]) == rulesetStates(rule))
         { return r; }
      }
     return -1;
@@ -514,6 +1222,52 @@ void MainWindow::removeRuleset()
 }
 
 
+void MainWindow::exploreRules()
+{
+    //Opens the rule explorer, kept between uses with its last results.
+    if(!ruleExplorer){
+        ruleExplorer = new RuleExplorer(this);
+        connect(ruleExplorer, SIGNAL(ruleSelected(QString,QString,char)), this, SLOT(applyRule(QString,QString,char)));
+        connect(ruleExplorer, SIGNAL(ruleAdded(QString,QString,char)), this, SLOT(addExploredRule(QString,QString,char)));
+        ruleExplorer->setNeighMode(ui->modeBox->currentIndex() == 1 ? 'v' : 'm');
+    }
+    ruleExplorer->show();
+    ruleExplorer->raise();
+    ruleExplorer->activateWindow();
+}
+
+void MainWindow::applyRule(QString birth, QString survival, char neighMode)
+{
+    //Loads a rule from the explorer, the ruleset box follows through ruleSwich().
+    int index = neighMode == 'v' ? 1 : 0;
+    if(ui->modeBox->currentIndex() != index){
+        ui->modeBox->setCurrentIndex(index); //Resets the states to the defaults.
+    }
+    ui->statesBox->setValue(2);
+    ui->radiusBox->setValue(1);
+    ui->Bstates->setText(birth);
+    setBStates(birth);
+    ui->Sstates->setText(survival);
+    setSStates(survival);
+    ui->labelInfo->setText("Rule B" + birth + "/S" + survival + " loaded from the explorer.");
+}
+
+void MainWindow::addExploredRule(QString birth, QString survival, char neighMode)
+{
+    //Loads a rule from the explorer and saves it as a ruleset named after it.
+    applyRule(birth, survival, neighMode);
+    QList<QString> rule = getRuleSet();
+    if(rulesetExists(rule) > -1){
+        return; //Already saved, ruleSwich() selected it.
+    }
+    rule[3] = "B" + birth + "_S" + survival;
+    rulesets.append(rule);
+    writeRulesets();
+    readRulesets();
+    ruleSwich();
+    ui->labelInfo->setText("Ruleset \"" + rule[3] + "\"(" + "B" + rule[0] + "/S" + rule[1] + ") added.");
+}
+
 void MainWindow::ruleSwich()
 {
     //Detects if input ruleset already exists and switches combobox to it or placeholder.
@@ -566,6 +1320,10 @@ void MainWindow::setNeighMode(int index)
         ui->Bstates->setValidator( new QRegExpValidator(reg4, this) );
         ui->Sstates->setValidator( new QRegExpValidator(reg4, this) );
     }
+    if(ui->radiusBox->value() > 1){
+        ui->Bstates->setValidator( new QRegExpValidator(regWide, this) );
+        ui->Sstates->setValidator( new QRegExpValidator(regWide, this) );
+    }
     //reset states to avoid conflict:
     ui->Bstates->setText(defBstates);
     ui->Sstates->setText(defSstates);
@@ -578,6 +1336,45 @@ void MainWindow::setEdgeMode(bool state)
     else{game->setEdgeMode('p');}
 }
 
+void MainWindow::setRadius(int r)
+//Neighbourhood radius. Above 1 (Larger than Life) the states are counts and ranges.
+{
+    if(state)
+    {
+        startStopGame();
+    }
+    game->setRadius(r);
+    ui->middleCheck->setEnabled(r > 1);
+    QRegExp reg = r > 1 ? regWide : (ui->modeBox->currentIndex() == 1 ? reg4 : reg8);
+    ui->Bstates->setValidator( new QRegExpValidator(reg, this) );
+    ui->Sstates->setValidator( new QRegExpValidator(reg, this) );
+    //reset states to avoid conflict:
+    ui->Bstates->setText(defBstates);
+    ui->Sstates->setText(defSstates);
+    ruleSwich(); //Compare new ruleset.
+}
+
+void MainWindow::setMiddleCounted(bool counted)
+{
+    game->setMiddleCounted(counted);
+    ruleSwich(); //Compare new ruleset.
+}
+
+void MainWindow::setStates(int n)
+//Cell states. Above 2 (Generations) the rule uses the radius 1 neighbour counts.
+{
+    if(state)
+    {
+        startStopGame();
+    }
+    if(n > 2){
+        ui->radiusBox->setValue(1);
+    }
+    ui->radiusBox->setEnabled(n == 2);
+    game->setStates(n);
+    ruleSwich(); //Compare new ruleset.
+}
+
 
 void MainWindow::setBStates(QString b)
 //handler for rule lineedit input. Converts string to a sorted number array without duplicates.
@@ -586,6 +1383,19 @@ void MainWindow::setBStates(QString b)
     {
         startStopGame();
     }
+    if(ui->radiusBox->value() > 1){
+        //Counts and ranges, the text is kept as typed.
+        game->setBirthStates(LifeEngine::parseStates(b, true));
+        ruleSwich(); //Compare new ruleset.
+        return;
+    }
+    if(!HenselRule::isTotalistic(b)){
+        //Isotropic conditions, the text is kept as typed.
+        if(game->setBirthConditions(b)){
+            ruleSwich(); //Compare new ruleset.
+        }
+        return;
+    }
     //Read Regex validated string.
     QList<int> array;
     foreach(QChar c, b){
@@ -616,6 +1426,19 @@ void MainWindow::setSStates(QString s)
         startStopGame();
     }
     game->stopGame();
+    if(ui->radiusBox->value() > 1){
+        //Counts and ranges, the text is kept as typed.
+        game->setSurvStates(LifeEngine::parseStates(s, true));
+        ruleSwich(); //Compare new ruleset.
+        return;
+    }
+    if(!HenselRule::isTotalistic(s)){
+        //Isotropic conditions, the text is kept as typed.
+        if(game->setSurvConditions(s)){
+            ruleSwich(); //Compare new ruleset.
+        }
+        return;
+    }
     //Read Regex validated string.
     QList<int> array;
     foreach(QChar c, s){
@@ -681,6 +1504,24 @@ void MainWindow::showCoord(int x, int y)
     ui->lcdY->display(y);
 }
 
+void MainWindow::showMemory()
+{
+    //Cells of every tab, with their scratch buffers and history.
+    ui->labelMemory->setText("Memory: " + MemoryUsage::summary());
+    QStringList kinds;
+    for(int i = 0; i < MemoryUsage::KindCount; i++){
+        MemoryUsage::Kind kind = (MemoryUsage::Kind)i;
+        kinds << MemoryUsage::kindName(kind) + ": " + MemoryUsage::format(MemoryUsage::current(kind));
+    }
+    ui->labelMemory->setToolTip("Memory held by the engines' cells, current (peak, right-click to reset)\n" + kinds.join("\n"));
+}
+
+void MainWindow::resetMemoryPeak()
+{
+    MemoryUsage::resetPeak();
+    showMemory();
+}
+
 void MainWindow::gridResize()
 {
     //Used only for resize when the grid dimensions change.
@@ -690,6 +1531,8 @@ void MainWindow::gridResize()
     if(gridRatio > 300){
         gridRatio = 300;
     }
+    game->setUniverseHeight(ui->heightControl->value());
+    game->setUniverseWidth(ui->widthControl->value());
     game->clear();
     game->resize(game->getUniverseWidth() * gridRatio, game->getUniverseHeight() * gridRatio);
 }
@@ -4,8 +4,12 @@
 #include <QMainWindow>
 #include "gamewidget.h"
 #include "infodialog.h"
+#include "patternindex.h"
+#include "ruleexplorer.h"
+#include "censusdock.h"
 #include <QFileSystemModel>
 #include <QScrollBar>
+#include <QTabBar>
 
 namespace Ui {
 class MainWindow;
@@ -31,6 +35,9 @@ public slots:
     void setSStates(QString s); //Rule input
     void setNeighMode(int index); //Mode selector
     void setEdgeMode(bool state); //Mode selector
+    void setRadius(int r); //Radius selector
+    void setMiddleCounted(bool counted); //Self checkbox
+    void setStates(int n); //States selector
     void adjustScrollBar(QScrollBar *scrollBar, double factor, double offset); //Adjuster to follow cursor point on zoom.
     //Mouse wheel / arrow key on grid responses:
     void zoomIn();
@@ -41,12 +48,23 @@ public slots:
     void scrollLt();
     void scaleGame(double factor); //Zoom in/out
     void setInterval(int ms);
+    void jumpToGeneration(); //History prompt
+    void offerResume(); //Startup checkpoint prompt
+    void toggleRecording(bool on); //Record button
+    void exportRecording(); //Recording export prompt
+    void setHudVisible(bool on); //Performance overlay of the shown game
+    void exportTimings(); //Performance overlay CSV prompt
     //---------------
     void showCoord(int x, int y);//Display
+    void showMemory();//Display, every second
+    void resetMemoryPeak();//Memory label context menu
     void setTreeRoot();//Root path button
     void selectRuleset(int index); //Ruleset selector
     void addRuleset(); //Add ruleset button
     void removeRuleset(); //Remove ruleset button
+    void exploreRules(); //Rule explorer button
+    void applyRule(QString birth, QString survival, char neighMode); //Rule explorer row
+    void addExploredRule(QString birth, QString survival, char neighMode); //Rule explorer add button
     void showInfo(); //Status label
     void readDefaults(); //.ini file handler
     void readRulesets(); //.ini file handler
@@ -54,6 +72,21 @@ public slots:
     QList<QString> getRuleSet(); //Reads active ruleset.
     int rulesetExists(QList<QString> rule); //Active ruleset vs saved rulesets.
     void ruleSwich(); //Ruleset auto compare.
+    void treeMenu(const QPoint &pos); //Tree view context menu.
+    void showMatches(QString title, QStringList files); //Pattern index results.
+    void findPattern(); //Find pattern prompt
+    void findPattern(QString filename); //Marks and lists the copies of a pattern file on the board.
+    void findSelection(); //Same with the selected cells.
+    void toggleTiled(); //Out-of-core board prompt
+    void toggleSharing(); //Shared memory frames prompt
+    void randomFill(); //Random soup prompt
+    void chooseSymmetry(); //Symmetric stepping prompt
+    void gameStopped(); //Game stopped by itself
+    void newGame(); //New tab
+    void selectGame(int index); //Tab bar
+    void closeGame(); //Close the shown tab
+    void closeGame(int index); //Tab close button
+    void editSelection(QString edit); //Selection shortcuts
 
 
 private slots:
@@ -63,10 +96,17 @@ private:
     bool state; //Is game running?
     Ui::MainWindow *ui; //Form
     QColor currentColor; //Cells color
-    GameWidget* game; //Custom widget
+    GameWidget* game; //Custom widget, the one shown
+    QList<GameWidget*> games; //One per tab
+    QTabBar *tabs; //Universe tabs
+    int tabCount; //Tabs opened so far, for their names
     QFileSystemModel *treeModel; //Tree's model
+    PatternIndex *patternIndex; //Canonical hash index of the tree's patterns
+    RuleExplorer *ruleExplorer; //Rule space survey window, made on first use
+    CensusDock *censusDock; //Object census panel
     QRegExp reg8; //Regex filter for rule input
     QRegExp reg4; //Regex filter for rule input
+    QRegExp regWide; //Regex filter for rule input, radius > 1
     float gridRatio; //Scaling ratio nb(cells) -> size(px)
     QString treeRoot; //Root of the tree model
     QString curPath; //Save/Load path
@@ -76,6 +116,10 @@ private:
     QString defBstates; //default string for rule
     QString defSstates; //default string for rule
     QList<QList<QString> > rulesets; //Rulesets collection
+
+    void bindGame(bool on); //Connects the controls to the shown game, or not
+    void showGame(); //Controls from the shown game
+    void findCopies(const BitGrid &cells, const QString &title); //Marks and lists the copies of cells on the board.
 };
 
 #endif // MAINWINDOW_H
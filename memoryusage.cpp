@@ -0,0 +1,73 @@
+#include <QAtomicInteger>
+#include "memoryusage.h"
+
+static QAtomicInteger<qint64> byKind[MemoryUsage::KindCount];
+static QAtomicInteger<qint64> total;
+static QAtomicInteger<qint64> highest;
+
+
+//Counting:
+void MemoryUsage::add(Kind kind, qint64 bytes)
+{
+    if(bytes == 0){
+        return;
+    }
+    byKind[kind].fetchAndAddRelaxed(bytes);
+    qint64 now = total.fetchAndAddRelaxed(bytes) + bytes;
+    qint64 top = highest.loadAcquire();
+    while(now > top && !highest.testAndSetOrdered(top, now, top)){
+        //Another thread raised it meanwhile: top now holds its value.
+    }
+}
+
+qint64 MemoryUsage::current()
+{
+    return total.loadAcquire();
+}
+
+qint64 MemoryUsage::current(Kind kind)
+{
+    return byKind[kind].loadAcquire();
+}
+
+qint64 MemoryUsage::peak()
+{
+    return highest.loadAcquire();
+}
+
+void MemoryUsage::resetPeak()
+{
+    highest.storeRelease(total.loadAcquire());
+}
+
+
+//Descriptions:
+QString MemoryUsage::kindName(Kind kind)
+{
+    switch(kind){
+    case Board: return "board";
+    case Scratch: return "scratch";
+    case History: return "history";
+    default: return QString();
+    }
+}
+
+QString MemoryUsage::format(qint64 bytes)
+{
+    if(bytes < 1024){
+        return QString::number(bytes) + " B";
+    }
+    static const char *units[] = { "KiB", "MiB", "GiB", "TiB" };
+    double v = bytes / 1024.0;
+    int u = 0;
+    while(v >= 1024 && u < 3){
+        v /= 1024;
+        u++;
+    }
+    return QString::number(v, 'f', 1) + " " + units[u];
+}
+
+QString MemoryUsage::summary()
+{
+    return format(current()) + " (peak " + format(peak()) + ")";
+}
@@ -0,0 +1,34 @@
+#ifndef MEMORYUSAGE_H
+#define MEMORYUSAGE_H
+
+#include <QString>
+
+/**
+  *
+  * Process-wide count of the bytes held by the cells of the engines, current and peak.
+  * Every board buffer (see CellBuffer) adds its size here when it is allocated and takes it
+  * back when it is freed; the generation history and the look-ahead frames report theirs.
+  * Short-lived BitGrid copies (clipboard, snapshots) are left out. Counts are atomic, as
+  * the engines are stepped and resized from worker threads.
+  *   Board    the current generation of every universe
+  *   Scratch  next generations, prefix tables, neighbour planes, and engines working on
+  *            a copy of a game (look-ahead, census, rule survey)
+  *   History  previous generations
+ */
+
+class MemoryUsage
+{
+public:
+    enum Kind { Board, Scratch, History, KindCount };
+
+    static void add(Kind kind, qint64 bytes); // negative when freed
+    static qint64 current(); // every kind
+    static qint64 current(Kind kind);
+    static qint64 peak(); // highest current() so far
+    static void resetPeak(); // to current()
+    static QString kindName(Kind kind); // "board", "scratch", "history"
+    static QString format(qint64 bytes); // "512 B", "12.4 KiB", "3.1 MiB"...
+    static QString summary(); // "12.4 MiB (peak 40.1 MiB)", for status lines
+};
+
+#endif // MEMORYUSAGE_H
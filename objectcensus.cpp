@@ -0,0 +1,445 @@
+#include <QStringList>
+#include "objectcensus.h"
+#include "lifeengine.h"
+
+//Union-find over cell indices, the root of a set is its smallest index.
+static int findRoot(QVector<int> &parent, int i)
+{
+    while(parent[i] != i){
+        parent[i] = parent[parent[i]]; //Path halving.
+        i = parent[i];
+    }
+    return i;
+}
+
+static void unite(QVector<int> &parent, int a, int b)
+{
+    a = findRoot(parent, a);
+    b = findRoot(parent, b);
+    if(a != b){
+        parent[qMax(a, b)] = qMin(a, b);
+    }
+}
+
+static bool pointLess(const QPoint &a, const QPoint &b)
+{
+    return a.y() != b.y() ? a.y() < b.y() : a.x() < b.x();
+}
+
+static QVector<QPoint> normalized(QVector<QPoint> cells, QPoint *origin = 0)
+{
+    //Moved to (0,0) and sorted, so equal shapes compare equal.
+    if(cells.isEmpty()){
+        return cells;
+    }
+    int x0 = cells[0].x();
+    int y0 = cells[0].y();
+    foreach(QPoint p, cells){
+        x0 = qMin(x0, p.x());
+        y0 = qMin(y0, p.y());
+    }
+    for(int i = 0; i < cells.size(); i++){
+        cells[i] -= QPoint(x0, y0);
+    }
+    qSort(cells.begin(), cells.end(), pointLess);
+    if(origin){
+        *origin = QPoint(x0, y0);
+    }
+    return cells;
+}
+
+static void unwrap(QVector<QPoint> &cells, int h, int w)
+{
+    //On a torus, rows and columns start after one the object doesn't use (if any),
+    //so an object lying across an edge keeps its shape.
+    QVector<bool> rows(h, false);
+    QVector<bool> columns(w, false);
+    foreach(QPoint p, cells){
+        rows[p.y()] = true;
+        columns[p.x()] = true;
+    }
+    int r = rows.indexOf(false);
+    int c = columns.indexOf(false);
+    int dy = r >= 0 ? h - r - 1 : 0;
+    int dx = c >= 0 ? w - c - 1 : 0;
+    for(int i = 0; i < cells.size(); i++){
+        cells[i] = QPoint((cells[i].x() + dx) % w, (cells[i].y() + dy) % h);
+    }
+}
+
+static QVector<QPoint> liveCells(const BitGrid &board)
+{
+    QVector<QPoint> cells;
+    for(int k = 0; k < board.height(); k++){
+        const quint64 *row = board.row(k);
+        for(int i = 0; i < board.wordsPerRow(); i++){
+            for(quint64 x = row[i]; x; x &= x - 1){
+                cells.append(QPoint(i * 64 + qCountTrailingZeroBits(x), k));
+            }
+        }
+    }
+    return cells;
+}
+
+static BitGrid dilated(const BitGrid &board, bool torus)
+{
+    //Every live cell spread to its 8 neighbours.
+    int h = board.height();
+    int w = board.width();
+    int wpr = board.wordsPerRow();
+    BitGrid wide(h, w);
+    for(int k = 0; k < h; k++){
+        const quint64 *row = board.row(k);
+        quint64 *out = wide.row(k);
+        for(int i = 0; i < wpr; i++){
+            quint64 west = i > 0 ? row[i - 1] >> 63 : 0;
+            quint64 east = i + 1 < wpr ? row[i + 1] << 63 : 0;
+            out[i] = row[i] | (row[i] << 1) | west | (row[i] >> 1) | east;
+        }
+        if(torus && w > 1){
+            //Across the side edges.
+            if(board.cell(k, w - 1)){ out[0] |= 1; }
+            if(board.cell(k, 0)){ out[(w - 1) / 64] |= Q_UINT64_C(1) << ((w - 1) % 64); }
+        }
+        if(w % 64){
+            out[wpr - 1] &= (Q_UINT64_C(1) << (w % 64)) - 1; //Padding stays dead.
+        }
+    }
+    BitGrid spread(h, w);
+    for(int k = 0; k < h; k++){
+        quint64 *out = spread.row(k);
+        for(int dk = -1; dk <= 1; dk++){
+            int r = k + dk;
+            if(torus){
+                r = (r + h) % h;
+            } else if(r < 0 || r >= h){
+                continue;
+            }
+            const quint64 *row = wide.row(r);
+            for(int i = 0; i < wpr; i++){
+                out[i] |= row[i];
+            }
+        }
+    }
+    return spread;
+}
+
+static QString shapeText(const QVector<QPoint> &shape)
+{
+    //Normalized cells as text, the same shape anywhere gives the same text.
+    QString text;
+    foreach(QPoint p, shape){
+        text += QString("%1,%2;").arg(p.x()).arg(p.y());
+    }
+    return text;
+}
+
+static bool moreCommon(const ObjectCensus::Object &a, const ObjectCensus::Object &b)
+{
+    return a.count != b.count ? a.count > b.count : a.cells < b.cells;
+}
+
+static int gcd(int a, int b)
+{
+    while(b){
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+
+QVector<int> ObjectCensus::label(const BitGrid &board, bool torus, int &count)
+{
+    int h = board.height();
+    int w = board.width();
+    QVector<int> parent(h * w, -1);
+    for(int k = 0; k < h; k++){
+        const quint64 *row = board.row(k);
+        for(int i = 0; i < board.wordsPerRow(); i++){
+            for(quint64 x = row[i]; x; x &= x - 1){
+                int j = i * 64 + qCountTrailingZeroBits(x);
+                int c = k * w + j;
+                parent[c] = c;
+                //Neighbours already visited: west, then the three above.
+                if(j > 0 && parent[c - 1] >= 0){
+                    unite(parent, c, c - 1);
+                }
+                for(int dj = -1; k > 0 && dj <= 1; dj++){
+                    int n = c - w + dj;
+                    if(j + dj >= 0 && j + dj < w && parent[n] >= 0){
+                        unite(parent, c, n);
+                    }
+                }
+            }
+        }
+    }
+    if(torus && h > 0 && w > 0){
+        //Across the edges: the last row with the first one, the last column with the first one.
+        for(int j = 0; j < w; j++){
+            int c = (h - 1) * w + j;
+            for(int dj = -1; parent[c] >= 0 && dj <= 1; dj++){
+                int n = (j + dj + w) % w;
+                if(parent[n] >= 0){ unite(parent, c, n); }
+            }
+        }
+        for(int k = 0; k < h; k++){
+            int c = k * w + w - 1;
+            for(int dk = -1; parent[c] >= 0 && dk <= 1; dk++){
+                int n = ((k + dk + h) % h) * w;
+                if(parent[n] >= 0){ unite(parent, c, n); }
+            }
+        }
+    }
+    //Roots numbered in reading order, a root comes before the rest of its set.
+    count = 0;
+    QVector<int> labels(h * w, -1);
+    for(int c = 0; c < h * w; c++){
+        if(parent[c] >= 0){
+            int r = findRoot(parent, c);
+            labels[c] = r == c ? count++ : labels[r];
+        }
+    }
+    return labels;
+}
+
+QString ObjectCensus::canonical(const QVector<QPoint> &cells)
+{
+    QString best;
+    for(int t = 0; t < 8; t++){
+        QVector<QPoint> moved;
+        foreach(QPoint p, cells){
+            int x = p.x();
+            int y = p.y();
+            if(t & 1){ x = -x; }
+            if(t & 2){ y = -y; }
+            if(t & 4){ qSwap(x, y); }
+            moved.append(QPoint(x, y));
+        }
+        moved = normalized(moved);
+        int w = 0;
+        int h = 0;
+        foreach(QPoint p, moved){
+            w = qMax(w, p.x() + 1);
+            h = qMax(h, p.y() + 1);
+        }
+        QStringList rows;
+        for(int k = 0; k < h; k++){
+            rows << QString(w, '.');
+        }
+        foreach(QPoint p, moved){
+            rows[p.y()][p.x()] = 'o';
+        }
+        QString form = QString("%1x%2:").arg(w).arg(h) + rows.join("$");
+        if(best.isEmpty() || form < best){
+            best = form;
+        }
+    }
+    return best;
+}
+
+QList<ObjectCensus::Object> ObjectCensus::objects(const Input &in)
+{
+    int h = in.board.height();
+    int w = in.board.width();
+    bool torus = in.edgeMode == 't';
+
+    //Objects are the parts of the envelope of the next generations, widened by a cell
+    //so cells two apart (the back of a spaceship, the parts of an oscillator) stay
+    //together. Kept short not to join passing objects.
+    LifeEngine engine(h, w, MemoryUsage::Scratch); //A copy of the game: its board is counted once.
+    engine.setThreadCount(1); //Already on a worker thread.
+    engine.setNeighMode(in.neighMode); //Larger than Life rules carry their own.
+    engine.setRule(in.rule);
+    engine.setEdgeMode(in.edgeMode);
+    engine.setBoard(in.board);
+    BitGrid envelope = in.board;
+    for(int g = 0; g < envelopeGenerations; g++){
+        engine.step();
+        BitGrid now = engine.board();
+        QVector<quint64> &e = envelope.words();
+        const QVector<quint64> &b = now.words();
+        for(int i = 0; i < e.size(); i++){
+            e[i] |= b[i];
+        }
+    }
+    int total;
+    QVector<int> labels = label(dilated(envelope, torus), torus, total);
+    QVector<QVector<QPoint> > cells(total);
+    foreach(QPoint p, liveCells(in.board)){
+        cells[labels[p.y() * w + p.x()]].append(p);
+    }
+
+    //Each object is then run alone on a plane wide enough for it not to reach the edges
+    //(even at c), once per shape.
+    QHash<QString, Object> shapes;
+    QList<Object> list;
+    int margin = in.maxPeriod + 2;
+    for(int o = 0; o < total; o++){
+        if(cells[o].isEmpty()){
+            continue; //Only born later (B0 rules).
+        }
+        if(torus){
+            unwrap(cells[o], h, w);
+        }
+        QVector<QPoint> first = normalized(cells[o]);
+        QString shape = shapeText(first);
+        if(shapes.contains(shape)){
+            list << shapes.value(shape);
+            continue;
+        }
+        int bw = 0;
+        int bh = 0;
+        foreach(QPoint p, first){
+            bw = qMax(bw, p.x() + 1);
+            bh = qMax(bh, p.y() + 1);
+        }
+        BitGrid alone(bh + 2 * margin, bw + 2 * margin);
+        foreach(QPoint p, first){
+            alone.setCell(p.y() + margin, p.x() + margin, true);
+        }
+        LifeEngine single(alone.height(), alone.width(), MemoryUsage::Scratch);
+        single.setThreadCount(1);
+        single.setNeighMode(in.neighMode);
+        single.setRule(in.rule);
+        single.setEdgeMode('p');
+        single.setBoard(alone);
+
+        Object obj;
+        obj.cells = first.size();
+        obj.count = 1;
+        QList<QVector<QPoint> > phases;
+        phases << first;
+        for(int p = 1; p <= in.maxPeriod; p++){
+            single.step();
+            QVector<QPoint> now = liveCells(single.board());
+            if(now.isEmpty()){
+                break; //Died out.
+            }
+            QPoint to;
+            if(now.size() != first.size() || normalized(now, &to) != first){
+                phases << now;
+                continue;
+            }
+            QPoint d = to - QPoint(margin, margin);
+            if(d.isNull()){
+                obj.type = p == 1 ? StillLife : Oscillator;
+            } else {
+                obj.type = Spaceship;
+                obj.dx = qMax(qAbs(d.x()), qAbs(d.y()));
+                obj.dy = qMin(qAbs(d.x()), qAbs(d.y()));
+            }
+            obj.period = p;
+            break;
+        }
+        int forms = obj.type == Unsettled ? 1 : obj.period;
+        for(int p = 0; p < forms; p++){
+            QString key = canonical(phases[p]);
+            if(obj.key.isEmpty() || key < obj.key){
+                obj.key = key;
+            }
+        }
+        shapes.insert(shape, obj);
+        list << obj;
+    }
+    return list;
+}
+
+ObjectCensus::Result ObjectCensus::take(const Input &in)
+{
+    Result r;
+    r.generation = in.generation;
+    r.population = in.board.population();
+    QList<Object> list = objects(in);
+    static const QHash<QString, QString> known = names(); //Made once, thread-safe.
+    bool life = in.neighMode == 'm' && in.rule == "B3/S23";
+    QHash<QString, int> rows; // kind -> index in the census
+    foreach(Object o, list){
+        QString kind = o.key + "|" + QString::number(o.type) + "|" + QString::number(o.period);
+        if(rows.contains(kind)){
+            r.census[rows.value(kind)].count++;
+            continue;
+        }
+        if(life){
+            o.name = known.value(o.key);
+        }
+        rows.insert(kind, r.census.size());
+        r.census << o;
+    }
+    r.objects = list.size();
+    qSort(r.census.begin(), r.census.end(), moreCommon);
+    return r;
+}
+
+QHash<QString, QString> ObjectCensus::names()
+{
+    //Keys found by a census of each object alone.
+    static const char *known[][2] = {
+        { "block", "oo$oo" },
+        { "beehive", ".oo.$o..o$.oo." },
+        { "loaf", ".oo.$o..o$.o.o$..o." },
+        { "boat", "oo.$o.o$.o." },
+        { "ship", "oo.$o.o$.oo" },
+        { "tub", ".o.$o.o$.o." },
+        { "pond", ".oo.$o..o$o..o$.oo." },
+        { "long boat", "oo..$o.o.$.o.o$..o." },
+        { "barge", ".o..$o.o.$.o.o$..o." },
+        { "mango", ".oo..$o..o.$.o..o$..oo." },
+        { "aircraft carrier", "oo..$o..o$..oo" },
+        { "snake", "oo.o$o.oo" },
+        { "eater 1", "oo..$o.o.$..o.$..oo" },
+        { "blinker", "ooo" },
+        { "toad", ".ooo$ooo." },
+        { "beacon", "oo..$oo..$..oo$..oo" },
+        { "clock", "..o.$o.o.$.o.o$.o.." },
+        { "pulsar", "..ooo...ooo..$.............$o....o.o....o$o....o.o....o$o....o.o....o$..ooo...ooo..$"
+                    ".............$..ooo...ooo..$o....o.o....o$o....o.o....o$o....o.o....o$.............$..ooo...ooo.." },
+        { "pentadecathlon", "..o....o..$oo.oooo.oo$..o....o.." },
+        { "glider", ".o.$..o$ooo" },
+        { "lightweight spaceship", ".o..o$o....$o...o$oooo." },
+        { "middleweight spaceship", "...o..$.o...o$o.....$o....o$ooooo." },
+        { "heavyweight spaceship", "...oo..$.o....o$o......$o.....o$oooooo." }
+    };
+    QHash<QString, QString> found;
+    for(unsigned n = 0; n < sizeof(known) / sizeof(known[0]); n++){
+        QStringList rows = QString(known[n][1]).split('$');
+        int margin = 4;
+        Input in;
+        in.rule = "B3/S23";
+        in.maxPeriod = 16;
+        in.board = BitGrid(rows.size() + 2 * margin, rows[0].size() + 2 * margin);
+        for(int k = 0; k < rows.size(); k++){
+            for(int j = 0; j < rows[k].size(); j++){
+                if(rows[k][j] == 'o'){ in.board.setCell(k + margin, j + margin, true); }
+            }
+        }
+        QList<Object> list = objects(in);
+        if(list.size() == 1){
+            found.insert(list[0].key, known[n][0]);
+        }
+    }
+    return found;
+}
+
+QString ObjectCensus::className(Class c)
+{
+    switch(c){
+    case StillLife: return "still life";
+    case Oscillator: return "oscillator";
+    case Spaceship: return "spaceship";
+    default: return "unsettled";
+    }
+}
+
+QString ObjectCensus::velocity(const Object &o)
+{
+    if(o.type != Spaceship || o.period == 0){
+        return QString();
+    }
+    int g = gcd(o.dx, o.period);
+    int n = o.dx / g;
+    int d = o.period / g;
+    QString speed = (n == 1 ? QString("c") : QString::number(n) + "c") + (d == 1 ? QString() : "/" + QString::number(d));
+    return speed + (o.dy == 0 ? " orthogonal" : (o.dy == o.dx ? " diagonal" : " oblique"));
+}
@@ -0,0 +1,75 @@
+#ifndef OBJECTCENSUS_H
+#define OBJECTCENSUS_H
+
+#include <QString>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QPoint>
+#include "bitgrid.h"
+
+/**
+  *
+  * Census of the objects a board has settled into. The board is run for a few generations;
+  * the live cells of all of them are OR-ed into an envelope, widened by a cell, whose
+  * connected components (union-find over the live cells, 8-connected, across the edges
+  * on a torus) are the objects, so the parts of an oscillator stay together.
+  * Each object is then followed alone:
+  *   still life  the same cells one generation later
+  *   oscillator  the same cells after its period
+  *   spaceship   the same shape, moved, after its period
+  *   unsettled   none of those within the generations run
+  * Objects are counted by canonical form: the smallest over their phases and the 8
+  * rotations/reflections of "WxH:" rows of 'o'/'.' joined by '$'.
+  * take() is self-contained so it can run on a worker thread.
+ */
+
+class ObjectCensus
+{
+public:
+    enum Class { StillLife, Oscillator, Spaceship, Unsettled };
+
+    struct Input {
+        Input() : neighMode('m'), edgeMode('p'), generation(0), maxPeriod(60) {}
+        BitGrid board;
+        QString rule; // LifeEngine::rule()
+        char neighMode;
+        char edgeMode;
+        int generation; // of the board, reported back
+        int maxPeriod; // generations each object is followed
+    };
+
+    struct Object {
+        Object() : type(Unsettled), period(0), dx(0), dy(0), cells(0), count(0) {}
+        QString key; // canonical form
+        QString name; // common name under B3/S23, empty if unknown
+        Class type;
+        int period; // oscillators and spaceships
+        int dx; // spaceships: cells moved per period, dx >= dy >= 0
+        int dy;
+        int cells; // population when the census was taken
+        int count; // objects of this kind
+    };
+
+    struct Result {
+        Result() : generation(0), objects(0), population(0) {}
+        int generation;
+        int objects;
+        int population;
+        QList<Object> census; // most common first
+    };
+
+    static Result take(const Input &in);
+    static QVector<int> label(const BitGrid &board, bool torus, int &count); // component of each cell (row major), -1 if dead
+    static QString canonical(const QVector<QPoint> &cells); // smallest form over the 8 symmetries
+    static QString className(Class c);
+    static QString velocity(const Object &o); // "c/4 diagonal", empty if not a spaceship
+
+private:
+    enum { envelopeGenerations = 2 };
+
+    static QList<Object> objects(const Input &in); // one per object, counts of 1
+    static QHash<QString, QString> names(); // key -> common B3/S23 name
+};
+
+#endif // OBJECTCENSUS_H
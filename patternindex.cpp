@@ -0,0 +1,274 @@
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileSystemWatcher>
+#include <QTextStream>
+#include <QCryptographicHash>
+#include <QVector>
+#include "patternindex.h"
+
+
+//Constructor:
+PatternIndex::PatternIndex(QObject *parent) :
+    QObject(parent),
+    watcher(new QFileSystemWatcher(this))
+{
+    connect(watcher, SIGNAL(directoryChanged(QString)), this, SLOT(directoryChanged(QString)));
+    connect(watcher, SIGNAL(fileChanged(QString)), this, SLOT(fileChanged(QString)));
+}
+
+
+//Canonical form:
+static void appendSize(QByteArray &form, int n)
+{
+    //Big endian so that byte order comparison is size order.
+    form.append(char((n >> 24) & 0xff));
+    form.append(char((n >> 16) & 0xff));
+    form.append(char((n >> 8) & 0xff));
+    form.append(char(n & 0xff));
+}
+
+QByteArray PatternIndex::canonicalKey(const QString &dump)
+/**
+  The dump is cropped to the bounding box of its live cells, then each of the 8
+  symmetries of the square (t bit 2: transpose, bit 1: flip rows, bit 0: flip columns)
+  is serialized as height, width and the cells packed 8 per byte in row order.
+  The smallest serialization is the canonical form, its SHA-1 is the key.
+*/
+{
+    QStringList rows = dump.split('\n', QString::SkipEmptyParts);
+    int top = rows.size(), bottom = -1, left = -1, right = -1;
+    for(int k = 0; k < rows.size(); k++){
+        for(int j = 0; j < rows[k].size(); j++){
+            if(rows[k][j] == '*'){
+                if(k < top){ top = k; }
+                bottom = k;
+                if(left < 0 || j < left){ left = j; }
+                if(j > right){ right = j; }
+            }
+        }
+    }
+    if(bottom < 0){
+        return QByteArray(); //Nothing to index on an empty board.
+    }
+    int h = bottom - top + 1;
+    int w = right - left + 1;
+    QVector<bool> cells(h * w, false);
+    for(int k = 0; k < h; k++){
+        const QString &row = rows[top + k];
+        for(int j = 0; j < w && left + j < row.size(); j++){
+            cells[k * w + j] = (row[left + j] == '*');
+        }
+    }
+
+    QByteArray best;
+    for(int t = 0; t < 8; t++){
+        bool transpose = t & 4;
+        int th = transpose ? w : h; // transformed height
+        int tw = transpose ? h : w; // transformed width
+        QByteArray form;
+        form.reserve(8 + (th * tw + 7) / 8);
+        appendSize(form, th);
+        appendSize(form, tw);
+        uchar byte = 0;
+        int nbits = 0;
+        for(int k = 0; k < th; k++){
+            for(int j = 0; j < tw; j++){
+                int sk = transpose ? j : k; // source row
+                int sj = transpose ? k : j; // source column
+                if(t & 2){ sk = h - 1 - sk; }
+                if(t & 1){ sj = w - 1 - sj; }
+                byte = (byte << 1) | (cells[sk * w + sj] ? 1 : 0);
+                if(++nbits == 8){
+                    form.append(char(byte));
+                    byte = 0;
+                    nbits = 0;
+                }
+            }
+        }
+        if(nbits > 0){
+            form.append(char(byte << (8 - nbits)));
+        }
+        if(best.isEmpty() || form < best){
+            best = form;
+        }
+    }
+    return QCryptographicHash::hash(best, QCryptographicHash::Sha1);
+}
+
+QByteArray PatternIndex::fileKey(const QString &filename)
+{
+    //Reads the dump section of a .laut file, same layout as MainWindow::readGame().
+    QFile file(filename);
+    if(!filename.endsWith(".laut") || !file.open(QIODevice::ReadOnly)){
+        return QByteArray();
+    }
+    QTextStream in(&file);
+    QString tmp;
+    in >> tmp; //Ruleset.
+    in >> tmp; //Grid dimensions.
+    QStringList dims = tmp.split('|');
+    if(dims.size() < 2){
+        return QByteArray();
+    }
+    int h = dims[0].toInt();
+    in >> tmp; //Edge mode.
+    QString dump;
+    for(int k = 0; k < h && !in.atEnd(); k++){
+        in >> tmp;
+        dump.append(tmp + "\n");
+    }
+    file.close();
+    return canonicalKey(dump);
+}
+
+
+//Queries:
+QStringList PatternIndex::filesFor(const QByteArray &key) const
+{
+    return objects.value(key);
+}
+
+QStringList PatternIndex::duplicatesOf(const QString &filename) const
+{
+    QString path = QFileInfo(filename).absoluteFilePath();
+    QStringList same = objects.value(files.value(path).key);
+    same.removeAll(path);
+    return same;
+}
+
+QList<QStringList> PatternIndex::duplicateGroups() const
+{
+    QList<QStringList> groups;
+    QHash<QByteArray, QStringList>::const_iterator it;
+    for(it = objects.constBegin(); it != objects.constEnd(); ++it){
+        if(it.value().size() > 1){
+            groups.append(it.value());
+        }
+    }
+    return groups;
+}
+
+int PatternIndex::fileCount() const
+{
+    return files.size();
+}
+
+
+//Index maintenance:
+void PatternIndex::setRoot(const QString &path)
+{
+    if(!watcher->files().isEmpty()){ watcher->removePaths(watcher->files()); }
+    if(!watcher->directories().isEmpty()){ watcher->removePaths(watcher->directories()); }
+    files.clear();
+    objects.clear();
+    root = QFileInfo(path).absoluteFilePath();
+    rescan();
+}
+
+void PatternIndex::rescan()
+{
+    if(root.isEmpty() || !QDir(root).exists()){
+        return;
+    }
+    scanDirectory(root);
+    emit indexChanged(); //Always notify, the root itself may have changed.
+}
+
+bool PatternIndex::scanDirectory(const QString &path)
+{
+    //Watch every directory of the subtree so that added/removed files are seen.
+    QStringList dirs;
+    dirs << QFileInfo(path).absoluteFilePath();
+    QDirIterator d(path, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while(d.hasNext()){
+        dirs << QFileInfo(d.next()).absoluteFilePath();
+    }
+    foreach(QString dir, dirs){
+        if(!watcher->directories().contains(dir)){
+            watcher->addPath(dir);
+        }
+    }
+    //Only the files that are new or were modified since last time are read.
+    bool changed = false;
+    QDirIterator f(path, QStringList() << "*.laut", QDir::Files, QDirIterator::Subdirectories);
+    while(f.hasNext()){
+        changed |= indexFile(f.next());
+    }
+    return changed;
+}
+
+bool PatternIndex::indexFile(const QString &path)
+{
+    QFileInfo info(path);
+    QString p = info.absoluteFilePath();
+    if(!info.exists()){
+        return dropFile(p);
+    }
+    bool known = files.contains(p);
+    Entry old = files.value(p);
+    if(known && old.modified == info.lastModified() && old.size == info.size()){
+        return false; //Untouched since it was read.
+    }
+    Entry e;
+    e.key = fileKey(p);
+    e.modified = info.lastModified();
+    e.size = info.size();
+    files.insert(p, e);
+    if(!known){
+        watcher->addPath(p);
+    } else if(old.key == e.key){
+        return false; //Rewritten but still the same object.
+    } else if(!old.key.isEmpty()){
+        objects[old.key].removeAll(p);
+        if(objects[old.key].isEmpty()){ objects.remove(old.key); }
+    }
+    if(!e.key.isEmpty()){
+        objects[e.key].append(p);
+    }
+    return true;
+}
+
+bool PatternIndex::dropFile(const QString &path)
+{
+    if(!files.contains(path)){
+        return false;
+    }
+    QByteArray key = files.take(path).key;
+    watcher->removePath(path);
+    if(!key.isEmpty()){
+        objects[key].removeAll(path);
+        if(objects[key].isEmpty()){ objects.remove(key); }
+    }
+    return true;
+}
+
+void PatternIndex::directoryChanged(const QString &path)
+{
+    //A file or sub-directory was added, renamed or removed somewhere in path.
+    QString dir = QFileInfo(path).absoluteFilePath() + "/";
+    bool changed = false;
+    foreach(QString f, files.keys()){
+        if(f.startsWith(dir) && !QFile::exists(f)){
+            changed |= dropFile(f);
+        }
+    }
+    foreach(QString d, watcher->directories()){
+        if(!QDir(d).exists()){ watcher->removePath(d); }
+    }
+    if(QDir(path).exists()){
+        changed |= scanDirectory(path);
+    }
+    if(changed){
+        emit indexChanged();
+    }
+}
+
+void PatternIndex::fileChanged(const QString &path)
+{
+    //Contents rewritten in place (or file removed).
+    if(indexFile(path)){
+        emit indexChanged();
+    }
+}
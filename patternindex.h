@@ -0,0 +1,63 @@
+#ifndef PATTERNINDEX_H
+#define PATTERNINDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <QDateTime>
+
+class QFileSystemWatcher;
+
+/**
+  *
+  * Content-addressed index of the .laut patterns found under a root directory.
+  * Each pattern is cropped to its bounding box and reduced to the smallest of its
+  * 8 rotations/reflections before hashing, so the same object saved at another
+  * offset, orientation or grid size gets the same key.
+  * The index follows the file system and only re-reads the files that changed.
+ */
+
+class PatternIndex : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PatternIndex(QObject *parent = 0);
+
+    static QByteArray canonicalKey(const QString &dump); // key of a "o"/"*" dump, empty if no live cell
+    static QByteArray fileKey(const QString &filename); // key of a .laut file, empty if unreadable
+
+    QStringList filesFor(const QByteArray &key) const; // files holding that object
+    QStringList duplicatesOf(const QString &filename) const; // other files holding the same object
+    QList<QStringList> duplicateGroups() const; // every object saved more than once
+    int fileCount() const;
+
+public slots:
+    void setRoot(const QString &path); // (re)build the index over a new tree
+    void rescan(); // full refresh of the current tree
+
+signals:
+    void indexChanged();
+
+private slots:
+    void directoryChanged(const QString &path);
+    void fileChanged(const QString &path);
+
+private:
+    struct Entry {
+        Entry() : size(0) {}
+        QByteArray key;
+        QDateTime modified;
+        qint64 size;
+    };
+    QString root;
+    QFileSystemWatcher *watcher;
+    QHash<QString, Entry> files; // path -> canonical key
+    QHash<QByteArray, QStringList> objects; // canonical key -> paths
+
+    bool scanDirectory(const QString &path); // index a directory and its sub-directories, true if the index changed
+    bool indexFile(const QString &path); // (re)index one file, true if the index changed
+    bool dropFile(const QString &path); // forget one file, true if the index changed
+};
+
+#endif // PATTERNINDEX_H
@@ -0,0 +1,388 @@
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+#include "patternio.h"
+#include "lifeengine.h"
+
+
+//Dispatch:
+bool PatternIO::isSupported(const QString &filename)
+{
+    QString suffix = QFileInfo(filename).suffix().toLower();
+    return suffix == "laut" || suffix == "rle" || suffix == "cells";
+}
+
+bool PatternIO::read(const QString &filename, Pattern &p)
+{
+    QFile file(filename);
+    if(!isSupported(filename) || !file.open(QIODevice::ReadOnly)){
+        return false;
+    }
+    QTextStream in(&file);
+    QString suffix = QFileInfo(filename).suffix().toLower();
+    if(suffix == "laut"){ return readLaut(in, p); }
+    if(suffix == "rle"){ return readRle(in, p); }
+    return readPlaintext(in, p);
+}
+
+bool PatternIO::write(const QString &filename, const Pattern &p)
+{
+    QFile file(filename);
+    if(!isSupported(filename) || !file.open(QIODevice::WriteOnly | QIODevice::Truncate)){
+        return false;
+    }
+    QTextStream out(&file);
+    QString suffix = QFileInfo(filename).suffix().toLower();
+    if(suffix == "laut"){ writeLaut(out, p); }
+    else if(suffix == "rle"){ writeRle(out, p); }
+    else { writePlaintext(out, p); }
+    out.flush();
+    return file.error() == QFile::NoError;
+}
+
+
+//Rules:
+QString PatternIO::rule(const Pattern &p)
+{
+    if(p.states > 2){
+        return "B" + p.birth + "/S" + p.survival + "/C" + QString::number(p.states);
+    }
+    if(p.radius <= 1){
+        return "B" + p.birth + "/S" + p.survival;
+    }
+    LifeEngine e(1, 1);
+    e.setRadius(p.radius);
+    e.setMiddleCounted(p.middle);
+    e.setNeighMode(p.neighMode);
+    e.setBirthStates(LifeEngine::parseStates(p.birth, true));
+    e.setSurvivalStates(LifeEngine::parseStates(p.survival, true));
+    return e.rule();
+}
+
+bool PatternIO::setRule(Pattern &p, const QString &rule)
+{
+    LifeEngine e(1, 1);
+    e.setNeighMode(p.neighMode);
+    if(!e.setRule(rule)){
+        return false;
+    }
+    p.birth = e.birthConditions();
+    p.survival = e.survivalConditions();
+    p.neighMode = e.neighMode();
+    p.radius = e.radius();
+    p.middle = e.middleCounted();
+    p.states = e.states();
+    return true;
+}
+
+
+int PatternIO::state(const Pattern &p, int k, int j)
+{
+    if(p.states > 2 && p.cells.size() == p.board.height() * p.board.width()){
+        return p.cells[k * p.board.width() + j];
+    }
+    return p.board.cell(k, j);
+}
+
+
+//.laut:
+bool PatternIO::readLaut(QTextStream &in, Pattern &p)
+{
+    //Same layout as MainWindow::saveGame().
+    QString tmp;
+    in >> tmp;
+    QStringList tmpl = tmp.split('|');
+    if(tmpl.size() < 3){
+        return false;
+    }
+    p.birth = tmpl[0];
+    p.survival = tmpl[1];
+    p.neighMode = tmpl[2] == "m" ? 'm' : 'v';
+    p.radius = tmpl.size() > 3 ? qBound(1, tmpl[3].toInt(), (int)LifeEngine::MaxRadius) : 1;
+    p.middle = tmpl.size() > 4 && tmpl[4] == "1";
+    p.states = tmpl.size() > 5 ? qBound(2, tmpl[5].toInt(), (int)GenerationsEngine::MaxStates) : 2;
+    in >> tmp;
+    tmpl = tmp.split('|');
+    if(tmpl.size() < 2){
+        return false;
+    }
+    int h = tmpl[0].toInt();
+    int w = tmpl[1].toInt();
+    if(h <= 0 || w <= 0){
+        return false;
+    }
+    in >> tmp;
+    p.edgeMode = tmp == "t" ? 't' : 'p';
+    BitGrid board(h, w);
+    p.cells.clear();
+    if(p.states > 2){
+        p.cells.fill(0, h * w);
+    }
+    for(int k = 0; k < h; k++){
+        in >> tmp;
+        for(int j = 0; j < w && j < tmp.size(); j++){
+            board.setCell(k, j, tmp[j] == '*');
+            if(p.states > 2 && tmp[j] >= 'B' && tmp[j].unicode() < 'A' + p.states){
+                p.cells[k * w + j] = (char)(tmp[j].unicode() - 'A' + 1); //Refractory state.
+            } else if(p.states > 2){
+                p.cells[k * w + j] = tmp[j] == '*';
+            }
+        }
+    }
+    p.board = board;
+    int r, g, b;
+    in >> r >> g >> b >> p.interval;
+    p.colour = QString("%1 %2 %3").arg(r).arg(g).arg(b);
+    if(in.status() != QTextStream::Ok){
+        return false;
+    }
+    in >> tmp; //Newer files may end with the soup the board came from.
+    p.soup = tmp == "soup" ? in.readLine().trimmed() : QString();
+    return true;
+}
+
+void PatternIO::writeLaut(QTextStream &out, const Pattern &p)
+{
+    out << p.birth << "|" << p.survival << "|" << p.neighMode;
+    if(p.radius > 1 || p.states > 2){
+        out << "|" << p.radius << "|" << (p.middle ? 1 : 0);
+    }
+    if(p.states > 2){
+        out << "|" << p.states;
+    }
+    out << "\n";
+    out << p.board.height() << "|" << p.board.width() << "\n";
+    out << p.edgeMode << "\n";
+    for(int k = 0; k < p.board.height(); k++){
+        QString line(p.board.width(), 'o');
+        for(int j = 0; j < p.board.width(); j++){
+            int s = state(p, k, j);
+            if(s > 1){ line[j] = QChar('A' + s - 1); }
+            else if(s == 1){ line[j] = '*'; }
+        }
+        out << line << "\n";
+    }
+    out << p.colour << "\n";
+    out << p.interval << "\n";
+    if(!p.soup.isEmpty()){
+        out << "soup " << p.soup << "\n";
+    }
+}
+
+
+//.rle:
+static void parseRleRule(QString rule, Pattern &p)
+{
+    //"B3/S23", "23/3" (S/B), with Golly's "V" (von Neumann) and ":T"/":P" (torus/plane) suffixes,
+    //Larger than Life "R5,C0,M1,S34..58,B34..45,NM", or Generations "B2/S/C3" and "/2/3" (S/B/C).
+    rule = rule.trimmed().toUpper();
+    int colon = rule.indexOf(':');
+    if(colon >= 0){
+        p.edgeMode = rule.mid(colon + 1).startsWith('T') ? 't' : 'p';
+        rule = rule.left(colon);
+    }
+    if(rule.startsWith('R') || rule.count('/') == 2){
+        PatternIO::setRule(p, rule);
+        return;
+    }
+    if(rule.endsWith('V')){
+        p.neighMode = 'v';
+        rule.chop(1);
+    }
+    QStringList parts = rule.split('/');
+    if(parts.size() != 2){
+        return;
+    }
+    if(parts[0].startsWith('B') || parts[0].startsWith('S')){
+        foreach(QString part, parts){
+            if(part.startsWith('B')){ p.birth = part.mid(1).toLower(); } //Hensel letters are lower case.
+            else if(part.startsWith('S')){ p.survival = part.mid(1).toLower(); }
+        }
+    } else {
+        p.survival = parts[0];
+        p.birth = parts[1];
+    }
+}
+
+bool PatternIO::readRle(QTextStream &in, Pattern &p)
+{
+    int w = -1;
+    int h = -1;
+    QString body;
+    while(!in.atEnd()){
+        QString line = in.readLine().trimmed();
+        if(line.startsWith("#C soup ")){
+            p.soup = line.mid(8).trimmed(); //Written by writeRle().
+        }
+        if(line.isEmpty() || line.startsWith('#')){
+            continue;
+        }
+        if(w < 0){
+            //Header: x = 3, y = 3, rule = B3/S23
+            int ruleAt = line.indexOf("rule", 0, Qt::CaseInsensitive);
+            if(ruleAt >= 0){
+                //The rule is last and may hold commas itself.
+                parseRleRule(line.mid(line.indexOf('=', ruleAt) + 1), p);
+                line = line.left(ruleAt);
+            }
+            foreach(QString field, line.split(',')){
+                QStringList kv = field.split('=');
+                if(kv.size() != 2){ continue; }
+                QString key = kv[0].trimmed().toLower();
+                if(key == "x"){ w = kv[1].trimmed().toInt(); }
+                else if(key == "y"){ h = kv[1].trimmed().toInt(); }
+            }
+            if(w <= 0 || h <= 0){
+                return false;
+            }
+            continue;
+        }
+        body += line;
+        if(line.contains('!')){
+            break;
+        }
+    }
+    if(w <= 0 || h <= 0){
+        return false;
+    }
+    BitGrid board(h, w);
+    p.cells.clear();
+    if(p.states > 2){
+        p.cells.fill(0, h * w);
+    }
+    int k = 0;
+    int j = 0;
+    int count = 0;
+    for(int i = 0; i < body.size() && body[i] != '!'; i++){
+        QChar c = body[i];
+        if(c.isDigit()){
+            count = count * 10 + c.digitValue();
+            continue;
+        }
+        int n = qMax(1, count);
+        count = 0;
+        if(c == '$'){
+            k += n;
+            j = 0;
+        } else if(c == 'b' || c == '.'){
+            j += n;
+        } else if(c.isLetter()){
+            //Multi-state files: 'A' alive, 'B'... refractory states.
+            int s = p.states > 2 && c.isUpper() ? c.unicode() - 'A' + 1 : 1;
+            for(int x = 0; x < n; x++, j++){
+                if(k >= h || j >= w){ continue; }
+                board.setCell(k, j, s == 1);
+                if(p.states > 2){ p.cells[k * w + j] = (char)(s < p.states ? s : 0); }
+            }
+        }
+    }
+    p.board = board;
+    return true;
+}
+
+static void putRleRun(QTextStream &out, int &column, int n, char tag)
+{
+    //Lines are kept under 70 characters.
+    QString run = (n > 1 ? QString::number(n) : QString()) + tag;
+    if(column + run.size() > 70){
+        out << "\n";
+        column = 0;
+    }
+    out << run;
+    column += run.size();
+}
+
+void PatternIO::writeRle(QTextStream &out, const Pattern &p)
+{
+    const BitGrid &b = p.board;
+    if(!p.soup.isEmpty()){
+        out << "#C soup " << p.soup << "\n";
+    }
+    out << "x = " << b.width() << ", y = " << b.height() << ", rule = ";
+    if(p.radius > 1 || p.states > 2){
+        out << rule(p);
+    } else {
+        out << "B" << p.birth << "/S" << p.survival << (p.neighMode == 'v' ? "V" : "");
+    }
+    if(p.edgeMode == 't'){
+        out << ":T" << b.width() << "," << b.height();
+    }
+    out << "\n";
+    int column = 0;
+    int blankRows = 0;
+    for(int k = 0; k < b.height(); k++){
+        int j = 0;
+        bool started = false;
+        while(j < b.width()){
+            int s = state(p, k, j);
+            int n = 1;
+            while(j + n < b.width() && state(p, k, j + n) == s){ n++; }
+            if(s == 0 && j + n == b.width()){
+                break; //Trailing dead cells are implicit.
+            }
+            if(!started){
+                if(k > 0){ putRleRun(out, column, blankRows + 1, '$'); }
+                blankRows = 0;
+                started = true;
+            }
+            if(p.states > 2){
+                putRleRun(out, column, n, s ? 'A' + s - 1 : '.');
+            } else {
+                putRleRun(out, column, n, s ? 'o' : 'b');
+            }
+            j += n;
+        }
+        if(!started && k > 0){
+            blankRows++;
+        }
+    }
+    out << "!\n";
+}
+
+
+//.cells:
+bool PatternIO::readPlaintext(QTextStream &in, Pattern &p)
+{
+    QStringList rows;
+    int w = 0;
+    while(!in.atEnd()){
+        QString line = in.readLine();
+        if(line.startsWith("!Soup: ")){
+            p.soup = line.mid(7).trimmed(); //Written by writePlaintext().
+        }
+        if(line.startsWith('!')){
+            continue;
+        }
+        rows << line;
+        w = qMax(w, line.size());
+    }
+    while(!rows.isEmpty() && rows.last().trimmed().isEmpty()){
+        rows.removeLast();
+    }
+    if(rows.isEmpty() || w == 0){
+        return false;
+    }
+    BitGrid board(rows.size(), w);
+    for(int k = 0; k < rows.size(); k++){
+        for(int j = 0; j < rows[k].size(); j++){
+            board.setCell(k, j, rows[k][j] == 'O' || rows[k][j] == '*');
+        }
+    }
+    p.board = board;
+    return true;
+}
+
+void PatternIO::writePlaintext(QTextStream &out, const Pattern &p)
+{
+    out << "!Rule: " << rule(p) << "\n";
+    if(!p.soup.isEmpty()){
+        out << "!Soup: " << p.soup << "\n";
+    }
+    for(int k = 0; k < p.board.height(); k++){
+        QString line(p.board.width(), '.');
+        for(int j = 0; j < p.board.width(); j++){
+            if(p.board.cell(k, j)){ line[j] = 'O'; }
+        }
+        out << line << "\n";
+    }
+}
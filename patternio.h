@@ -0,0 +1,61 @@
+#ifndef PATTERNIO_H
+#define PATTERNIO_H
+
+#include <QString>
+#include <QTextStream>
+#include <QByteArray>
+#include "bitgrid.h"
+
+/**
+  *
+  * Reading and writing of patterns, chosen by file extension:
+  *   .laut   the application's own format (rule, size, edge mode, dump, colour, interval)
+  *   .rle    run length encoded, as used by most Life software
+  *   .cells  plaintext, '.' for dead and 'O' for live cells
+  * Formats without a field leave its default value.
+  * Larger than Life rules (radius > 1) keep their states as "34-45,50" ranges; .laut adds
+  * "|radius|middle" to its rule line, .rle uses the LtL rule notation.
+  * Generations rules (states > 2) add "|states" to the .laut rule line and write their
+  * refractory cells as 'B', 'C'... in the dump; .rle uses "B2/S/C3" and the multi-state
+  * letters ('.' dead, 'A' alive, 'B'...).
+  * A board that started as a random soup keeps its seed: a last "soup ..." line in .laut,
+  * "#C soup ..." in .rle and "!Soup: ..." in .cells.
+ */
+
+struct Pattern
+{
+    Pattern() : birth("3"), survival("23"), neighMode('m'), edgeMode('p'), radius(1), middle(false),
+        states(2), colour("0 0 0"), interval(100) {}
+    QString birth; // birth states, as typed in the rule input
+    QString survival; // survival states, as typed in the rule input
+    char neighMode;
+    char edgeMode;
+    int radius; // neighbourhood radius, > 1 for Larger than Life
+    bool middle; // radius > 1: the cell counts itself
+    int states; // > 2 for Generations rules
+    BitGrid board; // live cells
+    QByteArray cells; // states > 2: state of every cell, row major (empty: the board's)
+    QString colour; // "r g b" of the cells
+    int interval; // ms between generations
+    QString soup; // "density symmetry seed" of the random soup the board started from (Soup::describe), empty if none
+};
+
+class PatternIO
+{
+public:
+    static bool read(const QString &filename, Pattern &p);
+    static bool write(const QString &filename, const Pattern &p);
+    static bool isSupported(const QString &filename);
+    static QString rule(const Pattern &p); // for LifeEngine::setRule()
+    static bool setRule(Pattern &p, const QString &rule); // from LifeEngine::rule()
+    static int state(const Pattern &p, int k, int j); // 0 dead, 1 alive, 2.. refractory
+
+    static bool readLaut(QTextStream &in, Pattern &p);
+    static void writeLaut(QTextStream &out, const Pattern &p);
+    static bool readRle(QTextStream &in, Pattern &p);
+    static void writeRle(QTextStream &out, const Pattern &p);
+    static bool readPlaintext(QTextStream &in, Pattern &p);
+    static void writePlaintext(QTextStream &out, const Pattern &p);
+};
+
+#endif // PATTERNIO_H
@@ -0,0 +1,192 @@
+#include "patternsearch.h"
+
+static quint64 bitsAt(const quint64 *row, int words, int c)
+{
+    //64 cells of a row from column c, dead past its end.
+    int i = c >> 6;
+    int s = c & 63;
+    quint64 lo = i < words ? row[i] >> s : 0;
+    quint64 hi = s && i + 1 < words ? row[i + 1] << (64 - s) : 0;
+    return lo | hi;
+}
+
+
+BitGrid PatternSearch::trimmed(const BitGrid &grid)
+{
+    int top = grid.height();
+    int bottom = -1;
+    int left = grid.width();
+    int right = -1;
+    for(int k = 0; k < grid.height(); k++){
+        for(int j = 0; j < grid.width(); j++){
+            if(grid.cell(k, j)){
+                top = qMin(top, k);
+                bottom = qMax(bottom, k);
+                left = qMin(left, j);
+                right = qMax(right, j);
+            }
+        }
+    }
+    if(bottom < 0){
+        return BitGrid();
+    }
+    BitGrid out(bottom - top + 1, right - left + 1);
+    for(int k = top; k <= bottom; k++){
+        for(int j = left; j <= right; j++){
+            if(grid.cell(k, j)){ out.setCell(k - top, j - left, true); }
+        }
+    }
+    return out;
+}
+
+BitGrid PatternSearch::transformed(const BitGrid &grid, int orientation)
+{
+    int h = grid.height();
+    int w = grid.width();
+    bool transpose = orientation & 4;
+    BitGrid out(transpose ? w : h, transpose ? h : w);
+    for(int k = 0; k < h; k++){
+        for(int j = 0; j < w; j++){
+            if(!grid.cell(k, j)){
+                continue;
+            }
+            int y = orientation & 2 ? h - 1 - k : k;
+            int x = orientation & 1 ? w - 1 - j : j;
+            if(transpose){
+                out.setCell(x, y, true);
+            } else {
+                out.setCell(y, x, true);
+            }
+        }
+    }
+    return out;
+}
+
+QList<PatternSearch::Match> PatternSearch::find(const BitGrid &board, const BitGrid &pattern, bool torus, bool isolated, int limit)
+{
+    QList<Match> matches;
+    BitGrid base = trimmed(pattern);
+    if(base.isNull() || board.isNull()){
+        return matches;
+    }
+    int h = board.height();
+    int w = board.width();
+    int m = isolated ? 1 : 0;
+    //Board as seen by the template's top left corner: shifted by the border and,
+    //on a torus, extended with its wrapped rows and columns (made once, for all orientations).
+    int ext = qMax(base.height(), base.width()) + 2 * m - 1;
+    BitGrid padded = torus ? BitGrid(h + ext, w + ext) : BitGrid(h + 2 * m, w + 2 * m);
+    for(int k = 0; k < h; k++){
+        const quint64 *row = board.row(k);
+        for(int i = 0; i < board.wordsPerRow(); i++){
+            for(quint64 x = row[i]; x; x &= x - 1){
+                int j = i * 64 + qCountTrailingZeroBits(x);
+                if(!torus){
+                    padded.setCell(k + m, j + m, true);
+                    continue;
+                }
+                for(int y = (k + m) % h; y < padded.height(); y += h){
+                    for(int z = (j + m) % w; z < padded.width(); z += w){
+                        padded.setCell(y, z, true);
+                    }
+                }
+            }
+        }
+    }
+
+    QList<BitGrid> done;
+    for(int o = 0; o < 8 && matches.size() < limit; o++){
+        BitGrid shape = transformed(base, o);
+        if(done.contains(shape)){
+            continue; //Symmetric template.
+        }
+        done << shape;
+        //Template with its dead border.
+        int th = shape.height() + 2 * m;
+        int tw = shape.width() + 2 * m;
+        BitGrid tmpl(th, tw);
+        for(int k = 0; k < shape.height(); k++){
+            for(int j = 0; j < shape.width(); j++){
+                if(shape.cell(k, j)){ tmpl.setCell(k + m, j + m, true); }
+            }
+        }
+        int rows = torus ? h : h + 2 * m - th + 1;
+        int columns = torus ? w : w + 2 * m - tw + 1;
+        if((torus && (th > h || tw > w)) || rows <= 0 || columns <= 0){
+            continue;
+        }
+        search(padded, tmpl, rows, columns, o, m, limit, matches);
+    }
+    return matches;
+}
+
+void PatternSearch::search(const BitGrid &padded, const BitGrid &tmpl, int rows, int columns,
+                           int orientation, int border, int limit, QList<Match> &matches)
+{
+    int th = tmpl.height();
+    int tw = tmpl.width();
+    int words = padded.wordsPerRow();
+
+    //Template rows, most live cells first.
+    QList<int> order;
+    QVector<int> livePerRow(th, 0);
+    int live = 0;
+    for(int t = 0; t < th; t++){
+        for(int b = 0; b < tw; b++){
+            livePerRow[t] += tmpl.cell(t, b);
+        }
+        live += livePerRow[t];
+        int at = 0;
+        while(at < order.size() && livePerRow[order[at]] >= livePerRow[t]){ at++; }
+        order.insert(at, t);
+    }
+    QVector<quint64> want(th * tw); //All ones for a live template cell, zero for a dead one.
+    for(int t = 0; t < th; t++){
+        for(int b = 0; b < tw; b++){
+            want[t * tw + b] = tmpl.cell(t, b) ? ~Q_UINT64_C(0) : 0;
+        }
+    }
+    QVector<int> population(padded.height(), 0);
+    for(int k = 0; k < padded.height(); k++){
+        const quint64 *row = padded.row(k);
+        for(int i = 0; i < words; i++){
+            population[k] += qPopulationCount(row[i]);
+        }
+    }
+
+    int window = 0; //Live cells of rows k .. k+th-1.
+    for(int t = 0; t < th; t++){
+        window += population[t];
+    }
+    for(int k = 0; k < rows; k++){
+        if(k > 0){
+            window += population[k + th - 1] - population[k - 1];
+        }
+        if(window < live){
+            continue;
+        }
+        for(int c = 0; c < columns; c += 64){
+            quint64 acc = columns - c >= 64 ? ~Q_UINT64_C(0) : (Q_UINT64_C(1) << (columns - c)) - 1;
+            for(int n = 0; acc && n < th; n++){
+                int t = order[n];
+                const quint64 *row = padded.row(k + t);
+                const quint64 *bits = want.constData() + t * tw;
+                for(int b = 0; acc && b < tw; b++){
+                    acc &= ~(bitsAt(row, words, c + b) ^ bits[b]);
+                }
+            }
+            for(; acc; acc &= acc - 1){
+                Match match;
+                match.k = k;
+                match.j = c + qCountTrailingZeroBits(acc);
+                match.height = th - 2 * border;
+                match.width = tw - 2 * border;
+                match.orientation = orientation;
+                matches << match;
+                if(matches.size() >= limit){
+                    return;
+                }
+            }
+        }
+    }
+}
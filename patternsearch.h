@@ -0,0 +1,40 @@
+#ifndef PATTERNSEARCH_H
+#define PATTERNSEARCH_H
+
+#include <QList>
+#include "bitgrid.h"
+
+/**
+  *
+  * Search of a small template on a board, in its 8 orientations (the same one only once
+  * when the template is symmetric). For each board row and block of 64 columns, the
+  * template is compared bit column by bit column against the board row shifted under it,
+  * which tests 64 positions at once; the template row with the most live cells is tried
+  * first and a block is dropped as soon as no position is left. Windows of rows with fewer
+  * live cells than the template (a rolling sum of the row populations) are skipped.
+  * An isolated match also needs the cells around the template to be dead.
+  * On a torus matches may wrap around the edges.
+ */
+
+class PatternSearch
+{
+public:
+    struct Match {
+        Match() : k(0), j(0), height(0), width(0), orientation(0) {}
+        int k; // top left cell of the oriented template
+        int j;
+        int height; // of the oriented template
+        int width;
+        int orientation; // 0..7, see transformed()
+    };
+
+    static QList<Match> find(const BitGrid &board, const BitGrid &pattern, bool torus, bool isolated, int limit = 10000);
+    static BitGrid trimmed(const BitGrid &grid); // bounding box of the live cells
+    static BitGrid transformed(const BitGrid &grid, int orientation); // bit 0: mirror left-right, 1: top-bottom, 2: transpose
+
+private:
+    static void search(const BitGrid &padded, const BitGrid &tmpl, int rows, int columns,
+                       int orientation, int border, int limit, QList<Match> &matches);
+};
+
+#endif // PATTERNSEARCH_H
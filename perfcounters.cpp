@@ -0,0 +1,151 @@
+#include <QtGlobal>
+#include "perfcounters.h"
+
+#ifdef Q_OS_LINUX
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+
+static int openCounter(quint32 type, quint64 config)
+{
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.exclude_kernel = 1; //Allowed with perf_event_paranoid up to 2.
+    attr.exclude_hv = 1;
+    return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0); //This thread, any cpu.
+}
+#endif
+
+
+//Constructor:
+PerfCounters::PerfCounters()
+{
+    for(int c = 0; c < CounterCount; c++){
+        fd[c] = -1;
+        begin[c] = 0;
+        sum[c] = 0;
+        delta[c] = 0;
+    }
+}
+
+//Destructor:
+PerfCounters::~PerfCounters()
+{
+#ifdef Q_OS_LINUX
+    for(int c = 0; c < CounterCount; c++){
+        if(fd[c] >= 0){ close(fd[c]); }
+    }
+#endif
+}
+
+
+//Setup:
+bool PerfCounters::open()
+{
+#ifdef Q_OS_LINUX
+    const quint64 l1Read = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    fd[Cycles] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    if(fd[Cycles] < 0){
+        why = QString("perf_event_open: ") + strerror(errno);
+    }
+    fd[Instructions] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fd[L1Misses] = openCounter(PERF_TYPE_HW_CACHE, l1Read);
+    fd[LLCMisses] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    fd[BranchMisses] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    if(isAnyAvailable()){
+        why.clear();
+        return true;
+    }
+    if(why.isEmpty()){
+        why = QString("perf_event_open: ") + strerror(errno);
+    }
+    return false;
+#else
+    why = "hardware counters are only read on Linux";
+    return false;
+#endif
+}
+
+bool PerfCounters::isAvailable(Counter c) const
+{
+    return fd[c] >= 0;
+}
+
+bool PerfCounters::isAnyAvailable() const
+{
+    for(int c = 0; c < CounterCount; c++){
+        if(fd[c] >= 0){ return true; }
+    }
+    return false;
+}
+
+QString PerfCounters::error() const
+{
+    return why;
+}
+
+
+//Counting:
+quint64 PerfCounters::value(Counter c) const
+{
+    quint64 v = 0;
+#ifdef Q_OS_LINUX
+    if(fd[c] >= 0 && ::read(fd[c], &v, sizeof(v)) != sizeof(v)){
+        v = 0;
+    }
+#else
+    Q_UNUSED(c);
+#endif
+    return v;
+}
+
+void PerfCounters::start()
+{
+    for(int c = 0; c < CounterCount; c++){
+        begin[c] = value((Counter)c);
+    }
+}
+
+void PerfCounters::stop()
+{
+    for(int c = 0; c < CounterCount; c++){
+        delta[c] = value((Counter)c) - begin[c];
+        sum[c] += delta[c];
+    }
+}
+
+void PerfCounters::reset()
+{
+    for(int c = 0; c < CounterCount; c++){
+        sum[c] = 0;
+        delta[c] = 0;
+    }
+}
+
+quint64 PerfCounters::total(Counter c) const
+{
+    return sum[c];
+}
+
+quint64 PerfCounters::last(Counter c) const
+{
+    return delta[c];
+}
+
+QString PerfCounters::name(Counter c)
+{
+    switch(c){
+    case Cycles: return "cycles";
+    case Instructions: return "instructions";
+    case L1Misses: return "l1d_read_misses";
+    case LLCMisses: return "llc_misses";
+    case BranchMisses: return "branch_misses";
+    default: return "?";
+    }
+}
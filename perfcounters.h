@@ -0,0 +1,45 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <QString>
+
+/**
+  *
+  * Hardware performance counters of the calling thread (Linux perf_event_open).
+  * Counters that can't be opened (no PMU in a VM or container, perf_event_paranoid,
+  * other systems) are simply reported as unavailable, the others keep working.
+  * Usage: open() once, then start()/stop() around the measured code, totals accumulate.
+ */
+
+class PerfCounters
+{
+public:
+    enum Counter { Cycles, Instructions, L1Misses, LLCMisses, BranchMisses, CounterCount };
+
+    PerfCounters();
+    ~PerfCounters();
+
+    bool open(); // false if no counter at all is available, see error()
+    bool isAvailable(Counter c) const;
+    bool isAnyAvailable() const;
+    QString error() const;
+
+    void start();
+    void stop(); // adds what was counted since start()
+    void reset();
+    quint64 total(Counter c) const;
+    quint64 last(Counter c) const; // between the last start() and stop()
+
+    static QString name(Counter c); // snake_case, for CSV/JSON fields
+
+private:
+    int fd[CounterCount];
+    quint64 begin[CounterCount];
+    quint64 sum[CounterCount];
+    quint64 delta[CounterCount];
+    QString why;
+
+    quint64 value(Counter c) const;
+};
+
+#endif // PERFCOUNTERS_H
@@ -0,0 +1,133 @@
+#include <QFile>
+#include <QTextStream>
+#include "perfmonitor.h"
+
+
+//Constructor:
+PerfMonitor::PerfMonitor(int capacity) :
+    ring(qMax(16, capacity)),
+    head(0),
+    count(0),
+    enabled(false)
+{
+}
+
+
+//Recording:
+bool PerfMonitor::isEnabled() const
+{
+    return enabled;
+}
+
+void PerfMonitor::setEnabled(bool on)
+{
+    if(on && !enabled){
+        head = 0;
+        count = 0;
+        clock.start();
+    }
+    enabled = on;
+}
+
+qint64 PerfMonitor::elapsed() const
+{
+    return enabled ? clock.nsecsElapsed() : 0;
+}
+
+void PerfMonitor::add(Phase p, qint64 start, qint64 duration)
+{
+    Sample &s = ring[head];
+    s.start = start;
+    s.duration = duration;
+    s.phase = p;
+    head = (head + 1) % ring.size();
+    count = qMin(count + 1, ring.size());
+}
+
+const PerfMonitor::Sample &PerfMonitor::sample(int age) const
+{
+    return ring[(head - 1 - age + ring.size()) % ring.size()];
+}
+
+
+//Statistics:
+PerfMonitor::Stats PerfMonitor::stats(Phase p, int last) const
+{
+    QList<double> ms;
+    for(int age = 0; age < count && ms.size() < last; age++){
+        if(sample(age).phase == p){
+            ms << sample(age).duration / 1e6;
+        }
+    }
+    Stats s;
+    if(ms.isEmpty()){
+        return s;
+    }
+    qSort(ms);
+    s.count = ms.size();
+    double sum = 0;
+    foreach(double x, ms){ sum += x; }
+    s.mean = sum / ms.size();
+    s.p50 = ms[(ms.size() - 1) * 50 / 100];
+    s.p95 = ms[(ms.size() - 1) * 95 / 100];
+    s.p99 = ms[(ms.size() - 1) * 99 / 100];
+    s.max = ms.last();
+    return s;
+}
+
+double PerfMonitor::rate(Phase p, int windowMs) const
+{
+    if(!enabled || count == 0){
+        return 0;
+    }
+    qint64 now = clock.nsecsElapsed();
+    qint64 from = now - (qint64)windowMs * 1000000;
+    int n = 0;
+    for(int age = 0; age < count && sample(age).start >= from; age++){
+        n += sample(age).phase == p;
+    }
+    //Shorter window while the recording is younger than it.
+    return n * 1e9 / qMax<qint64>(1, qMin(now, now - from));
+}
+
+QStringList PerfMonitor::summary() const
+{
+    QStringList lines;
+    lines << QString("gens/s %1   fps %2").arg(rate(Step), 0, 'f', 1).arg(rate(Cells), 0, 'f', 1);
+    lines << QString("%1 %2 %3 %4 %5").arg("ms", -8).arg("p50", 7).arg("p95", 7).arg("p99", 7).arg("max", 7);
+    for(int p = 0; p < PhaseCount; p++){
+        Stats s = stats((Phase)p);
+        lines << QString("%1 %2 %3 %4 %5").arg(phaseName((Phase)p), -8)
+                 .arg(s.p50, 7, 'f', 2).arg(s.p95, 7, 'f', 2).arg(s.p99, 7, 'f', 2).arg(s.max, 7, 'f', 2);
+    }
+    return lines;
+}
+
+bool PerfMonitor::writeCsv(const QString &filename) const
+{
+    QFile file(filename);
+    if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)){
+        return false;
+    }
+    QTextStream out(&file);
+    out << "phase,start_ms,duration_ms\n";
+    for(int age = count - 1; age >= 0; age--){
+        const Sample &s = sample(age);
+        out << phaseName((Phase)s.phase) << "," << QString::number(s.start / 1e6, 'f', 3)
+            << "," << QString::number(s.duration / 1e6, 'f', 4) << "\n";
+    }
+    out.flush();
+    return file.error() == QFile::NoError;
+}
+
+QString PerfMonitor::phaseName(Phase p)
+{
+    switch(p){
+    case Step: return "step";
+    case Signals: return "signals";
+    case Grid: return "grid";
+    case Cells: return "cells";
+    case Events: return "events";
+    default: return "?";
+    }
+}
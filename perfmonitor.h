@@ -0,0 +1,66 @@
+#ifndef PERFMONITOR_H
+#define PERFMONITOR_H
+
+#include <QVector>
+#include <QStringList>
+#include <QElapsedTimer>
+
+/**
+  *
+  * Ring buffer of phase timings (stepping, painting, event handling...).
+  * Phases are timed with a Scope on the stack; while the monitor is disabled a Scope
+  * costs one test, no clock is read and nothing is stored.
+ */
+
+class PerfMonitor
+{
+public:
+    enum Phase { Step, Signals, Grid, Cells, Events, PhaseCount };
+
+    class Scope
+    {
+    public:
+        Scope(PerfMonitor &m, Phase p) : monitor(m.enabled ? &m : 0), phase(p), start(monitor ? m.clock.nsecsElapsed() : 0) {}
+        ~Scope() { if(monitor){ monitor->add(phase, start, monitor->clock.nsecsElapsed() - start); } }
+    private:
+        PerfMonitor *monitor;
+        Phase phase;
+        qint64 start;
+    };
+    friend class Scope;
+
+    struct Stats {
+        Stats() : count(0), mean(0), p50(0), p95(0), p99(0), max(0) {}
+        int count;
+        double mean, p50, p95, p99, max; // ms
+    };
+
+    explicit PerfMonitor(int capacity = 8192);
+
+    bool isEnabled() const;
+    void setEnabled(bool on); // turning it on starts a new recording
+    void add(Phase p, qint64 start, qint64 duration); // ns since the recording started
+    qint64 elapsed() const; // ns since the recording started, for phases timed across threads
+
+    Stats stats(Phase p, int last = 256) const; // over the last samples of a phase
+    double rate(Phase p, int windowMs = 1000) const; // samples per second
+    QStringList summary() const; // HUD lines
+    bool writeCsv(const QString &filename) const; // phase,start_ms,duration_ms, oldest first
+    static QString phaseName(Phase p);
+
+private:
+    struct Sample {
+        qint64 start;
+        qint64 duration;
+        int phase;
+    };
+    QVector<Sample> ring;
+    int head; // next slot
+    int count; // valid samples
+    bool enabled;
+    QElapsedTimer clock;
+
+    const Sample &sample(int age) const; // 0 = newest
+};
+
+#endif // PERFMONITOR_H
@@ -0,0 +1,73 @@
+#include <QFile>
+#include <QDir>
+#include <cstring>
+#include "recordingexporter.h"
+#include "runrecorder.h"
+#include "gifwriter.h"
+
+
+QImage RecordingExporter::render(const BitGrid &board, int zoom, const QColor &color)
+{
+    zoom = qMax(1, zoom);
+    QImage img(board.width() * zoom, board.height() * zoom, QImage::Format_Indexed8);
+    QVector<QRgb> palette;
+    palette << qRgb(255, 255, 255) << color.rgb();
+    img.setColorTable(palette);
+    for(int k = 0; k < board.height(); k++){
+        //Build the first pixel row of the cell row, then copy it zoom - 1 times.
+        const quint64 *in = board.row(k);
+        uchar *line = img.scanLine(k * zoom);
+        for(int j = 0; j < board.width(); j++){
+            memset(line + j * zoom, (in[j >> 6] >> (j & 63)) & 1, zoom);
+        }
+        for(int z = 1; z < zoom; z++){
+            memcpy(img.scanLine(k * zoom + z), line, img.width());
+        }
+    }
+    return img;
+}
+
+bool RecordingExporter::exportGif(const QString &recording, const QString &filename, int zoom, int delayMs, const QColor &color)
+{
+    RecordingReader reader;
+    if(!reader.open(recording)){
+        return false;
+    }
+    zoom = qMax(1, zoom);
+    QFile file(filename);
+    if(!file.open(QIODevice::WriteOnly)){
+        return false;
+    }
+    int h = reader.board().height();
+    int w = reader.board().width();
+    GifWriter gif;
+    QVector<QRgb> palette;
+    palette << qRgb(255, 255, 255) << color.rgb();
+    if(!gif.begin(&file, w * zoom, h * zoom, palette)){
+        return false;
+    }
+    do {
+        if(reader.board().height() != h || reader.board().width() != w){
+            break; //A GIF has one size, stop at a resize.
+        }
+        gif.addFrame(render(reader.board(), zoom, color), delayMs);
+    } while(reader.next());
+    return gif.end();
+}
+
+bool RecordingExporter::exportFrames(const QString &recording, const QString &directory, int zoom, const QColor &color)
+{
+    RecordingReader reader;
+    QDir dir(directory);
+    if(!reader.open(recording) || (!dir.exists() && !dir.mkpath("."))){
+        return false;
+    }
+    int n = 0;
+    do {
+        QString filename = dir.filePath(QString("frame-%1.png").arg(n++, 6, 10, QChar('0')));
+        if(!render(reader.board(), zoom, color).save(filename, "PNG")){
+            return false;
+        }
+    } while(reader.next());
+    return true;
+}
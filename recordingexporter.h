@@ -0,0 +1,24 @@
+#ifndef RECORDINGEXPORTER_H
+#define RECORDINGEXPORTER_H
+
+#include <QString>
+#include <QColor>
+#include <QImage>
+#include "bitgrid.h"
+
+/**
+  *
+  * Replays a recorded run (.lrec, see RunRecorder) into images:
+  * an animated GIF or a numbered PNG sequence, zoom pixels per cell.
+  * APNG isn't offered: Qt has no writer for it and the PNG sequence covers external tools.
+ */
+
+class RecordingExporter
+{
+public:
+    static bool exportGif(const QString &recording, const QString &filename, int zoom, int delayMs, const QColor &color);
+    static bool exportFrames(const QString &recording, const QString &directory, int zoom, const QColor &color); // frame-000000.png...
+    static QImage render(const BitGrid &board, int zoom, const QColor &color); // 2 colour indexed image
+};
+
+#endif // RECORDINGEXPORTER_H
@@ -0,0 +1,261 @@
+#include <QtConcurrent>
+#include <QSpinBox>
+#include <QDoubleSpinBox>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QPushButton>
+#include <QProgressBar>
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QLabel>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QCloseEvent>
+#include <QSet>
+#include "ruleexplorer.h"
+#include "ensembleengine.h"
+
+enum Column { RuleCol, ClassCol, PeriodCol, PopCol, GenCol, ColCount };
+
+
+//Constructor:
+RuleExplorer::RuleExplorer(QWidget *parent) :
+    QDialog(parent)
+{
+    setWindowTitle("Rule explorer");
+    for(int c = 0; c < 5; c++){ counts[c] = 0; }
+
+    countBox = new QSpinBox(this);
+    countBox->setRange(1, 262144);
+    countBox->setValue(2000);
+    countBox->setToolTip("Rules to run, all of them if larger than the rule space.");
+    genBox = new QSpinBox(this);
+    genBox->setRange(10, 10000);
+    genBox->setValue(300);
+    sizeBox = new QSpinBox(this);
+    sizeBox->setRange(16, 512);
+    sizeBox->setValue(64);
+    densityBox = new QDoubleSpinBox(this);
+    densityBox->setRange(0.01, 0.99);
+    densityBox->setSingleStep(0.05);
+    densityBox->setValue(0.35);
+    seedBox = new QSpinBox(this);
+    seedBox->setRange(0, 2147483647);
+    seedBox->setValue(1);
+    neighBox = new QComboBox(this);
+    neighBox->addItem("Moore");
+    neighBox->addItem("Von Neumann");
+    planeCheck = new QCheckBox("Bounded plane", this);
+    b0Check = new QCheckBox("Include B0 rules", this);
+
+    QFormLayout *form = new QFormLayout;
+    form->addRow("Rules:", countBox);
+    form->addRow("Generations:", genBox);
+    form->addRow("Soup size:", sizeBox);
+    form->addRow("Density:", densityBox);
+    form->addRow("Seed:", seedBox);
+    form->addRow("Neighbourhood:", neighBox);
+    form->addRow(planeCheck);
+    form->addRow(b0Check);
+
+    runBut = new QPushButton("Run", this);
+    cancelBut = new QPushButton("Cancel", this);
+    cancelBut->setEnabled(false);
+    addBut = new QPushButton(QIcon(":/icons/icons/add.png"), "Add to rulesets", this);
+    addBut->setEnabled(false);
+    QHBoxLayout *buttons = new QHBoxLayout;
+    buttons->addWidget(runBut);
+    buttons->addWidget(cancelBut);
+    buttons->addStretch();
+    buttons->addWidget(addBut);
+
+    progress = new QProgressBar(this);
+    progress->setValue(0);
+    summary = new QLabel("...", this);
+
+    table = new QTableWidget(0, ColCount, this);
+    table->setHorizontalHeaderLabels(QStringList() << "Rule" << "Class" << "Period" << "Population" << "Generations");
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->setSelectionMode(QAbstractItemView::SingleSelection);
+    table->verticalHeader()->hide();
+    table->horizontalHeader()->setStretchLastSection(true);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addLayout(form);
+    layout->addLayout(buttons);
+    layout->addWidget(progress);
+    layout->addWidget(summary);
+    layout->addWidget(table, 1);
+    resize(460, 600);
+
+    connect(runBut, SIGNAL(clicked()), this, SLOT(run()));
+    connect(cancelBut, SIGNAL(clicked()), this, SLOT(cancel()));
+    connect(addBut, SIGNAL(clicked()), this, SLOT(addSelected()));
+    connect(table, SIGNAL(cellClicked(int,int)), this, SLOT(rowClicked(int)));
+    connect(&watcher, SIGNAL(resultReadyAt(int)), this, SLOT(showResult(int)));
+    connect(&watcher, SIGNAL(finished()), this, SLOT(finished()));
+    connect(&watcher, SIGNAL(progressRangeChanged(int,int)), progress, SLOT(setRange(int,int)));
+    connect(&watcher, SIGNAL(progressValueChanged(int)), progress, SLOT(setValue(int)));
+}
+
+//Destructor:
+RuleExplorer::~RuleExplorer()
+{
+    watcher.cancel();
+    watcher.waitForFinished();
+}
+
+
+//Methods:
+QList<QList<RuleSurvey::Job> > RuleExplorer::makeJobs() const
+{
+    //Rule codes: birth mask in the low n+1 bits, survival mask above.
+    char neigh = neighBox->currentIndex() == 1 ? 'v' : 'm';
+    int n = neigh == 'v' ? 4 : 8;
+    int total = 1 << (2 * (n + 1));
+    int birthMask = (1 << (n + 1)) - 1;
+    bool b0 = b0Check->isChecked();
+    int space = b0 ? total : total / 2;
+
+    QList<int> codes;
+    if(countBox->value() >= space){
+        for(int code = 0; code < total; code++){
+            if(b0 || !(code & 1)){ codes.append(code); }
+        }
+    } else {
+        //Seeded sample without repetition (xorshift64*).
+        QSet<int> picked;
+        quint64 x = (quint64)seedBox->value() * Q_UINT64_C(0x9E3779B97F4A7C15) + 7;
+        while(picked.size() < countBox->value()){
+            x ^= x >> 12;
+            x ^= x << 25;
+            x ^= x >> 27;
+            int code = (int)(((x * Q_UINT64_C(2685821657736338717)) >> 32) % (quint64)total);
+            if(!b0){ code &= ~1; }
+            picked.insert(code);
+        }
+        codes = picked.toList();
+        qSort(codes);
+    }
+
+    RuleSurvey::Job job;
+    job.neighMode = neigh;
+    job.edgeMode = planeCheck->isChecked() ? 'p' : 't';
+    job.generations = genBox->value();
+    job.soup = RuleSurvey::soup(sizeBox->value(), sizeBox->value(), densityBox->value(), seedBox->value());
+    QList<QList<RuleSurvey::Job> > list;
+    for(int i = 0; i < codes.size(); i++){
+        if(i % EnsembleEngine::Lanes == 0){
+            list.append(QList<RuleSurvey::Job>());
+        }
+        job.birth = codes[i] & birthMask;
+        job.survival = codes[i] >> (n + 1);
+        list.last().append(job);
+    }
+    return list;
+}
+
+void RuleExplorer::run()
+{
+    if(watcher.isRunning()){
+        return;
+    }
+    table->setSortingEnabled(false); //Rows would move while they are filled.
+    table->setRowCount(0);
+    for(int c = 0; c < 5; c++){ counts[c] = 0; }
+    batches = makeJobs();
+    int rules = 0;
+    for(int i = 0; i < batches.size(); i++){ rules += batches[i].size(); }
+    summary->setText("Running " + QString::number(rules) + " rules...");
+    runBut->setEnabled(false);
+    cancelBut->setEnabled(true);
+    addBut->setEnabled(false);
+    watcher.setFuture(QtConcurrent::mapped(batches, &RuleSurvey::classifyBatch));
+}
+
+void RuleExplorer::cancel()
+{
+    watcher.cancel();
+}
+
+void RuleExplorer::setNeighMode(char mode)
+{
+    if(!watcher.isRunning()){
+        neighBox->setCurrentIndex(mode == 'v' ? 1 : 0);
+    }
+}
+
+void RuleExplorer::showResult(int index)
+{
+    foreach(RuleSurvey::Result r, watcher.resultAt(index)){
+        counts[r.type]++;
+        QString b = RuleSurvey::digits(r.job.birth);
+        QString s = RuleSurvey::digits(r.job.survival);
+        int row = table->rowCount();
+        table->insertRow(row);
+
+        QTableWidgetItem *rule = new QTableWidgetItem("B" + b + "/S" + s + (r.job.neighMode == 'v' ? "V" : ""));
+        rule->setData(Qt::UserRole, b);
+        rule->setData(Qt::UserRole + 1, s);
+        rule->setData(Qt::UserRole + 2, (int)r.job.neighMode);
+        table->setItem(row, RuleCol, rule);
+        table->setItem(row, ClassCol, new QTableWidgetItem(RuleSurvey::className(r.type)));
+        //Numbers as data so the columns sort numerically:
+        QTableWidgetItem *period = new QTableWidgetItem;
+        if(r.period > 0){ period->setData(Qt::DisplayRole, r.period); }
+        table->setItem(row, PeriodCol, period);
+        QTableWidgetItem *pop = new QTableWidgetItem;
+        pop->setData(Qt::DisplayRole, r.population);
+        table->setItem(row, PopCol, pop);
+        QTableWidgetItem *gens = new QTableWidgetItem;
+        gens->setData(Qt::DisplayRole, r.generations);
+        table->setItem(row, GenCol, gens);
+    }
+}
+
+void RuleExplorer::finished()
+{
+    table->setSortingEnabled(true);
+    runBut->setEnabled(true);
+    cancelBut->setEnabled(false);
+    QString text = QString::number(table->rowCount()) + " rules";
+    if(watcher.isCanceled()){
+        text += " (cancelled)";
+    }
+    text += ":";
+    for(int c = 0; c < 5; c++){
+        text += " " + QString::number(counts[c]) + " " + RuleSurvey::className((RuleSurvey::Class)c);
+    }
+    summary->setText(text);
+}
+
+void RuleExplorer::rowClicked(int row)
+{
+    QTableWidgetItem *rule = table->item(row, RuleCol);
+    if(!rule){
+        return;
+    }
+    addBut->setEnabled(true);
+    emit ruleSelected(rule->data(Qt::UserRole).toString(), rule->data(Qt::UserRole + 1).toString(),
+                      (char)rule->data(Qt::UserRole + 2).toInt());
+}
+
+void RuleExplorer::addSelected()
+{
+    QTableWidgetItem *rule = table->item(table->currentRow(), RuleCol);
+    if(!rule){
+        return;
+    }
+    emit ruleAdded(rule->data(Qt::UserRole).toString(), rule->data(Qt::UserRole + 1).toString(),
+                   (char)rule->data(Qt::UserRole + 2).toInt());
+}
+
+
+//Events:
+void RuleExplorer::closeEvent(QCloseEvent *e)
+{
+    watcher.cancel(); //Results are kept, the pool is freed.
+    QDialog::closeEvent(e);
+}
@@ -0,0 +1,74 @@
+#ifndef RULEEXPLORER_H
+#define RULEEXPLORER_H
+
+#include <QDialog>
+#include <QFutureWatcher>
+#include "rulesurvey.h"
+
+class QSpinBox;
+class QDoubleSpinBox;
+class QComboBox;
+class QCheckBox;
+class QPushButton;
+class QProgressBar;
+class QTableWidget;
+class QLabel;
+
+/**
+  *
+  * Batch explorer of the B/S rule space: one seeded soup is run under many rules
+  * (all of them when the sample is larger than the space) across the thread pool,
+  * in batches of 64 rules classified together by RuleSurvey, and listed in a sortable table.
+  * Clicking a row hands the rule to the main window, the add button also saves it
+  * as a ruleset.
+ */
+
+class RuleExplorer : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit RuleExplorer(QWidget *parent = 0);
+    ~RuleExplorer();
+
+signals:
+    void ruleSelected(QString birth, QString survival, char neighMode);
+    void ruleAdded(QString birth, QString survival, char neighMode);
+
+public slots:
+    void run(); //Run button
+    void cancel(); //Cancel button
+    void setNeighMode(char mode); //Follows the main window
+
+private slots:
+    void showResult(int index);
+    void finished();
+    void rowClicked(int row);
+    void addSelected(); //Add button
+
+protected:
+    void closeEvent(QCloseEvent *e);
+
+private:
+    QList<QList<RuleSurvey::Job> > makeJobs() const; // batches
+
+    QSpinBox *countBox; //Number of rules
+    QSpinBox *genBox; //Generation limit
+    QSpinBox *sizeBox; //Soup side
+    QDoubleSpinBox *densityBox; //Soup density
+    QSpinBox *seedBox; //Soup and sample seed
+    QComboBox *neighBox; //Moore/Von Neumann
+    QCheckBox *planeCheck; //Bounded plane instead of torus
+    QCheckBox *b0Check; //Allow B0 rules
+    QPushButton *runBut;
+    QPushButton *cancelBut;
+    QPushButton *addBut;
+    QProgressBar *progress;
+    QLabel *summary;
+    QTableWidget *table;
+    QFutureWatcher<QList<RuleSurvey::Result> > watcher;
+    QList<QList<RuleSurvey::Job> > batches; //Being run
+    int counts[5]; //Results per class
+};
+
+#endif // RULEEXPLORER_H
@@ -0,0 +1,138 @@
+#include <QHash>
+#include "rulesurvey.h"
+#include "lifeengine.h"
+#include "ensembleengine.h"
+#include "soup.h"
+
+
+RuleSurvey::Result RuleSurvey::classify(const Job &job)
+{
+    Result r;
+    r.job = job;
+    LifeEngine engine(job.soup.height(), job.soup.width(), MemoryUsage::Scratch);
+    engine.setThreadCount(1); //Parallelism comes from running many rules at once.
+    engine.setBirthStates(states(job.birth));
+    engine.setSurvivalStates(states(job.survival));
+    engine.setNeighMode(job.neighMode);
+    engine.setEdgeMode(job.edgeMode);
+    engine.setBoard(job.soup);
+
+    int initial = qMax(1, job.soup.population());
+    QHash<quint64, int> seen; // board hash -> generation
+    seen.insert(job.soup.hash(), 0);
+    QList<int> populations;
+    for(int g = 1; g <= job.generations; g++){
+        if(!engine.step()){
+            r.generations = g - 1;
+            r.population = engine.population();
+            r.type = r.population == 0 ? Dies : Stabilizes;
+            r.period = r.type == Stabilizes ? 1 : 0;
+            return r;
+        }
+        BitGrid board = engine.board();
+        int population = board.population();
+        r.generations = g;
+        r.population = population;
+        if(population == 0){
+            r.type = Dies;
+            return r;
+        }
+        quint64 h = board.hash();
+        if(seen.contains(h)){
+            r.type = Oscillates;
+            r.period = g - seen.value(h);
+            return r;
+        }
+        seen.insert(h, g);
+        populations << population;
+    }
+    //Never repeated: judge the growth over the last quarter of the run.
+    int from = populations.size() * 3 / 4;
+    double mean = 0;
+    for(int i = from; i < populations.size(); i++){
+        mean += populations[i];
+    }
+    mean /= qMax(1, populations.size() - from);
+    double cells = (double)job.soup.height() * job.soup.width();
+    r.type = (mean >= 2.0 * initial || mean >= 0.5 * cells) ? Explosive : Chaotic;
+    return r;
+}
+
+QList<RuleSurvey::Result> RuleSurvey::classifyBatch(const QList<Job> &jobs)
+{
+    QList<Result> results;
+    if(jobs.isEmpty()){
+        return results;
+    }
+    const Job &first = jobs.first();
+    EnsembleEngine ensemble(first.soup.height(), first.soup.width());
+    ensemble.setNeighMode(first.neighMode);
+    ensemble.setEdgeMode(first.edgeMode);
+    ensemble.setRule(QList<int>(), QList<int>()); //Unused lanes die at once.
+    int n = qMin((int)EnsembleEngine::Lanes, jobs.size());
+    for(int i = 0; i < n; i++){
+        ensemble.setLaneRule(i, states(jobs[i].birth), states(jobs[i].survival));
+        ensemble.setLane(i, first.soup);
+    }
+    QVector<int> population(n, 0); // when the lane stopped
+    while(ensemble.generation() < first.generations){
+        quint64 before = ensemble.running();
+        if(!ensemble.step()){
+            break;
+        }
+        quint64 stopped = before & ~ensemble.running();
+        for(int i = 0; i < n && stopped; i++){
+            if(stopped & (Q_UINT64_C(1) << i)){ population[i] = ensemble.population(i); }
+        }
+    }
+    for(int i = 0; i < jobs.size(); i++){
+        if(i >= n || ensemble.status(i) == EnsembleEngine::Running){
+            results << classify(jobs[i]);
+            continue;
+        }
+        Result r;
+        r.job = jobs[i];
+        r.generations = ensemble.stopGeneration(i);
+        r.population = population[i];
+        switch(ensemble.status(i)){
+        case EnsembleEngine::Died: r.type = Dies; break;
+        case EnsembleEngine::Stable: r.type = Stabilizes; r.period = 1; break;
+        default: r.type = Oscillates; r.period = 2; break;
+        }
+        results << r;
+    }
+    return results;
+}
+
+BitGrid RuleSurvey::soup(int height, int width, double density, quint64 seed)
+{
+    return Soup::generate(height, width, density, seed);
+}
+
+QList<int> RuleSurvey::states(int mask)
+{
+    QList<int> list;
+    for(int n = 0; n <= 8; n++){
+        if(mask & (1 << n)){ list << n; }
+    }
+    return list;
+}
+
+QString RuleSurvey::digits(int mask)
+{
+    QString s;
+    foreach(int n, states(mask)){ s += QString::number(n); }
+    return s;
+}
+
+QString RuleSurvey::className(Class c)
+{
+    switch(c){
+    case Dies: return "dies";
+    case Stabilizes: return "stabilizes";
+    case Oscillates: return "oscillates";
+    case Chaotic: return "chaotic";
+    case Explosive: return "explosive";
+    default: return "?";
+    }
+}
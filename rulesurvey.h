@@ -0,0 +1,53 @@
+#ifndef RULESURVEY_H
+#define RULESURVEY_H
+
+#include <QString>
+#include <QList>
+#include "bitgrid.h"
+
+/**
+  *
+  * Classification of a rule by running it on a soup:
+  *   dies        the population reaches 0
+  *   stabilizes  a generation equals the previous one
+  *   oscillates  a generation repeats an older one (period = distance), found by board hashes
+  *   explosive   no repetition and the population at least doubles (or fills half the board)
+  *   chaotic     no repetition otherwise
+  * classify() is self-contained so rules can be mapped over the thread pool.
+  * classifyBatch() runs up to 64 rules at once on an EnsembleEngine and only hands the rules
+  * it can't settle there (longer periods, chaos, growth) to classify().
+ */
+
+class RuleSurvey
+{
+public:
+    enum Class { Dies, Stabilizes, Oscillates, Chaotic, Explosive };
+
+    struct Job {
+        Job() : birth(0), survival(0), neighMode('m'), edgeMode('t'), generations(300) {}
+        int birth; // bit n set: birth on n neighbours
+        int survival; // bit n set: survival on n neighbours
+        char neighMode;
+        char edgeMode;
+        int generations; // limit
+        BitGrid soup; // start board, shared by all jobs
+    };
+
+    struct Result {
+        Result() : type(Chaotic), period(0), generations(0), population(0) {}
+        Job job;
+        Class type;
+        int period; // oscillators only
+        int generations; // generations run before the classification was known
+        int population; // at the end
+    };
+
+    static Result classify(const Job &job);
+    static QList<Result> classifyBatch(const QList<Job> &jobs); // same soup, modes and limit
+    static BitGrid soup(int height, int width, double density, quint64 seed); // same board for a seed everywhere
+    static QList<int> states(int mask); // bit mask -> neighbour counts
+    static QString digits(int mask); // bit mask -> "23"
+    static QString className(Class c);
+};
+
+#endif // RULESURVEY_H
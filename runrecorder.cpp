@@ -0,0 +1,209 @@
+#include <QMutexLocker>
+#include <cstring>
+#include "runrecorder.h"
+
+static const quint32 recordingMagic = 0x4c524543; // "LREC"
+static const quint32 recordingVersion = 1;
+static const int keyframeInterval = 1024; // a damaged stream can be resumed from the next keyframe
+
+enum FrameType { KeyFrame = 0, DeltaFrame = 1 };
+
+
+//Constructor:
+RunRecorder::RunRecorder(QObject *parent) :
+    QThread(parent),
+    capacity(64),
+    stopping(false)
+{
+}
+
+//Destructor:
+RunRecorder::~RunRecorder()
+{
+    finish();
+}
+
+
+//Game thread side:
+bool RunRecorder::begin(const QString &filename, const Checkpoint &start)
+{
+    if(isRunning() || start.board.isNull()){
+        return false;
+    }
+    QFile check(filename);
+    if(!check.open(QIODevice::WriteOnly)){
+        return false;
+    }
+    check.close();
+    this->filename = filename;
+    header = start;
+    queue.clear();
+    stopping = false;
+    Frame f;
+    f.generation = start.generation;
+    f.board = start.board;
+    queue.enqueue(f);
+    QThread::start(QThread::LowPriority);
+    return true;
+}
+
+void RunRecorder::append(int generation, const BitGrid &board)
+{
+    QMutexLocker lock(&mutex);
+    while(queue.size() >= capacity && !stopping){
+        notFull.wait(&mutex);
+    }
+    Frame f;
+    f.generation = generation;
+    f.board = board;
+    queue.enqueue(f);
+    notEmpty.wakeOne();
+}
+
+void RunRecorder::finish()
+{
+    mutex.lock();
+    stopping = true;
+    notEmpty.wakeOne();
+    mutex.unlock();
+    wait();
+}
+
+QString RunRecorder::fileName() const
+{
+    return filename;
+}
+
+
+//Worker thread side:
+void RunRecorder::run()
+{
+    QFile file(filename);
+    if(!file.open(QIODevice::WriteOnly)){
+        return;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << recordingMagic << recordingVersion;
+    out << (qint32)header.board.height() << (qint32)header.board.width();
+    out << header.birth << header.survival << (qint8)header.neighMode << (qint8)header.edgeMode;
+
+    BitGrid previous;
+    int sinceKeyframe = 0;
+    forever {
+        mutex.lock();
+        while(queue.isEmpty() && !stopping){
+            notEmpty.wait(&mutex);
+        }
+        if(queue.isEmpty()){
+            mutex.unlock();
+            break;
+        }
+        Frame f = queue.dequeue();
+        notFull.wakeOne();
+        mutex.unlock();
+
+        bool keyframe = previous.isNull()
+                || previous.height() != f.board.height() || previous.width() != f.board.width()
+                || ++sinceKeyframe >= keyframeInterval;
+        out << (qint32)f.generation;
+        if(keyframe){
+            const QVector<quint64> &words = f.board.words();
+            QByteArray raw((const char *)words.constData(), words.size() * sizeof(quint64));
+            out << (quint8)KeyFrame << (qint32)f.board.height() << (qint32)f.board.width() << qCompress(raw);
+            sinceKeyframe = 0;
+        } else {
+            out << (quint8)DeltaFrame << BitGrid::delta(previous, f.board);
+        }
+        previous = f.board;
+    }
+    file.close();
+}
+
+
+//Reader:
+RecordingReader::RecordingReader() :
+    gen(-1)
+{
+}
+
+bool RecordingReader::open(const QString &filename)
+{
+    file.close();
+    file.setFileName(filename);
+    if(!file.open(QIODevice::ReadOnly)){
+        return false;
+    }
+    in.setDevice(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    quint32 magic, version;
+    qint32 h, w;
+    qint8 neigh, edge;
+    in >> magic >> version;
+    if(magic != recordingMagic || version != recordingVersion){
+        return false;
+    }
+    in >> h >> w >> head.birth >> head.survival >> neigh >> edge;
+    if(in.status() != QDataStream::Ok || h <= 0 || w <= 0){
+        return false;
+    }
+    head.neighMode = neigh;
+    head.edgeMode = edge;
+    current = BitGrid();
+    gen = -1;
+    if(!next()){
+        return false;
+    }
+    head.generation = gen;
+    head.board = current;
+    return true;
+}
+
+bool RecordingReader::next()
+{
+    if(in.atEnd()){
+        return false;
+    }
+    qint32 generation;
+    quint8 type;
+    in >> generation >> type;
+    if(type == KeyFrame){
+        qint32 h, w;
+        QByteArray packed;
+        in >> h >> w >> packed;
+        if(in.status() != QDataStream::Ok || h <= 0 || w <= 0){
+            return false;
+        }
+        BitGrid board(h, w);
+        QByteArray raw = qUncompress(packed);
+        if(raw.size() != board.byteSize()){
+            return false;
+        }
+        memcpy(board.words().data(), raw.constData(), raw.size());
+        current = board;
+    } else {
+        QByteArray delta;
+        in >> delta;
+        if(in.status() != QDataStream::Ok || current.isNull()){
+            return false;
+        }
+        current.applyDelta(delta);
+    }
+    gen = generation;
+    return true;
+}
+
+int RecordingReader::generation() const
+{
+    return gen;
+}
+
+const BitGrid &RecordingReader::board() const
+{
+    return current;
+}
+
+const Checkpoint &RecordingReader::header() const
+{
+    return head;
+}
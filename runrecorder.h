@@ -0,0 +1,77 @@
+#ifndef RUNRECORDER_H
+#define RUNRECORDER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QFile>
+#include <QDataStream>
+#include "checkpointer.h"
+
+/**
+  *
+  * Records a run as a generation stream (.lrec):
+  *   header:  "LREC", version, height, width, birth, survival, neighbourhood mode, edge mode
+  *   frames:  generation, type (0: keyframe, 1: delta), payload
+  * Keyframes hold the compressed words of the board, deltas the run-length coded XOR
+  * with the previous frame (see BitGrid::delta()), so only the changed cells are stored.
+  * The game thread only queues the packed boards; diffing and writing happen on this
+  * thread. The queue is bounded: if the disk can't keep up, append() waits.
+ */
+
+class RunRecorder : public QThread
+{
+    Q_OBJECT
+public:
+    explicit RunRecorder(QObject *parent = 0);
+    ~RunRecorder();
+
+    bool begin(const QString &filename, const Checkpoint &start); // header + first keyframe
+    void append(int generation, const BitGrid &board);
+    void finish(); // flush the queue and close the file
+    QString fileName() const;
+
+protected:
+    void run();
+
+private:
+    struct Frame {
+        int generation;
+        BitGrid board;
+    };
+    QString filename;
+    Checkpoint header;
+    QMutex mutex;
+    QWaitCondition notEmpty;
+    QWaitCondition notFull;
+    QQueue<Frame> queue;
+    int capacity; // max queued boards
+    bool stopping;
+};
+
+
+/**
+  *
+  * Sequential reader of a .lrec stream.
+ */
+
+class RecordingReader
+{
+public:
+    RecordingReader();
+    bool open(const QString &filename);
+    bool next(); // advance to the next frame
+    int generation() const;
+    const BitGrid &board() const;
+    const Checkpoint &header() const; // rule, modes and first board
+
+private:
+    QFile file;
+    QDataStream in;
+    Checkpoint head;
+    BitGrid current;
+    int gen;
+};
+
+#endif // RUNRECORDER_H
@@ -0,0 +1,196 @@
+#include <QDateTime>
+#include <QStringList>
+#include "soup.h"
+
+static quint64 splitmix(quint64 &x)
+{
+    quint64 z = (x += Q_UINT64_C(0x9E3779B97F4A7C15));
+    z = (z ^ (z >> 30)) * Q_UINT64_C(0xBF58476D1CE4E5B9);
+    z = (z ^ (z >> 27)) * Q_UINT64_C(0x94D049BB133111EB);
+    return z ^ (z >> 31);
+}
+
+static inline quint64 rotl(quint64 x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+//xoshiro256** in four lanes, state word by lane so each line of a step is one vector operation.
+struct Xoshiro4 {
+    enum { Lanes = 4 };
+    quint64 s0[Lanes], s1[Lanes], s2[Lanes], s3[Lanes];
+    quint64 out[Lanes];
+
+    explicit Xoshiro4(quint64 seed)
+    {
+        for(int l = 0; l < Lanes; l++){
+            s0[l] = splitmix(seed);
+            s1[l] = splitmix(seed);
+            s2[l] = splitmix(seed);
+            s3[l] = splitmix(seed);
+        }
+    }
+
+    inline void step()
+    {
+        for(int l = 0; l < Lanes; l++){
+            out[l] = rotl(s1[l] * 5, 7) * 9;
+            quint64 t = s1[l] << 17;
+            s2[l] ^= s0[l];
+            s3[l] ^= s1[l];
+            s1[l] ^= s2[l];
+            s0[l] ^= s3[l];
+            s2[l] ^= t;
+            s3[l] = rotl(s3[l], 45);
+        }
+    }
+};
+
+
+//Generation:
+BitGrid Soup::random(int height, int width, double density, quint64 seed)
+{
+    BitGrid grid(height, width);
+    if(height <= 0 || width <= 0 || density <= 0){
+        return grid;
+    }
+    int wpr = grid.wordsPerRow();
+    quint64 last = width % 64 ? (Q_UINT64_C(1) << (width % 64)) - 1 : ~Q_UINT64_C(0); //Padding stays dead.
+    if(density >= 1){
+        grid.fill(0, 0, height, width, true);
+        return grid;
+    }
+    //A cell lives if its 32 bit random number is below the threshold: the bits of all 64 lanes
+    //of a word are compared at once, from the top, until no lane is still equal to it.
+    quint32 threshold = (quint32)qMin(density * 4294967296.0, 4294967295.0);
+    if(threshold == 0){
+        return grid;
+    }
+    int bits = 32;
+    while(!(threshold >> (32 - bits) & 1)){
+        bits--; //Past the lowest set bit of the threshold no lane can become smaller.
+    }
+    //Words are drawn four at a time, one per lane, in memory order; the padding is cleared after.
+    Xoshiro4 rng(seed);
+    quint64 *words = grid.words().data();
+    int count = grid.words().size();
+    for(int i = 0; i < count; i += Xoshiro4::Lanes){
+        quint64 less[Xoshiro4::Lanes] = { 0, 0, 0, 0 };
+        quint64 equal[Xoshiro4::Lanes] = { ~Q_UINT64_C(0), ~Q_UINT64_C(0), ~Q_UINT64_C(0), ~Q_UINT64_C(0) };
+        for(int b = 31; b >= 32 - bits; b--){
+            rng.step();
+            quint64 t = 0 - (quint64)(threshold >> b & 1); //The threshold's bit in every lane.
+            quint64 undecided = 0;
+            for(int l = 0; l < Xoshiro4::Lanes; l++){
+                less[l] |= equal[l] & t & ~rng.out[l];
+                equal[l] &= ~(rng.out[l] ^ t);
+                undecided |= equal[l];
+            }
+            if(!undecided){
+                break;
+            }
+        }
+        for(int l = 0; l < Xoshiro4::Lanes && i + l < count; l++){
+            words[i + l] = less[l];
+        }
+    }
+    for(int k = 0; k < height; k++){
+        words[(qint64)k * wpr + wpr - 1] &= last;
+    }
+    return grid;
+}
+
+BitGrid Soup::generate(int height, int width, double density, quint64 seed, Symmetry symmetry)
+{
+    if(symmetry == C1 || height <= 0 || width <= 0){
+        return random(height, width, density, seed);
+    }
+    BitGrid board(height, width);
+    if(symmetry == C2){
+        board.blit(random((height + 1) / 2, width, density, seed), 0, 0);
+        board.blit(board.mirrored().flipped(), 0, 0, BitGrid::Or);
+        return board;
+    }
+    if(symmetry == D4){
+        board.blit(random((height + 1) / 2, (width + 1) / 2, density, seed), 0, 0);
+        board.blit(board.mirrored(), 0, 0, BitGrid::Or);
+        board.blit(board.flipped(), 0, 0, BitGrid::Or);
+        return board;
+    }
+    //C4 and D8: in a square.
+    int n = qMin(height, width);
+    int half = (n + 1) / 2;
+    BitGrid square(n, n);
+    BitGrid quarter = random(half, half, density, seed);
+    if(symmetry == D8){
+        for(int k = 1; k < half; k++){
+            quarter.fill(k, 0, 1, k, false); //Below the diagonal comes from the transpose.
+        }
+        square.blit(quarter, 0, 0);
+        square.blit(square.transposed(), 0, 0, BitGrid::Or);
+        square.blit(square.mirrored(), 0, 0, BitGrid::Or);
+        square.blit(square.flipped(), 0, 0, BitGrid::Or);
+    } else {
+        square.blit(quarter, 0, 0);
+        square.blit(square.rotated(true), 0, 0, BitGrid::Or);
+        square.blit(square.mirrored().flipped(), 0, 0, BitGrid::Or);
+    }
+    board.blit(square, (height - n) / 2, (width - n) / 2);
+    return board;
+}
+
+quint64 Soup::randomSeed()
+{
+    static quint64 counter = 0;
+    quint64 x = (quint64)QDateTime::currentMSecsSinceEpoch() ^ (++counter << 48);
+    return splitmix(x);
+}
+
+
+//Descriptions:
+QString Soup::symmetryName(Symmetry symmetry)
+{
+    switch(symmetry){
+    case C2: return "C2";
+    case C4: return "C4";
+    case D4: return "D4";
+    case D8: return "D8";
+    default: return "C1";
+    }
+}
+
+bool Soup::parseSymmetry(const QString &name, Symmetry &symmetry)
+{
+    static const Symmetry all[] = { C1, C2, C4, D4, D8 };
+    for(int i = 0; i < 5; i++){
+        if(name.compare(symmetryName(all[i]), Qt::CaseInsensitive) == 0){
+            symmetry = all[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+QString Soup::describe(double density, Symmetry symmetry, quint64 seed)
+{
+    return QString::number(density) + " " + symmetryName(symmetry) + " " + QString::number(seed);
+}
+
+bool Soup::parse(const QString &text, double &density, Symmetry &symmetry, quint64 &seed)
+{
+    QStringList parts = text.simplified().split(' ');
+    if(parts.size() != 3){
+        return false;
+    }
+    bool okDensity, okSeed;
+    double d = parts[0].toDouble(&okDensity);
+    quint64 s = parts[2].toULongLong(&okSeed);
+    Symmetry sym;
+    if(!okDensity || !okSeed || d < 0 || d > 1 || !parseSymmetry(parts[1], sym)){
+        return false;
+    }
+    density = d;
+    symmetry = sym;
+    seed = s;
+    return true;
+}
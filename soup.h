@@ -0,0 +1,39 @@
+#ifndef SOUP_H
+#define SOUP_H
+
+#include <QString>
+#include "bitgrid.h"
+
+/**
+  *
+  * Random starting boards ("soups") that can be made again from their seed.
+  * Cells come straight out as packed words: four xoshiro256** streams are stepped side by
+  * side, one word each, and every draw decides a bit of the 64 cells' random numbers at once,
+  * compared with the density from the most significant bit down until no cell is still equal
+  * to it (bit-sliced): one draw per word at density 0.5, about 9 otherwise.
+  * Symmetric soups are drawn on the fundamental part only and turned into the rest:
+  *   C1  no symmetry
+  *   C2  half turn (top half drawn)
+  *   C4  quarter turns (top-left quarter)
+  *   D4  mirrored left-right and top-bottom (top-left quarter)
+  *   D8  both, and across the diagonals (top-left quarter, above the diagonal)
+  * C4 and D8 need a square: on other boards they fill the largest square in the middle.
+ */
+
+class Soup
+{
+public:
+    enum Symmetry { C1, C2, C4, D4, D8 };
+
+    static BitGrid generate(int height, int width, double density, quint64 seed, Symmetry symmetry = C1);
+    static quint64 randomSeed(); // from the clock, for a new soup
+    static QString symmetryName(Symmetry symmetry); // "C1", "C2"...
+    static bool parseSymmetry(const QString &name, Symmetry &symmetry);
+    static QString describe(double density, Symmetry symmetry, quint64 seed); // "0.35 D4 1234", as saved in files
+    static bool parse(const QString &text, double &density, Symmetry &symmetry, quint64 &seed);
+
+private:
+    static BitGrid random(int height, int width, double density, quint64 seed); // every cell drawn
+};
+
+#endif // SOUP_H
@@ -0,0 +1,492 @@
+#include <cstring>
+#include "tileduniverse.h"
+
+static const qint64 headerSize = 4096; //A page, the tiles stay aligned.
+static const qint64 tileBytes = TiledUniverse::TileSize * sizeof(quint64);
+
+static inline void addBit(quint64 x, quint64 &s0, quint64 &s1, quint64 &s2, quint64 &s3)
+{
+    //Bit-sliced counter: 64 cells get one more neighbour where x is set.
+    quint64 c0 = s0 & x;
+    s0 ^= x;
+    quint64 c1 = s1 & c0;
+    s1 ^= c0;
+    quint64 c2 = s2 & c1;
+    s2 ^= c1;
+    s3 |= c2;
+}
+
+
+//Constructor:
+TiledUniverse::TiledUniverse() :
+    mem(0),
+    header(0),
+    across(0),
+    down(0),
+    live(0),
+    lastChanged(0)
+{
+}
+
+TiledUniverse::~TiledUniverse()
+{
+    close();
+}
+
+
+//Methods:
+bool TiledUniverse::map(qint64 size)
+{
+    mem = file.map(0, size);
+    if(!mem){
+        message = "cannot map " + file.fileName() + ": " + file.errorString();
+        file.close();
+        return false;
+    }
+    header = (Header *)mem;
+    across = (header->width + TileSize - 1) / TileSize;
+    down = (header->height + TileSize - 1) / TileSize;
+    active.fill(0, across * down);
+    tilePopulation.fill(0, across * down);
+    return true;
+}
+
+bool TiledUniverse::create(const QString &filename, int height, int width)
+{
+    close();
+    if(height < 1 || width < 1){
+        message = "invalid size";
+        return false;
+    }
+    qint64 tiles = (qint64)((height + TileSize - 1) / TileSize) * ((width + TileSize - 1) / TileSize);
+    file.setFileName(filename);
+    if(!file.open(QIODevice::ReadWrite | QIODevice::Truncate) || !file.resize(headerSize + 2 * tiles * tileBytes)){
+        message = "cannot create " + filename + ": " + file.errorString();
+        file.close();
+        return false;
+    }
+    if(!map(file.size())){
+        return false;
+    }
+    //The file is all zeros (sparse where the system allows): an empty board in both buffers.
+    memcpy(header->magic, "LTIL", 4);
+    header->version = 1;
+    header->height = height;
+    header->width = width;
+    header->generation = 0;
+    header->current = 0;
+    header->birth = 1 << 3;
+    header->survival = (1 << 2) | (1 << 3);
+    header->neigh = 'm';
+    header->edge = 'p';
+    across = (width + TileSize - 1) / TileSize;
+    down = (height + TileSize - 1) / TileSize;
+    active.fill(0, across * down);
+    tilePopulation.fill(0, across * down);
+    live = 0;
+    lastChanged = 0;
+    return true;
+}
+
+bool TiledUniverse::open(const QString &filename)
+{
+    close();
+    file.setFileName(filename);
+    if(!file.open(QIODevice::ReadWrite) || file.size() < headerSize){
+        message = "cannot open " + filename;
+        file.close();
+        return false;
+    }
+    if(!map(file.size())){
+        return false;
+    }
+    if(memcmp(header->magic, "LTIL", 4) != 0 || header->version != 1 || header->height < 1 || header->width < 1
+            || file.size() != headerSize + 2 * (qint64)across * down * tileBytes){
+        message = filename + " is not a tiled universe";
+        close();
+        return false;
+    }
+    //One pass to count the cells, every live tile starts active (the other buffer is stale).
+    const quint64 *cur = buffer(header->current);
+    live = 0;
+    for(int ty = 0; ty < down; ty++){
+        for(int tx = 0; tx < across; tx++){
+            const quint64 *tile = cur + ((qint64)ty * across + tx) * TileSize;
+            int n = 0;
+            for(int r = 0; r < TileSize; r++){
+                n += qPopulationCount(tile[r]);
+            }
+            tilePopulation[ty * across + tx] = n;
+            live += n;
+            if(n){
+                activate(ty, tx);
+            }
+        }
+    }
+    //Empty tiles have to match in both buffers too.
+    quint64 *other = buffer(1 - header->current);
+    for(int t = 0; t < across * down; t++){
+        if(!tilePopulation[t]){
+            memset(other + (qint64)t * TileSize, 0, tileBytes);
+        }
+    }
+    lastChanged = 0;
+    return true;
+}
+
+void TiledUniverse::close()
+{
+    if(mem){
+        file.unmap(mem);
+    }
+    file.close();
+    mem = 0;
+    header = 0;
+    across = 0;
+    down = 0;
+    active.clear();
+    tilePopulation.clear();
+    live = 0;
+    lastChanged = 0;
+}
+
+bool TiledUniverse::isOpen() const
+{
+    return header != 0;
+}
+
+QString TiledUniverse::error() const
+{
+    return message;
+}
+
+QString TiledUniverse::fileName() const
+{
+    return file.fileName();
+}
+
+int TiledUniverse::height() const
+{
+    return header ? header->height : 0;
+}
+
+int TiledUniverse::width() const
+{
+    return header ? header->width : 0;
+}
+
+qint64 TiledUniverse::generation() const
+{
+    return header ? header->generation : 0;
+}
+
+char TiledUniverse::neighMode() const
+{
+    return header ? header->neigh : 'm';
+}
+
+char TiledUniverse::edgeMode() const
+{
+    return header ? header->edge : 'p';
+}
+
+QList<int> TiledUniverse::birthStates() const
+{
+    QList<int> states;
+    for(int n = 0; header && n <= 8; n++){
+        if(header->birth & (1 << n)){ states << n; }
+    }
+    return states;
+}
+
+QList<int> TiledUniverse::survivalStates() const
+{
+    QList<int> states;
+    for(int n = 0; header && n <= 8; n++){
+        if(header->survival & (1 << n)){ states << n; }
+    }
+    return states;
+}
+
+void TiledUniverse::setRule(const QList<int> &birth, const QList<int> &survival, char neighMode, char edgeMode)
+{
+    if(!header){
+        return;
+    }
+    quint32 b = 0;
+    quint32 s = 0;
+    foreach(int n, birth){
+        if(n >= 0 && n <= 8){ b |= 1 << n; }
+    }
+    foreach(int n, survival){
+        if(n >= 0 && n <= 8){ s |= 1 << n; }
+    }
+    if(b == header->birth && s == header->survival && neighMode == header->neigh && edgeMode == header->edge){
+        return;
+    }
+    header->birth = b;
+    header->survival = s;
+    header->neigh = neighMode;
+    header->edge = edgeMode;
+    //Stable tiles may not be stable any more.
+    for(int ty = 0; ty < down; ty++){
+        for(int tx = 0; tx < across; tx++){
+            if(tilePopulation[ty * across + tx]){ activate(ty, tx); }
+        }
+    }
+}
+
+quint64 *TiledUniverse::buffer(int n) const
+{
+    return (quint64 *)(mem + headerSize + n * (qint64)across * down * tileBytes);
+}
+
+int TiledUniverse::tileWidth(int tx) const
+{
+    return tx < across - 1 ? TileSize : header->width - tx * TileSize;
+}
+
+quint64 TiledUniverse::word(const quint64 *buf, int y, int tx) const
+{
+    int h = header->height;
+    if(y < 0 || y >= h || tx < 0 || tx >= across){
+        if(header->edge != 't'){
+            return 0;
+        }
+        y = (y + h) % h;
+        tx = (tx + across) % across;
+    }
+    return buf[((qint64)(y / TileSize) * across + tx) * TileSize + y % TileSize];
+}
+
+bool TiledUniverse::cell(int k, int j) const
+{
+    if(!header || k < 0 || k >= header->height || j < 0 || j >= header->width){
+        return false;
+    }
+    return (word(buffer(header->current), k, j / TileSize) >> (j % TileSize)) & 1;
+}
+
+void TiledUniverse::setCell(int k, int j, bool alive)
+{
+    if(!header || k < 0 || k >= header->height || j < 0 || j >= header->width || cell(k, j) == alive){
+        return;
+    }
+    int ty = k / TileSize;
+    int tx = j / TileSize;
+    quint64 *w = buffer(header->current) + ((qint64)ty * across + tx) * TileSize + k % TileSize;
+    *w ^= Q_UINT64_C(1) << (j % TileSize);
+    tilePopulation[ty * across + tx] += alive ? 1 : -1;
+    live += alive ? 1 : -1;
+    activate(ty, tx); //The other buffer is stale for this tile now.
+}
+
+BitGrid TiledUniverse::region(int top, int left, int height, int width) const
+{
+    BitGrid out(qMax(0, height), qMax(0, width));
+    if(!header){
+        return out;
+    }
+    const quint64 *cur = buffer(header->current);
+    for(int k = 0; k < out.height(); k++){
+        int y = top + k;
+        if(y < 0 || y >= header->height){
+            continue;
+        }
+        quint64 *row = out.row(k);
+        const quint64 *tiles = cur + (qint64)(y / TileSize) * across * TileSize + y % TileSize;
+        for(int i = 0; i < out.wordsPerRow(); i++){
+            //64 cells from column c, from one or two tiles, dead off the board.
+            int c = left + i * 64;
+            int tx = c >= 0 ? c / TileSize : -((TileSize - 1 - c) / TileSize);
+            int shift = c - tx * TileSize;
+            quint64 lo = tx >= 0 && tx < across ? tiles[(qint64)tx * TileSize] : 0;
+            quint64 hi = shift && tx + 1 >= 0 && tx + 1 < across ? tiles[(qint64)(tx + 1) * TileSize] : 0;
+            row[i] = (lo >> shift) | (shift ? hi << (64 - shift) : 0);
+        }
+        if(out.width() % 64){
+            row[out.wordsPerRow() - 1] &= (Q_UINT64_C(1) << (out.width() % 64)) - 1;
+        }
+    }
+    return out;
+}
+
+void TiledUniverse::setRegion(int top, int left, const BitGrid &cells)
+{
+    for(int k = 0; k < cells.height(); k++){
+        for(int j = 0; j < cells.width(); j++){
+            setCell(top + k, left + j, cells.cell(k, j));
+        }
+    }
+}
+
+void TiledUniverse::clear()
+{
+    if(!header){
+        return;
+    }
+    for(int t = 0; t < across * down; t++){
+        if(tilePopulation[t] || active[t]){
+            memset(buffer(0) + (qint64)t * TileSize, 0, tileBytes);
+            memset(buffer(1) + (qint64)t * TileSize, 0, tileBytes);
+            tilePopulation[t] = 0;
+            active[t] = 0;
+        }
+    }
+    live = 0;
+    lastChanged = 0;
+}
+
+qint64 TiledUniverse::population() const
+{
+    return live;
+}
+
+qint64 TiledUniverse::changed() const
+{
+    return lastChanged;
+}
+
+int TiledUniverse::tileCount() const
+{
+    return across * down;
+}
+
+int TiledUniverse::activeTiles() const
+{
+    return active.count(1);
+}
+
+void TiledUniverse::activate(int ty, int tx)
+{
+    bool torus = header->edge == 't';
+    for(int dy = -1; dy <= 1; dy++){
+        for(int dx = -1; dx <= 1; dx++){
+            int y = ty + dy;
+            int x = tx + dx;
+            if(torus){
+                y = (y + down) % down;
+                x = (x + across) % across;
+            } else if(y < 0 || y >= down || x < 0 || x >= across){
+                continue;
+            }
+            active[y * across + x] = 1;
+        }
+    }
+}
+
+bool TiledUniverse::stepTile(const quint64 *cur, quint64 *next, int ty, int tx, int &population) const
+{
+    bool torus = header->edge == 't';
+    bool moore = header->neigh == 'm';
+    int tw = tileWidth(tx);
+    int lastWidth = tileWidth(across - 1);
+    quint64 mask = tw == 64 ? ~Q_UINT64_C(0) : (Q_UINT64_C(1) << tw) - 1;
+    //Bit n of these: next state with n live neighbours.
+    quint32 birth = header->birth;
+    quint32 survival = header->survival;
+    int rows = qMin((int)TileSize, header->height - ty * TileSize);
+    qint64 base = ((qint64)ty * across + tx) * TileSize;
+
+    //Rows -1..rows of this tile and of the tiles on its sides, 0 off a plane.
+    int westTile = tx > 0 ? tx - 1 : (torus ? across - 1 : -1);
+    int eastTile = tx < across - 1 ? tx + 1 : (torus ? 0 : -1);
+    quint64 west[TileSize + 2];
+    quint64 centre[TileSize + 2];
+    quint64 east[TileSize + 2];
+    for(int r = -1; r <= rows; r++){
+        int y = ty * TileSize + r;
+        if(r >= 0 && r < rows){
+            const quint64 *row = cur + (qint64)ty * across * TileSize + r;
+            centre[r + 1] = row[(qint64)tx * TileSize];
+            west[r + 1] = westTile >= 0 ? row[(qint64)westTile * TileSize] : 0;
+            east[r + 1] = eastTile >= 0 ? row[(qint64)eastTile * TileSize] : 0;
+        } else {
+            centre[r + 1] = word(cur, y, tx);
+            west[r + 1] = westTile >= 0 ? word(cur, y, westTile) : 0;
+            east[r + 1] = eastTile >= 0 ? word(cur, y, eastTile) : 0;
+        }
+        //Only the bit next to this tile matters.
+        west[r + 1] = (west[r + 1] >> (tx == 0 ? lastWidth - 1 : TileSize - 1)) & 1;
+        east[r + 1] &= 1;
+    }
+
+    bool changed = false;
+    population = 0;
+    for(int r = 0; r < rows; r++){
+        quint64 w[3]; //Cells west of each cell, in the rows above, at and below.
+        quint64 c[3];
+        quint64 e[3]; //Cells east.
+        for(int d = 0; d < 3; d++){
+            c[d] = centre[r + d];
+            w[d] = (c[d] << 1) | west[r + d];
+            e[d] = (c[d] >> 1) | (east[r + d] << (tw - 1));
+        }
+        quint64 s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        addBit(c[0], s0, s1, s2, s3);
+        addBit(c[2], s0, s1, s2, s3);
+        addBit(w[1], s0, s1, s2, s3);
+        addBit(e[1], s0, s1, s2, s3);
+        if(moore){
+            addBit(w[0], s0, s1, s2, s3);
+            addBit(e[0], s0, s1, s2, s3);
+            addBit(w[2], s0, s1, s2, s3);
+            addBit(e[2], s0, s1, s2, s3);
+        }
+        quint64 born = 0;
+        quint64 kept = 0;
+        for(int n = 0; n <= 8; n++){
+            if(!((birth | survival) & (1 << n))){
+                continue;
+            }
+            quint64 is = (n & 1 ? s0 : ~s0) & (n & 2 ? s1 : ~s1) & (n & 4 ? s2 : ~s2) & (n & 8 ? s3 : ~s3);
+            if(birth & (1 << n)){ born |= is; }
+            if(survival & (1 << n)){ kept |= is; }
+        }
+        quint64 now = ((c[1] & kept) | (~c[1] & born)) & mask;
+        changed = changed || now != c[1];
+        next[base + r] = now;
+        population += qPopulationCount(now);
+    }
+    return changed;
+}
+
+bool TiledUniverse::step()
+{
+    if(!header){
+        return false;
+    }
+    const quint64 *cur = buffer(header->current);
+    quint64 *next = buffer(1 - header->current);
+    if(header->birth & 1){
+        active.fill(1); //B0: empty tiles come alive as well.
+    }
+    QVector<char> now = active;
+    active.fill(0);
+    lastChanged = 0;
+    for(int ty = 0; ty < down; ty++){
+        for(int tx = 0; tx < across; tx++){
+            int t = ty * across + tx;
+            if(!now[t]){
+                continue; //Unchanged last step: already the same in both buffers.
+            }
+            int n;
+            if(stepTile(cur, next, ty, tx, n)){
+                const quint64 *a = cur + (qint64)t * TileSize;
+                const quint64 *b = next + (qint64)t * TileSize;
+                for(int r = 0; r < TileSize; r++){
+                    lastChanged += qPopulationCount(a[r] ^ b[r]);
+                }
+                activate(ty, tx);
+            }
+            live += n - tilePopulation[t];
+            tilePopulation[t] = n;
+        }
+    }
+    if(lastChanged == 0){
+        return false; //Both buffers hold the same board, nothing to swap.
+    }
+    header->current = 1 - header->current;
+    header->generation++;
+    return true;
+}
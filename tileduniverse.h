@@ -0,0 +1,92 @@
+#ifndef TILEDUNIVERSE_H
+#define TILEDUNIVERSE_H
+
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <QVector>
+#include "bitgrid.h"
+
+/**
+  *
+  * Out-of-core universe for boards too large to keep in memory: cells are stored in 64x64
+  * tiles (one 64 bit word per tile row) in a memory-mapped file, which holds a small header
+  * and two generations, the current one and the one being made. A step goes through the
+  * tiles in file order and only computes the active ones: tiles that changed in the last
+  * step and their neighbours. A tile that is skipped didn't change, so it is already the
+  * same in both generations. The OS pages the cold parts of the file in and out.
+  * Radius 1 outer-totalistic rules only (bit-sliced neighbour counts per tile row).
+  * Cells are addressed from (0,0), as in BitGrid. The file keeps the board, the rule and
+  * the generation, and can be opened again later.
+ */
+
+class TiledUniverse
+{
+public:
+    enum { TileSize = 64 };
+
+    TiledUniverse();
+    ~TiledUniverse();
+
+    bool create(const QString &filename, int height, int width); // new empty board
+    bool open(const QString &filename); // a file made by create()
+    void close();
+    bool isOpen() const;
+    QString error() const;
+    QString fileName() const;
+
+    int height() const;
+    int width() const;
+    qint64 generation() const;
+    char neighMode() const; // 'm': moore, 'v': von neumann
+    char edgeMode() const; // 't': toroidal, 'p': bounded plane
+    QList<int> birthStates() const;
+    QList<int> survivalStates() const;
+    void setRule(const QList<int> &birth, const QList<int> &survival, char neighMode, char edgeMode);
+
+    bool cell(int k, int j) const;
+    void setCell(int k, int j, bool alive);
+    BitGrid region(int top, int left, int height, int width) const; // copy of part of the board, dead outside it
+    void setRegion(int top, int left, const BitGrid &cells); // cells outside the board are dropped
+    void clear();
+    qint64 population() const;
+    qint64 changed() const; // cells changed by the last step
+    int tileCount() const;
+    int activeTiles() const; // tiles the next step computes
+
+    bool step(); // one generation, false if no cell changed
+
+private:
+    struct Header {
+        char magic[4]; // "LTIL"
+        qint32 version;
+        qint32 height;
+        qint32 width;
+        qint64 generation;
+        qint32 current; // generation buffer, 0 or 1
+        quint32 birth; // bit n: birth with n neighbours
+        quint32 survival;
+        char neigh;
+        char edge;
+    };
+
+    QFile file;
+    uchar *mem; // mapped file
+    Header *header;
+    int across; // tiles per row
+    int down; // tiles per column
+    QVector<char> active; // by tile
+    QVector<quint16> tilePopulation; // by tile
+    qint64 live;
+    qint64 lastChanged;
+    QString message;
+
+    bool map(qint64 size);
+    quint64 *buffer(int n) const; // generation buffer
+    quint64 word(const quint64 *buf, int y, int tx) const; // row y of tile column tx, wrapped on a torus, 0 off a plane
+    int tileWidth(int tx) const;
+    void activate(int ty, int tx); // tile and its neighbours
+    bool stepTile(const quint64 *cur, quint64 *next, int ty, int tx, int &population) const; // true if changed
+};
+
+#endif // TILEDUNIVERSE_H
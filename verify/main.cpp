@@ -0,0 +1,587 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTextStream>
+#include <QFile>
+#include <QDir>
+#include <QPoint>
+#include <QStringList>
+#include "lifeengine.h"
+#include "ensembleengine.h"
+#include "tileduniverse.h"
+#include "henselrule.h"
+#include "patternio.h"
+#include "soup.h"
+#include "reference.h"
+
+/**
+  *
+  * verify: differential check of every engine backend against the reference stepping.
+  *   verify [--trials 500] [--generations 60] [--seed 1] [--max-size 64] [-f backend] [-o dir]
+  * Each trial draws a rule (outer-totalistic, isotropic, Larger than Life or Generations), a
+  * neighbourhood, an edge mode and a soup, then steps every backend that supports the rule
+  * next to the reference, comparing 64 bit board hashes after every generation.
+  * A mismatch is shrunk to a minimal board and its first differing generation: live cells are
+  * dropped, halves first, while it still fails, then a bounded plane loses its empty margins.
+  * It is printed and, with -o, written as .rle to open in the application.
+  * The golden corpus (golden.txt, built in, --golden for another file) holds classic patterns
+  * with the hashes of all their generations chained: it is checked first, on every backend.
+  * --write-golden recomputes it with the reference after a deliberate change of behaviour.
+  * New engine backends only need a Backend subclass added to the list in main().
+  * Exits with 1 if anything differs.
+ */
+
+struct Config
+{
+    Config() : neighMode('m'), edgeMode('p'), radius(1), states(2), totalistic(true) {}
+    QString rule; // as LifeEngine::setRule() takes it
+    char neighMode; // set before the rule: Larger than Life rules carry their own
+    char edgeMode;
+    int radius;
+    int states;
+    bool totalistic; // no Hensel letters
+    QList<int> birth;
+    QList<int> survival;
+    QString id() const { return rule + " " + neighMode + edgeMode; }
+};
+
+static bool configure(Config &c)
+{
+    //Rule family, as the engine reads it.
+    LifeEngine engine(1, 1);
+    engine.setNeighMode(c.neighMode);
+    if(!engine.setRule(c.rule)){
+        return false;
+    }
+    c.neighMode = engine.neighMode();
+    c.radius = engine.radius();
+    c.states = engine.states();
+    c.totalistic = c.radius > 1 || (HenselRule::isTotalistic(engine.birthConditions())
+                                    && HenselRule::isTotalistic(engine.survivalConditions()));
+    c.birth = engine.birthStates();
+    c.survival = engine.survivalStates();
+    return true;
+}
+
+static bool isLifeLike(const Config &c)
+{
+    return c.radius == 1 && c.states == 2 && c.totalistic;
+}
+
+
+//Backends:
+class Backend
+{
+public:
+    virtual ~Backend() {}
+    virtual QString name() const = 0;
+    virtual bool supports(const Config &c) const = 0;
+    virtual void setup(const Config &c, const BitGrid &board) = 0;
+    virtual bool step() = 0; // one generation, false once the backend no longer follows the rule
+    virtual BitGrid board() const = 0;
+    virtual QByteArray cellStates() const { return QByteArray(); } // Generations
+};
+
+class EngineBackend : public Backend
+{
+public:
+    explicit EngineBackend(int threads, Soup::Symmetry symmetry = Soup::C1) : threadCount(threads), group(symmetry), engine(1, 1) {}
+    QString name() const { return QString("engine-t%1").arg(threadCount) + (group != Soup::C1 ? "-" + Soup::symmetryName(group) : QString()); }
+    bool supports(const Config &) const { return true; }
+    void setup(const Config &c, const BitGrid &board)
+    {
+        engine.setThreadCount(threadCount);
+        engine.setSymmetry(group);
+        engine.setNeighMode(c.neighMode);
+        engine.setRule(c.rule);
+        engine.setEdgeMode(c.edgeMode);
+        engine.resize(board.height(), board.width());
+        engine.setBoard(board);
+    }
+    bool step() { engine.step(); return true; }
+    BitGrid board() const { return engine.board(); }
+    QByteArray cellStates() const { return engine.states() > 2 ? engine.cellStates() : QByteArray(); }
+private:
+    int threadCount;
+    Soup::Symmetry group; // symmetric stepping, used when the board has it
+    LifeEngine engine;
+};
+
+class EnsembleBackend : public Backend
+{
+public:
+    QString name() const { return "ensemble"; }
+    bool supports(const Config &c) const { return isLifeLike(c); }
+    void setup(const Config &c, const BitGrid &board)
+    {
+        engine.resize(board.height(), board.width());
+        engine.setRule(c.birth, c.survival);
+        engine.setNeighMode(c.neighMode);
+        engine.setEdgeMode(c.edgeMode);
+        for(int lane = 0; lane < EnsembleEngine::Lanes; lane++){
+            engine.setLane(lane, board);
+        }
+    }
+    bool step()
+    {
+        //A lane stops on period 2 and keeps its last generation, the rule goes on flipping.
+        bool flipping = engine.status(0) == EnsembleEngine::Period2;
+        engine.step();
+        return !flipping;
+    }
+    BitGrid board() const { return engine.lane(EnsembleEngine::Lanes - 1); }
+private:
+    EnsembleEngine engine;
+};
+
+class TiledBackend : public Backend
+{
+public:
+    TiledBackend() : filename(QDir::temp().filePath(QString("verify-%1.ltil").arg(QCoreApplication::applicationPid()))) {}
+    ~TiledBackend() { universe.close(); QFile::remove(filename); }
+    QString name() const { return "tiled"; }
+    bool supports(const Config &c) const { return isLifeLike(c); }
+    void setup(const Config &c, const BitGrid &board)
+    {
+        universe.create(filename, board.height(), board.width());
+        universe.setRule(c.birth, c.survival, c.neighMode, c.edgeMode);
+        universe.setRegion(0, 0, board);
+    }
+    bool step() { universe.step(); return true; }
+    BitGrid board() const { return universe.region(0, 0, universe.height(), universe.width()); }
+private:
+    QString filename;
+    TiledUniverse universe;
+};
+
+
+//Comparison:
+static int firstMismatch(Backend *b, const Config &c, const BitGrid &board, int generations)
+{
+    //Generation of the first differing hash, -1 if none.
+    Reference reference;
+    reference.setup(c.rule, c.neighMode, c.edgeMode, board);
+    b->setup(c, board);
+    if(Reference::hash(b->board(), b->cellStates()) != reference.hash()){
+        return 0;
+    }
+    for(int g = 1; g <= generations; g++){
+        reference.step();
+        if(!b->step()){
+            return -1;
+        }
+        if(Reference::hash(b->board(), b->cellStates()) != reference.hash()){
+            return g;
+        }
+    }
+    return -1;
+}
+
+static BitGrid cellsOf(const QVector<QPoint> &live, int height, int width)
+{
+    BitGrid board(height, width);
+    foreach(QPoint p, live){
+        board.setCell(p.y(), p.x(), true);
+    }
+    return board;
+}
+
+static BitGrid shrink(Backend *b, const Config &c, const BitGrid &board, int &at)
+{
+    //Delta debugging over the live cells, then the margins of a bounded plane.
+    int h = board.height();
+    int w = board.width();
+    QVector<QPoint> live;
+    for(int k = 0; k < h; k++){
+        for(int j = 0; j < w; j++){
+            if(board.cell(k, j)){ live << QPoint(j, k); }
+        }
+    }
+    int chunk = qMax(1, live.size() / 2);
+    while(true){
+        bool dropped = false;
+        for(int i = 0; i < live.size(); ){
+            QVector<QPoint> rest = live.mid(0, i) + live.mid(i + chunk);
+            int g = firstMismatch(b, c, cellsOf(rest, h, w), at);
+            if(g >= 0){
+                live = rest;
+                at = g;
+                dropped = true;
+            } else {
+                i += chunk;
+            }
+        }
+        if(!dropped && chunk == 1){
+            break;
+        }
+        if(!dropped){
+            chunk /= 2;
+        }
+    }
+    BitGrid small = cellsOf(live, h, w);
+    if(c.edgeMode != 'p'){
+        return small; //The size of a torus is part of the failure.
+    }
+    //Top, bottom, left, right.
+    static const int cut[4][4] = { { 1, 0, -1, 0 }, { 0, 0, -1, 0 }, { 0, 1, 0, -1 }, { 0, 0, 0, -1 } };
+    for(int side = 0; side < 4; side++){
+        while(small.height() > 1 && small.width() > 1){
+            BitGrid candidate = small.region(cut[side][0], cut[side][1],
+                                             small.height() + cut[side][2], small.width() + cut[side][3]);
+            int g = firstMismatch(b, c, candidate, at);
+            if(g < 0){
+                break;
+            }
+            small = candidate;
+            at = g;
+        }
+    }
+    return small;
+}
+
+static void report(QTextStream &out, Backend *b, const Config &c, const BitGrid &board, int at, const QString &dir, int number)
+{
+    out << b->name() << " differs from the reference at generation " << at << ": " << c.id()
+        << ", " << board.height() << "x" << board.width() << ", " << board.population() << " cells\n";
+    if(board.width() <= 80 && board.height() <= 40){
+        for(int k = 0; k < board.height(); k++){
+            QString line(board.width(), '.');
+            for(int j = 0; j < board.width(); j++){
+                if(board.cell(k, j)){ line[j] = 'O'; }
+            }
+            out << "    " << line << "\n";
+        }
+    }
+    if(!dir.isEmpty()){
+        Pattern p;
+        p.neighMode = c.neighMode;
+        PatternIO::setRule(p, c.rule);
+        p.edgeMode = c.edgeMode;
+        p.board = board;
+        QString filename = QDir(dir).filePath(QString("mismatch-%1.rle").arg(number));
+        if(PatternIO::write(filename, p)){
+            out << "    written to " << filename << "\n";
+        }
+    }
+    out.flush();
+}
+
+
+//Random trials:
+static quint64 draw(quint64 &x)
+{
+    //splitmix64: every trial is made again from --seed.
+    quint64 z = (x += Q_UINT64_C(0x9E3779B97F4A7C15));
+    z = (z ^ (z >> 30)) * Q_UINT64_C(0xBF58476D1CE4E5B9);
+    z = (z ^ (z >> 27)) * Q_UINT64_C(0x94D049BB133111EB);
+    return z ^ (z >> 31);
+}
+
+static QString counts(quint64 &x, int max, int percent)
+{
+    QString s;
+    for(int n = 0; n <= max; n++){
+        if((int)(draw(x) % 100) < percent){ s += QString::number(n); }
+    }
+    return s;
+}
+
+static Config randomConfig(quint64 &x)
+{
+    Config c;
+    c.edgeMode = draw(x) & 1 ? 't' : 'p';
+    c.neighMode = draw(x) & 1 ? 'v' : 'm';
+    int family = draw(x) % 4;
+    if(family == 0){
+        //Outer-totalistic.
+        int max = c.neighMode == 'v' ? 4 : 8;
+        c.rule = "B" + counts(x, max, 30) + "/S" + counts(x, max, 40);
+    } else if(family == 1){
+        //Isotropic: some counts narrowed to, or stripped of, a few configurations.
+        c.neighMode = 'm';
+        QString parts[2];
+        for(int i = 0; i < 2; i++){
+            for(int n = 0; n <= 8; n++){
+                if(draw(x) % 100 >= 35){ continue; }
+                parts[i] += QString::number(n);
+                QString letters = HenselRule::letters(n);
+                if(letters.isEmpty() || draw(x) % 2){ continue; }
+                QString chosen;
+                foreach(QChar l, letters){
+                    if(draw(x) % 3 == 0){ chosen += l; }
+                }
+                if(!chosen.isEmpty() && chosen.size() < letters.size()){
+                    parts[i] += (draw(x) % 2 ? "-" : "") + chosen;
+                }
+            }
+        }
+        c.rule = "B" + parts[0] + "/S" + parts[1];
+    } else if(family == 2){
+        //Larger than Life, ranges anywhere in the neighbourhood.
+        int r = 2 + draw(x) % 3;
+        int size = c.neighMode == 'v' ? 2 * r * (r + 1) + 1 : (2 * r + 1) * (2 * r + 1);
+        int s1 = draw(x) % size, s2 = s1 + draw(x) % (size - s1);
+        int b1 = 1 + draw(x) % (size - 1), b2 = b1 + draw(x) % (size - b1);
+        c.rule = QString("R%1,C0,M%2,S%3..%4,B%5..%6,N%7").arg(r).arg(draw(x) % 2).arg(s1).arg(s2)
+                .arg(b1).arg(b2).arg(c.neighMode == 'v' ? "N" : "M");
+    } else {
+        //Generations.
+        int max = c.neighMode == 'v' ? 4 : 8;
+        QString birth = counts(x, max, 30);
+        if(birth.isEmpty()){ birth = "2"; }
+        c.rule = "B" + birth + "/S" + counts(x, max, 35) + QString("/C%1").arg(3 + draw(x) % 6);
+    }
+    return c;
+}
+
+
+//Golden corpus:
+struct Golden
+{
+    QString name;
+    Config config;
+    int height;
+    int width;
+    int generations;
+    QString cells; // RLE body, centered, or "soup <density> <symmetry> <seed>" over the whole board
+    quint64 chain; // hashes of generations 0..generations, chained
+    int population; // at the last generation
+};
+
+static BitGrid rle(const QString &body)
+{
+    QVector<QPoint> live;
+    int k = 0, j = 0, run = 0, width = 0;
+    foreach(QChar ch, body){
+        if(ch.isDigit()){
+            run = run * 10 + ch.digitValue();
+            continue;
+        }
+        int n = run ? run : 1;
+        run = 0;
+        if(ch == 'o'){
+            for(int i = 0; i < n; i++){ live << QPoint(j++, k); }
+        } else if(ch == 'b' || ch == '.'){
+            j += n;
+        } else if(ch == '$'){
+            k += n;
+            j = 0;
+        } else if(ch == '!'){
+            break;
+        }
+        width = qMax(width, j);
+    }
+    return cellsOf(live, k + 1, width);
+}
+
+static BitGrid goldenBoard(const Golden &g)
+{
+    if(g.cells.startsWith("soup ")){
+        double density;
+        Soup::Symmetry symmetry;
+        quint64 seed;
+        Soup::parse(g.cells.mid(5), density, symmetry, seed);
+        return Soup::generate(g.height, g.width, density, seed, symmetry);
+    }
+    BitGrid pattern = rle(g.cells);
+    BitGrid board(g.height, g.width);
+    board.blit(pattern, (g.height - pattern.height()) / 2, (g.width - pattern.width()) / 2);
+    return board;
+}
+
+static quint64 chained(quint64 chain, quint64 hash)
+{
+    return (chain ^ hash) * Q_UINT64_C(1099511628211);
+}
+
+static bool readGolden(const QString &filename, QList<Golden> &corpus, QStringList &lines)
+{
+    //name|rule|neighbourhood|edge|HxW|generations|cells|chain|population, '#' for comments.
+    QFile file(filename);
+    if(!file.open(QIODevice::ReadOnly)){
+        return false;
+    }
+    QTextStream in(&file);
+    while(!in.atEnd()){
+        QString line = in.readLine();
+        lines << line;
+        if(line.trimmed().isEmpty() || line.startsWith('#')){
+            continue;
+        }
+        QStringList f = line.split('|');
+        QStringList size = f.size() == 9 ? f[4].split('x') : QStringList();
+        if(size.size() != 2){
+            return false;
+        }
+        Golden g;
+        g.name = f[0];
+        g.config.rule = f[1];
+        g.config.neighMode = f[2] == "v" ? 'v' : 'm';
+        g.config.edgeMode = f[3] == "t" ? 't' : 'p';
+        g.height = size[0].toInt();
+        g.width = size[1].toInt();
+        g.generations = f[5].toInt();
+        g.cells = f[6];
+        g.chain = f[7].toULongLong(0, 16);
+        g.population = f[8].toInt();
+        if(!configure(g.config) || g.height < 1 || g.width < 1){
+            return false;
+        }
+        corpus << g;
+    }
+    return true;
+}
+
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("verify");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Checks every engine backend against the reference stepping.");
+    parser.addHelpOption();
+    QCommandLineOption trialOpt("trials", "Random trials (default 500, 0 for the golden corpus only).", "n", "500");
+    QCommandLineOption genOpt(QStringList() << "g" << "generations", "Generations per trial (default 60).", "n", "60");
+    QCommandLineOption seedOpt("seed", "First trial seed (default 1).", "n", "1");
+    QCommandLineOption sizeOpt("max-size", "Largest side of the trial boards (default 64, some radius 1 trials use 130 to 160).", "n", "64");
+    QCommandLineOption filterOpt(QStringList() << "f" << "filter", "Only check backends whose name contains text.", "text");
+    QCommandLineOption outOpt(QStringList() << "o" << "output", "Write the shrunk mismatches as .rle files to a directory.", "dir");
+    QCommandLineOption goldenOpt("golden", "Golden corpus (default: the built-in golden.txt).", "file", ":/golden.txt");
+    QCommandLineOption writeOpt("write-golden", "Recompute the corpus hashes with the reference into a file and exit.", "file");
+    parser.addOption(trialOpt);
+    parser.addOption(genOpt);
+    parser.addOption(seedOpt);
+    parser.addOption(sizeOpt);
+    parser.addOption(filterOpt);
+    parser.addOption(outOpt);
+    parser.addOption(goldenOpt);
+    parser.addOption(writeOpt);
+    parser.process(app);
+
+    int trials = qMax(0, parser.value(trialOpt).toInt());
+    int generations = qMax(1, parser.value(genOpt).toInt());
+    quint64 seed = parser.value(seedOpt).toULongLong();
+    int maxSize = qMax(1, parser.value(sizeOpt).toInt());
+    QString dir = parser.value(outOpt);
+    QTextStream out(stdout);
+    QTextStream log(stderr);
+
+    QList<Backend*> backends;
+    backends << new EngineBackend(1);
+    backends << new EngineBackend(4); //Bands on boards of 128x128 and more.
+    backends << new EngineBackend(4, Soup::D8); //Fundamental domain of the symmetric trials.
+    backends << new EnsembleBackend();
+    backends << new TiledBackend();
+    for(int i = backends.size() - 1; i >= 0; i--){
+        if(parser.isSet(filterOpt) && !backends[i]->name().contains(parser.value(filterOpt))){
+            delete backends.takeAt(i);
+        }
+    }
+
+    //Golden corpus:
+    QList<Golden> corpus;
+    QStringList lines;
+    if(!readGolden(parser.value(goldenOpt), corpus, lines)){
+        log << "verify: cannot read the golden corpus " << parser.value(goldenOpt) << "\n";
+        return 1;
+    }
+    if(parser.isSet(writeOpt)){
+        QFile file(parser.value(writeOpt));
+        if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate)){
+            log << "verify: cannot write " << parser.value(writeOpt) << "\n";
+            return 1;
+        }
+        QTextStream golden(&file);
+        int i = 0;
+        foreach(QString line, lines){
+            if(line.trimmed().isEmpty() || line.startsWith('#')){
+                golden << line << "\n";
+                continue;
+            }
+            Golden &g = corpus[i++];
+            Reference reference;
+            reference.setup(g.config.rule, g.config.neighMode, g.config.edgeMode, goldenBoard(g));
+            quint64 chain = chained(0, reference.hash());
+            for(int n = 1; n <= g.generations; n++){
+                reference.step();
+                chain = chained(chain, reference.hash());
+            }
+            QStringList f = line.split('|');
+            f[7] = QString("%1").arg(chain, 16, 16, QChar('0'));
+            f[8] = QString::number(reference.board().population());
+            golden << f.join("|") << "\n";
+        }
+        return 0;
+    }
+    int failures = 0;
+    foreach(Golden g, corpus){
+        BitGrid board = goldenBoard(g);
+        Reference reference;
+        reference.setup(g.config.rule, g.config.neighMode, g.config.edgeMode, board);
+        quint64 chain = chained(0, reference.hash());
+        for(int n = 1; n <= g.generations; n++){
+            reference.step();
+            chain = chained(chain, reference.hash());
+        }
+        if(chain != g.chain){
+            out << "reference differs from the golden corpus on " << g.name << " (" << g.config.id() << "): population "
+                << reference.board().population() << " instead of " << g.population << "\n";
+            failures++;
+        }
+        foreach(Backend *b, backends){
+            if(!b->supports(g.config)){
+                continue;
+            }
+            b->setup(g.config, board);
+            quint64 c = chained(0, Reference::hash(b->board(), b->cellStates()));
+            bool following = true;
+            for(int n = 1; n <= g.generations && following; n++){
+                following = b->step();
+                c = chained(c, Reference::hash(b->board(), b->cellStates()));
+            }
+            if(following && c != g.chain){
+                int at = firstMismatch(b, g.config, board, g.generations);
+                out << b->name() << " differs from the golden corpus on " << g.name << " (" << g.config.id() << ")"
+                    << (at >= 0 ? QString(", from generation %1").arg(at) : QString()) << "\n";
+                failures++;
+            }
+        }
+    }
+    log << corpus.size() << " golden patterns checked\n";
+    log.flush();
+
+    //Random trials:
+    int mismatches = 0;
+    for(int t = 0; t < trials; t++){
+        quint64 x = seed + t;
+        Config c = randomConfig(x);
+        if(!configure(c)){
+            continue;
+        }
+        bool large = c.radius == 1 && t % 8 == 7;
+        int h = large ? 130 + draw(x) % 31 : 1 + draw(x) % maxSize;
+        int w = large ? 130 + draw(x) % 31 : 1 + draw(x) % maxSize;
+        double density = 0.1 + (draw(x) % 50) / 100.0;
+        BitGrid board = Soup::generate(h, w, density, draw(x), (Soup::Symmetry)(draw(x) % 5));
+        foreach(Backend *b, backends){
+            if(!b->supports(c)){
+                continue;
+            }
+            int at = firstMismatch(b, c, board, generations);
+            if(at < 0){
+                continue;
+            }
+            BitGrid small = shrink(b, c, board, at);
+            out << "trial " << seed + t << ": ";
+            report(out, b, c, small, at, dir, ++mismatches);
+            failures++;
+        }
+        if((t + 1) % 50 == 0){
+            log << t + 1 << " trials\n";
+            log.flush();
+        }
+    }
+    log << trials << " trials, " << failures << " failures\n";
+    qDeleteAll(backends);
+    return failures ? 1 : 0;
+}
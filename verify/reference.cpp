@@ -0,0 +1,302 @@
+#include "reference.h"
+
+//Neighbours from bit 0 (N) clockwise.
+static const int dk[8] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+static const int dj[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+
+//Hensel letters of 1 to 4 live neighbours, one picture each ('x' is the cell itself).
+//Any rotation or reflection of a picture has the same letter, letters of 5 to 7 are those of the dead neighbours.
+struct Letter {
+    int count;
+    char letter;
+    const char *rows[3];
+};
+
+static const Letter letters[] = {
+    { 1, 'c', { "o..", ".x.", "..." } },
+    { 1, 'e', { ".o.", ".x.", "..." } },
+    { 2, 'c', { "o.o", ".x.", "..." } },
+    { 2, 'e', { ".o.", "ox.", "..." } },
+    { 2, 'k', { "o..", ".xo", "..." } },
+    { 2, 'a', { "oo.", ".x.", "..." } },
+    { 2, 'i', { "...", "oxo", "..." } },
+    { 2, 'n', { "..o", ".x.", "o.." } },
+    { 3, 'c', { "o.o", ".x.", "o.." } },
+    { 3, 'e', { ".o.", "oxo", "..." } },
+    { 3, 'k', { ".o.", ".xo", "o.." } },
+    { 3, 'a', { "oo.", "ox.", "..." } },
+    { 3, 'i', { "ooo", ".x.", "..." } },
+    { 3, 'n', { "o.o", "ox.", "..." } },
+    { 3, 'y', { "o..", ".xo", "o.." } },
+    { 3, 'q', { ".oo", ".x.", "o.." } },
+    { 3, 'j', { ".oo", "ox.", "..." } },
+    { 3, 'r', { "o..", "oxo", "..." } },
+    { 4, 'c', { "o.o", ".x.", "o.o" } },
+    { 4, 'e', { ".o.", "oxo", ".o." } },
+    { 4, 'k', { "oo.", ".xo", "o.." } },
+    { 4, 'a', { "ooo", "ox.", "..." } },
+    { 4, 'i', { "o.o", "oxo", "..." } },
+    { 4, 'n', { "ooo", ".x.", "o.." } },
+    { 4, 'y', { "o.o", ".xo", "o.." } },
+    { 4, 'q', { ".oo", ".xo", "o.." } },
+    { 4, 'j', { ".o.", "oxo", "o.." } },
+    { 4, 'r', { "oo.", "oxo", "..." } },
+    { 4, 't', { "o..", "oxo", "o.." } },
+    { 4, 'w', { ".oo", "ox.", "o.." } },
+    { 4, 'z', { "..o", "oxo", "o.." } }
+};
+
+Reference::Reference() :
+    engine(1, 1),
+    direct(false),
+    neigh('m'),
+    edge('p'),
+    rad(1),
+    middle(false),
+    nStates(2)
+{
+}
+
+bool Reference::setup(const QString &rule, char neighMode, char edgeMode, const BitGrid &board)
+{
+    engine.setNeighMode(neighMode); //Larger than Life rules carry their own.
+    if(!engine.setRule(rule)){
+        return false;
+    }
+    engine.setEdgeMode(edgeMode);
+    neigh = engine.neighMode();
+    edge = edgeMode;
+    rad = engine.radius();
+    middle = engine.middleCounted();
+    nStates = engine.states();
+    direct = rad == 1 && nStates == 2
+            && !engine.birthConditions().contains(QRegExp("[a-z]")) && !engine.survivalConditions().contains(QRegExp("[a-z]"));
+    if(rad == 1 && nStates == 2){
+        born.fill(false, 256);
+        survive.fill(false, 256);
+        for(int mask = 0; mask < 256; mask++){
+            int count = qPopulationCount((quint32)mask);
+            char letter = letterOf(mask);
+            born[mask] = meets(engine.birthConditions(), count, letter);
+            survive[mask] = meets(engine.survivalConditions(), count, letter);
+        }
+    } else {
+        int size = rad == 1 ? 8 : (neigh == 'v' ? 2 * rad * (rad + 1) + 1 : (2 * rad + 1) * (2 * rad + 1));
+        bornAt.fill(0, size + 1);
+        surviveAt.fill(0, size + 1);
+        foreach(int b, engine.birthStates()){ if(b >= 0 && b <= size){ bornAt[b] = 1; } }
+        foreach(int s, engine.survivalStates()){ if(s >= 0 && s <= size){ surviveAt[s] = 1; } }
+    }
+    cells = board;
+    states.clear();
+    if(nStates > 2){
+        states.fill(0, board.height() * board.width());
+        for(int k = 0; k < board.height(); k++){
+            for(int j = 0; j < board.width(); j++){
+                states[k * board.width() + j] = board.cell(k, j);
+            }
+        }
+    }
+    if(direct){
+        engine.resize(board.height(), board.width());
+        engine.setBoard(board);
+    }
+    return true;
+}
+
+void Reference::step()
+{
+    if(direct){
+        engine.stepReference();
+    } else if(nStates > 2){
+        states = stepStates(states, cells.height(), cells.width(), neigh, edge, nStates, bornAt, surviveAt);
+        for(int k = 0; k < cells.height(); k++){
+            for(int j = 0; j < cells.width(); j++){
+                cells.setCell(k, j, states[k * cells.width() + j] == 1);
+            }
+        }
+    } else if(rad > 1){
+        cells = stepWide(cells, neigh, edge, rad, middle, bornAt, surviveAt);
+    } else {
+        cells = stepMasks(cells, neigh, edge, born, survive);
+    }
+}
+
+BitGrid Reference::board() const
+{
+    return direct ? engine.board() : cells;
+}
+
+QByteArray Reference::cellStates() const
+{
+    return states;
+}
+
+quint64 Reference::hash() const
+{
+    return hash(board(), states);
+}
+
+quint64 Reference::hash(const BitGrid &board, const QByteArray &states)
+{
+    //FNV-1a of the states, folded into the board's hash.
+    quint64 h = board.hash();
+    if(!states.isEmpty()){
+        quint64 f = Q_UINT64_C(14695981039346656037);
+        for(int i = 0; i < states.size(); i++){
+            f = (f ^ (uchar)states[i]) * Q_UINT64_C(1099511628211);
+        }
+        h ^= f * Q_UINT64_C(0x9E3779B97F4A7C15);
+    }
+    return h;
+}
+
+
+//Definitions:
+char Reference::letterOf(int mask)
+{
+    int count = qPopulationCount((quint32)mask);
+    if(count == 0 || count == 8){
+        return 0;
+    }
+    if(count > 4){
+        mask = ~mask & 0xFF; //Letter of the dead neighbours.
+        count = 8 - count;
+    }
+    for(uint l = 0; l < sizeof(letters) / sizeof(letters[0]); l++){
+        if(letters[l].count != count){ continue; }
+        for(int s = 0; s < 8; s++){
+            //Picture turned s % 4 quarter turns clockwise, mirrored if s >= 4.
+            int m = 0;
+            for(int r = 0; r < 3; r++){
+                for(int c = 0; c < 3; c++){
+                    if(letters[l].rows[r][c] != 'o'){ continue; }
+                    int y = r - 1;
+                    int x = c - 1;
+                    if(s >= 4){ x = -x; }
+                    for(int t = 0; t < s % 4; t++){
+                        int z = y;
+                        y = x;
+                        x = -z;
+                    }
+                    for(int i = 0; i < 8; i++){
+                        if(dk[i] == y && dj[i] == x){ m |= 1 << i; }
+                    }
+                }
+            }
+            if(m == mask){
+                return letters[l].letter;
+            }
+        }
+    }
+    return 0;
+}
+
+bool Reference::meets(const QString &conditions, int count, char letter)
+{
+    //Digits, each followed by the letters it allows, or by '-' and the letters it doesn't; none for all of them.
+    bool met = false;
+    for(int i = 0; i < conditions.size(); i++){
+        if(!conditions[i].isDigit()){ continue; }
+        int n = conditions[i].digitValue();
+        bool minus = i + 1 < conditions.size() && conditions[i + 1] == '-';
+        QString named;
+        for(int l = i + (minus ? 2 : 1); l < conditions.size() && conditions[l].isLetter(); l++){
+            named += conditions[l];
+        }
+        if(n == count){
+            met |= named.isEmpty() || named.contains(letter) != minus;
+        }
+    }
+    return met;
+}
+
+BitGrid Reference::stepMasks(const BitGrid &b, char neigh, char edge, const QVector<bool> &born, const QVector<bool> &survive)
+{
+    int h = b.height();
+    int w = b.width();
+    BitGrid out(h, w);
+    for(int k = 0; k < h; k++){
+        for(int j = 0; j < w; j++){
+            int mask = 0;
+            for(int i = 0; i < 8; i++){
+                if(neigh == 'v' && (i & 1)){ continue; } //Corners are not neighbours.
+                int y = k + dk[i];
+                int x = j + dj[i];
+                if(edge == 't'){
+                    y = (y + h) % h;
+                    x = (x + w) % w;
+                } else if(y < 0 || y >= h || x < 0 || x >= w){
+                    continue;
+                }
+                if(b.cell(y, x)){ mask |= 1 << i; }
+            }
+            out.setCell(k, j, b.cell(k, j) ? survive[mask] : born[mask]);
+        }
+    }
+    return out;
+}
+
+BitGrid Reference::stepWide(const BitGrid &b, char neigh, char edge, int rad, bool middle,
+                            const QVector<char> &bornAt, const QVector<char> &surviveAt)
+{
+    int h = b.height();
+    int w = b.width();
+    BitGrid out(h, w);
+    for(int k = 0; k < h; k++){
+        for(int j = 0; j < w; j++){
+            int count = 0;
+            for(int dy = -rad; dy <= rad; dy++){
+                for(int dx = -rad; dx <= rad; dx++){
+                    if(neigh == 'v' && qAbs(dy) + qAbs(dx) > rad){ continue; } //Diamond.
+                    if(dy == 0 && dx == 0 && !middle){ continue; }
+                    int y = k + dy;
+                    int x = j + dx;
+                    if(edge == 't'){
+                        y = (y % h + h) % h; //The radius may be larger than the board.
+                        x = (x % w + w) % w;
+                    } else if(y < 0 || y >= h || x < 0 || x >= w){
+                        continue;
+                    }
+                    count += b.cell(y, x);
+                }
+            }
+            out.setCell(k, j, b.cell(k, j) ? surviveAt[count] : bornAt[count]);
+        }
+    }
+    return out;
+}
+
+QByteArray Reference::stepStates(const QByteArray &s, int h, int w, char neigh, char edge, int nStates,
+                                 const QVector<char> &bornAt, const QVector<char> &surviveAt)
+{
+    QByteArray out(s.size(), 0);
+    for(int k = 0; k < h; k++){
+        for(int j = 0; j < w; j++){
+            int n = 0;
+            for(int i = 0; i < 8; i++){
+                if(neigh == 'v' && (i & 1)){ continue; }
+                int y = k + dk[i];
+                int x = j + dj[i];
+                if(edge == 't'){
+                    y = (y + h) % h;
+                    x = (x + w) % w;
+                } else if(y < 0 || y >= h || x < 0 || x >= w){
+                    continue;
+                }
+                n += s[y * w + x] == 1; //Only live cells count, not refractory ones.
+            }
+            int c = (uchar)s[k * w + j];
+            int next;
+            if(c == 0){
+                next = bornAt[n] ? 1 : 0;
+            } else if(c == 1){
+                next = surviveAt[n] ? 1 : 2;
+            } else {
+                next = (c + 1) % nStates; //Refractory: one state per generation, back to dead.
+            }
+            out[k * w + j] = (char)next;
+        }
+    }
+    return out;
+}
@@ -0,0 +1,57 @@
+#ifndef REFERENCE_H
+#define REFERENCE_H
+
+#include <QString>
+#include <QVector>
+#include <QByteArray>
+#include "lifeengine.h"
+
+/**
+  *
+  * Slow and obvious stepping that every engine backend is checked against.
+  * Outer-totalistic radius 1 rules go through LifeEngine::stepReference(), the original
+  * isAlive() loop; the other rule families are counted cell by cell, straight from their
+  * definitions:
+  *   isotropic    Hensel letter of the 8 neighbours, from pictures of every letter turned and mirrored
+  *   radius > 1   every cell of the box or diamond, wrapped or clipped at the edges
+  *   Generations  live neighbours, then the dead / alive / refractory transitions
+  * Cells are addressed from (0,0), as in BitGrid.
+ */
+
+class Reference
+{
+public:
+    Reference();
+
+    bool setup(const QString &rule, char neighMode, char edgeMode, const BitGrid &board); // false if the rule is invalid
+    void step();
+    BitGrid board() const;
+    QByteArray cellStates() const; // Generations: one byte per cell, row major, empty otherwise
+    quint64 hash() const; // of the board and the states
+    static quint64 hash(const BitGrid &board, const QByteArray &states);
+
+private:
+    LifeEngine engine; // rule parsing, and the isAlive() stepping
+    bool direct; // outer-totalistic radius 1: engine.stepReference()
+    char neigh;
+    char edge;
+    int rad;
+    bool middle;
+    int nStates;
+    QVector<bool> born; // radius 1: neighbour mask (bit 0 N, then clockwise) -> birth
+    QVector<bool> survive;
+    QVector<char> bornAt; // radius > 1 and Generations: live neighbours -> birth
+    QVector<char> surviveAt;
+    BitGrid cells; // live cells
+    QByteArray states; // Generations: every cell's state
+
+    static char letterOf(int mask); // Hensel letter of a neighbour mask, 0 for 0 or 8 neighbours
+    static bool meets(const QString &conditions, int count, char letter); // e.g. "2-a3": is (count, letter) named
+    static BitGrid stepMasks(const BitGrid &b, char neigh, char edge, const QVector<bool> &born, const QVector<bool> &survive);
+    static BitGrid stepWide(const BitGrid &b, char neigh, char edge, int rad, bool middle,
+                            const QVector<char> &bornAt, const QVector<char> &surviveAt);
+    static QByteArray stepStates(const QByteArray &s, int h, int w, char neigh, char edge, int nStates,
+                                 const QVector<char> &bornAt, const QVector<char> &surviveAt);
+};
+
+#endif // REFERENCE_H
@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# Verification: every engine backend against the reference stepping.
+#
+#-------------------------------------------------
+
+QT       += core
+QT       -= gui
+
+TARGET = verify
+CONFIG   += console
+CONFIG   -= app_bundle
+TEMPLATE = app
+
+include(../engine.pri)
+
+SOURCES += main.cpp \
+    reference.cpp
+
+HEADERS  += reference.h
+
+RESOURCES += verify.qrc